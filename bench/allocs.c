@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Preloaded into the interpreter to count its calls to the C allocator, which it prints to stderr when it exits.
+// Usage: LD_PRELOAD=bench/allocs.so ./csach.out <file.csach>
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static unsigned long allocations;
+
+void* malloc(size_t size) {
+  allocations += 1;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  allocations += 1;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  allocations += 1;
+  return __libc_realloc(ptr, size);
+}
+
+// Written without stdio, which may allocate
+__attribute__((destructor)) static void printAllocations() {
+  char line[64];
+  int length = snprintf(line, sizeof(line), "%lu\n", allocations);
+  write(2, line, length);
+}
\ No newline at end of file
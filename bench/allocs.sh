@@ -0,0 +1,15 @@
+# Calls to malloc, calloc and realloc, counted by preloading bench/allocs.so, with the peak memory of the large program
+. bench/common.sh
+
+allocations() {
+  LD_PRELOAD=./bench/allocs.so "$csach" "$1" 2>&1 >/dev/null | tail -n 1
+}
+
+for program in examples/*.csach; do
+  printf '  %-44s %10s calls\n' "$program" "$(allocations "$program")"
+done
+
+program="$work/allocs100k.csach"
+generate "$program" 100000 'printf "let value%d = %d * 2 + 7;\nprintln(\"line number\", value%d);\n", i, i, i'
+printf '  %-44s %10s calls\n' "100k-line let/println" "$(allocations "$program")"
+measure "100k-line let/println, time and peak RSS" "$csach" "$program"
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "parser.h"
+#include "AST.h"
+#include "arena.h"
+#include "io.h"
+
+// Parse a program without running it, and print how many nodes its AST has and the memory they take.
+// Usage: ast.out <file.csach>
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    printf("Usage: %s <file.csach>\n", argv[0]);
+    exit(1);
+  }
+
+  programArena = initArena();
+
+  size_t contentsSize;
+  char* contents = getFileContents(argv[1], &contentsSize);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  parser_T* parser = initParser(initLexer(contents, contentsSize));
+  parseStatements(parser, parser->scope);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  // Nodes are handed out in order from index 1, so the next one tells how many there are
+  size_t nodes = initAST(AST_NOOP)->index - 1;
+
+  printf("%9zu nodes of %zu bytes %8.1f MB of nodes %8.1f MB of arena %6.1f arena bytes/node %7.3f s to parse\n",
+    nodes, sizeof(AST_T), nodes * sizeof(AST_T) / 1e6, programArena->bytesUsed / 1e6, (double) programArena->bytesUsed / nodes, seconds);
+
+  releaseFileContents(contents, contentsSize);
+  freeArena(programArena);
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+# Bytes per AST node and the memory of parsing large programs, then the time and peak memory of running them
+. bench/common.sh
+
+lets="$work/ast_lets100k.csach"
+generate "$lets" 100000 'printf "let value%d = %d * 2 + 7;\nprintln(\"line number\", value%d);\n", i, i, i'
+
+printlns="$work/ast_printlns1m.csach"
+generate "$printlns" 1000000 'printf "println(\"generated line number %d with some padding text\", %d, '"'c'"', true);\n", i, i'
+
+printf '  100k-line let/println  '
+./bench/ast.out "$lets"
+printf '  1M-line println        '
+./bench/ast.out "$printlns"
+
+measure "100k-line let/println" "$csach" "$lets"
+measure "1M-line println" "$csach" "$printlns"
\ No newline at end of file
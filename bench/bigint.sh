@@ -0,0 +1,19 @@
+# Arbitrary-precision ints: a huge power, factorial(10000), exponentiation by squaring and Karatsuba multiplication
+. bench/common.sh
+
+power="$work/bigint_power.csach"
+[ -f "$power" ] || printf 'println(2 ^ 100000);\n' > "$power"
+
+factorial="$work/bigint_factorial.csach"
+[ -f "$factorial" ] || printf 'func factorial(n, product) { if (n == 0) { ret product }; ret factorial(n - 1, product * n) };\nprintln(factorial(10000, 1));\n' > "$factorial"
+
+squaring="$work/bigint_squaring.csach"
+[ -f "$squaring" ] || printf 'println(1 ^ 2000000000);\n' > "$squaring"
+
+karatsuba="$work/bigint_karatsuba.csach"
+[ -f "$karatsuba" ] || printf 'println(3 ^ 4000000 %% 1000000007);\n' > "$karatsuba"
+
+measure "2 ^ 100000" "$csach" "$power"
+measure "factorial(10000)" "$csach" "$factorial"
+measure "1 ^ 2000000000" "$csach" "$squaring"
+measure "3 ^ 4000000 % 1000000007" "$csach" "$karatsuba"
\ No newline at end of file
@@ -0,0 +1,22 @@
+# Time and peak memory on every engine of about 11M calls, which stays flat however many calls run,
+# 1.1M calls doing arithmetic, and 100k top-level calls that print
+. bench/common.sh
+
+calls="$work/calls11m.csach"
+fanOut "$calls" 7 'let k = 3;
+func leaf(a, b) { let t = a * b + k };' 'leaf(a, 6)'
+
+arithmetic="$work/calls_arithmetic1m.csach"
+fanOut "$arithmetic" 6 'func leaf(a, b) { let t = (a * b + a - b) * 3 % 7 + (a + b) * (a - b) / 5 };' 'leaf(a, 5)'
+
+printing="$work/calls_print100k.csach"
+[ -f "$printing" ] || awk 'BEGIN {
+  printf "let a = 3;\nlet b = 4;\nfunc f(x, y) { let t = x * y + a - b; println(t + x) };\n"
+  for (i = 0; i < 100000; i++) printf "f(%d, %d);\n", i, i + 1
+}' > "$printing"
+
+for engine in --engine=ast --engine=vm --engine=closure; do
+  measure "11M calls, $engine" "$csach" $engine "$calls"
+  measure "1.1M arithmetic calls, $engine" "$csach" $engine "$arithmetic"
+  measure "100k printing calls, $engine" "$csach" $engine "$printing"
+done
\ No newline at end of file
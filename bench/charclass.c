@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "charclass.h"
+#include "lexer.h"
+#include "arena.h"
+#include "io.h"
+
+#define CHARCLASS_RUNS 5 // The best of this many runs is kept
+
+static const char* scannerNames[] = { "scalar", "sse2", "avx2" };
+
+static double now() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Skip every run of the text with the scanner alone, the way the lexer would find where each token ends
+static double timeKernel(const charScanner_T* scanner, const char* text, size_t size) {
+  double best = -1;
+
+  for (int run = 0; run < CHARCLASS_RUNS; run++) {
+    double start = now();
+    size_t i = 0;
+    while (i < size) {
+      if (isSpaceChar(text[i]))
+        i += scanner->skipSpaces(text + i, size - i);
+      else if (isAlphaChar(text[i]))
+        i += scanner->skipIdent(text + i, size - i);
+      else if (isDigitChar(text[i]))
+        i += scanner->skipDigits(text + i, size - i);
+      else if (text[i] == '"')
+        i += 1 + scanner->skipString(text + i + 1, size - i - 1) + 1;
+      else
+        i += 1;
+    }
+
+    double seconds = now() - start;
+    if (best < 0 || seconds < best)
+      best = seconds;
+  }
+
+  return best;
+}
+
+// Lex the whole text, and hash the tokens so every scanner can be checked to give the same ones
+static double timeLexer(char* text, size_t size, unsigned long* hash) {
+  double best = -1;
+
+  for (int run = 0; run < CHARCLASS_RUNS; run++) {
+    double start = now();
+    lexer_T* lexer = initLexer(text, size);
+    *hash = 0;
+    for (token_T* token = getNextToken(lexer); token->type != TOKEN_EOF; token = getNextToken(lexer)) {
+      *hash = *hash * 31 + token->type * 7 + token->length + (unsigned long) (token->val - text) + token->intVal;
+      freeToken(token);
+    }
+
+    double seconds = now() - start;
+    if (best < 0 || seconds < best)
+      best = seconds;
+  }
+
+  return best;
+}
+
+// Time the scalar, SSE2 and AVX2 scanners on a file, alone and inside the lexer.
+// Usage: charclass.out <file.csach>
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    printf("Usage: %s <file.csach>\n", argv[0]);
+    exit(1);
+  }
+
+  programArena = initArena();
+
+  size_t size;
+  char* text = getFileContents(argv[1], &size);
+  unsigned long scalarHash = 0;
+
+  for (size_t i = 0; i < sizeof(scannerNames) / sizeof(scannerNames[0]); i++) {
+    // The lexer picks up the scanner that was forced last
+    const charScanner_T* scanner = useCharScanner(scannerNames[i]);
+    if (strcmp(scanner->name, scannerNames[i]) != 0) {
+      printf("    %-7s not supported by this CPU\n", scannerNames[i]);
+      continue;
+    }
+
+    unsigned long hash;
+    double kernel = timeKernel(scanner, text, size);
+    double lexer = timeLexer(text, size, &hash);
+    printf("    %-7s kernel %6.0f MB/s   lexer %6.0f MB/s\n", scanner->name, size / kernel / 1e6, size / lexer / 1e6);
+
+    if (i == 0)
+      scalarHash = hash;
+    else if (hash != scalarHash) {
+      printf("The %s scanner gives different tokens than the scalar one.\n", scanner->name);
+      exit(1);
+    }
+  }
+
+  releaseFileContents(text, size);
+  freeArena(programArena);
+
+  return 0;
+}
\ No newline at end of file
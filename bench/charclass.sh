@@ -0,0 +1,20 @@
+# The scalar, SSE2 and AVX2 character scanners, alone and inside the lexer, on whitespace-heavy and identifier-heavy programs
+. bench/common.sh
+
+spaces="$work/charclass_spaces.csach"
+[ -f "$spaces" ] || awk 'BEGIN {
+  srand(1)
+  for (i = 0; i < 200000; i++) {
+    for (j = int(rand() * 4); j > 0; j--) printf "\n"
+    for (j = int(rand() * 60); j > 0; j--) printf (rand() < 0.2 ? "\t" : " ")
+    printf "println(a%d);\n", i
+  }
+}' > "$spaces"
+
+identifiers="$work/charclass_identifiers.csach"
+generate "$identifiers" 200000 'printf "let someFairlyLongIdentifierName%d = anotherQuiteLongIdentifier%d + %d;\nprintln(\"a string literal that goes on for a while %d\");\n", i, i * 7, 12345670 + i, i'
+
+echo "  whitespace-heavy:"
+./bench/charclass.out "$spaces"
+echo "  identifier-heavy:"
+./bench/charclass.out "$identifiers"
\ No newline at end of file
@@ -0,0 +1,33 @@
+# Shared by the benchmarks: the interpreter they run, where generated programs go, and how runs are timed
+csach=./csach.out
+runs="${BENCH_RUNS:-3}"
+work="${TMPDIR:-/tmp}/csach-bench"
+mkdir -p "$work"
+
+# measure <label> <command> [arguments...]: print the best wall time and the peak memory of a few runs of a command
+measure() {
+  label="$1"
+  shift
+  printf '  %-44s %s\n' "$label" "$(./bench/timeit.out "$runs" "$@")"
+}
+
+# generate <file> <lines> <awk statement>: write a program once, one awk printf per line i, and reuse it afterwards
+generate() {
+  [ -f "$1" ] || awk -v n="$2" "BEGIN { for (i = 0; i < n; i++) $3 }" > "$1"
+}
+
+# fanOut <file> <levels> <definitions> <call>: write a program once whose functions f0 to f<levels - 1> each call the next
+# level ten times, and whose last level makes the call ten times, so the call runs 10^levels times without a loop
+fanOut() {
+  [ -f "$1" ] || awk -v levels="$2" -v definitions="$3" -v call="$4" 'BEGIN {
+    print definitions
+    for (level = levels - 1; level >= 0; level--) {
+      inner = level == levels - 1 ? call : sprintf("f%d(a + 1)", level + 1)
+      printf "func f%d(a) { %s", level, inner
+      for (i = 1; i < 10; i++) printf "; %s", inner
+      printf " };\n"
+    }
+    print "f0(1);"
+    print "println(\"done\")"
+  }' > "$1"
+}
\ No newline at end of file
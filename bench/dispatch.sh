@@ -0,0 +1,37 @@
+# Per-dispatch cost of the VM with switch and computed goto dispatch, with and without superinstructions.
+# --no-optimize turns off the peephole fusion, and the AST optimizer with it
+. bench/common.sh
+
+# make builds the computed goto dispatch, the switch dispatch is built here from the same sources
+switch="$work/csach_switch.out"
+${CC:-cc} ${flags:--O2} -DVM_SWITCH_DISPATCH src/*.c -pthread -o "$switch" || exit 1
+
+calls="$work/calls11m.csach"
+fanOut "$calls" 7 'let k = 3;
+func leaf(a, b) { let t = a * b + k };' 'leaf(a, 6)'
+
+arithmetic="$work/calls_arithmetic1m.csach"
+fanOut "$arithmetic" 6 'func leaf(a, b) { let t = (a * b + a - b) * 3 % 7 + (a + b) * (a - b) / 5 };' 'leaf(a, 5)'
+
+locals="$work/dispatch_locals1m.csach"
+fanOut "$locals" 6 'func leaf(a) { let b = a + 1; let c = b + 2; let d = c + b; let e = d + 3; let f = e * d; let g = f + a };' 'leaf(a)'
+
+# dispatch <label> <interpreter> <program> [options...]: time a run, and divide by the instructions it runs
+dispatch() {
+  label="$1"
+  interpreter="$2"
+  program="$3"
+  shift 3
+
+  instructions=$("$csach" --profile-ops "$@" "$program" 2>&1 >/dev/null | sed -n 's/^Instruction mix, \([0-9]*\) instructions:$/\1/p')
+  timing=$(./bench/timeit.out "$runs" "$interpreter" "$@" "$program")
+  echo "$label $instructions $timing" | awk '{ printf "    %-34s %10d instructions %8.3f s %6.2f ns/instruction\n", $1, $2, $3, $3 * 1e9 / $2 }'
+}
+
+for program in "$calls" "$arithmetic" "$locals"; do
+  echo "  $(basename "$program" .csach):"
+  dispatch "switch,no-fusion" "$switch" "$program" --no-optimize
+  dispatch "switch,fused" "$switch" "$program"
+  dispatch "goto,no-fusion" "$csach" "$program" --no-optimize
+  dispatch "goto,fused" "$csach" "$program"
+done
\ No newline at end of file
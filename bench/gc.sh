@@ -0,0 +1,20 @@
+# Memory stays bounded while a program makes and drops 10M strings or ropes, and what --gc-stats reports for them
+. bench/common.sh
+
+strings="$work/gc_strings10m.csach"
+[ -f "$strings" ] || printf 'func join(a, b) { ret a + b };\nfunc loop(n) { let s = join("abcdef", "ghijklm"); if (n > 0) { ret loop(n - 1) } };\nloop(10000000);\n' > "$strings"
+
+ropes="$work/gc_ropes10m.csach"
+[ -f "$ropes" ] || printf 'func join(a, b) { ret a + b };\nfunc loop(n) { let s = join("a string of forty bytes, give or take it", "and another one that is about as long!!"); if (n > 0) { ret loop(n - 1) } };\nloop(10000000);\n' > "$ropes"
+
+factorial="$work/gc_factorial.csach"
+[ -f "$factorial" ] || printf 'func factorial(n, product) { if (n == 0) { ret product }; ret factorial(n - 1, product * n) };\nprintln(factorial(10000, 1));\n' > "$factorial"
+
+chain="$work/gc_chain1m.csach"
+[ -f "$chain" ] || printf 'func grow(n, s) { if (n == 0) { ret s }; ret grow(n - 1, s + "ab") };\nprintln(grow(1000000, ""));\n' > "$chain"
+
+for program in "$strings" "$ropes" "$factorial" "$chain"; do
+  name=$(basename "$program" .csach)
+  measure "$name" "$csach" "$program"
+  "$csach" --gc-stats "$program" 2>&1 >/dev/null | sed 's/^/    /'
+done
\ No newline at end of file
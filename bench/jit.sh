@@ -0,0 +1,13 @@
+# The JIT against the VM on fib(32), about 7M calls, and a 50M-step tail loop, with the default threshold and a threshold of 1
+. bench/common.sh
+
+fib="$work/jit_fib32.csach"
+[ -f "$fib" ] || printf 'func fib(n) { if (n < 2) { ret n }; ret fib(n - 1) + fib(n - 2) };\nprintln(fib(32));\n' > "$fib"
+
+loop="$work/jit_loop50m.csach"
+[ -f "$loop" ] || printf 'func loop(n, total) { if (n == 0) { ret total }; ret loop(n - 1, total + n %% 7) };\nprintln(loop(50000000, 0));\n' > "$loop"
+
+for options in "--engine=vm" "--jit" "--jit --jit-threshold=1"; do
+  measure "fib(32), $options" "$csach" $options "$fib"
+  measure "50M-step tail loop, $options" "$csach" $options "$loop"
+done
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "lexer.h"
+#include "arena.h"
+#include "io.h"
+
+// Lex a program without parsing it, and print how many tokens per second the lexer turns out.
+// Usage: lexer.out <file.csach>
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    printf("Usage: %s <file.csach>\n", argv[0]);
+    exit(1);
+  }
+
+  programArena = initArena();
+
+  size_t contentsSize;
+  char* contents = getFileContents(argv[1], &contentsSize);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  lexer_T* lexer = initLexer(contents, contentsSize);
+  size_t tokens = 0;
+  for (token_T* token = getNextToken(lexer); token->type != TOKEN_EOF; token = getNextToken(lexer)) {
+    tokens += 1;
+    freeToken(token); // Tokens are recycled the way the parser recycles them
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("%10zu bytes %9zu tokens %8.3f s %7.2f Mtokens/s %6.1f ns/token\n",
+    contentsSize, tokens, seconds, tokens / seconds / 1e6, seconds * 1e9 / tokens);
+
+  releaseFileContents(contents, contentsSize);
+  freeArena(programArena);
+
+  return 0;
+}
\ No newline at end of file
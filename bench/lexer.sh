@@ -0,0 +1,9 @@
+# Lexing time grows linearly with the size of the program: ns/token stays flat from 62 KB to 14 MB
+. bench/common.sh
+
+for lines in 1000 4000 16000 225000; do
+  program="$work/lexer$lines.csach"
+  generate "$program" "$lines" 'printf "let value%d = %d * 2 + 7;\nprintln(\"line number\", value%d);\n", i, i, i'
+  printf '  '
+  ./bench/lexer.out "$program"
+done
\ No newline at end of file
@@ -0,0 +1,10 @@
+# Time to the first statement and peak memory of a 100 MB program that prints a line and exits before the rest runs
+. bench/common.sh
+
+program="$work/load100mb.csach"
+[ -f "$program" ] || awk 'BEGIN {
+  printf "println(\"first\");\nexit();\n"
+  for (i = 0; i < 1259763; i++) printf "println(\"generated line number %d with some padding text\", %d, '"'c'"', true);\n", i, i
+}' > "$program"
+
+measure "100 MB program, println then exit" "$csach" "$program"
\ No newline at end of file
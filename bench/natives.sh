@@ -0,0 +1,14 @@
+# Calls through the registry of built-in functions: 10M print() calls with nothing to print, next to 11M calls of user functions
+. bench/common.sh
+
+natives="$work/natives10m.csach"
+[ -f "$natives" ] || printf 'func loop(n) { print(); print(); print(); print(); print(); print(); print(); print(); print(); print(); if (n > 0) { ret loop(n - 1) } };\nloop(1000000);\n' > "$natives"
+
+calls="$work/calls11m.csach"
+fanOut "$calls" 7 'let k = 3;
+func leaf(a, b) { let t = a * b + k };' 'leaf(a, 6)'
+
+for engine in --engine=vm --engine=ast; do
+  measure "10M print() calls, $engine" "$csach" $engine "$natives"
+  measure "11M user calls, $engine" "$csach" $engine "$calls"
+done
\ No newline at end of file
@@ -0,0 +1,23 @@
+# Arithmetic-heavy programs with the optimizer on and off: 20k printlns reading 200 chained lets, and one 640k-term literal expression
+. bench/common.sh
+
+lets="$work/optimizer_lets.csach"
+[ -f "$lets" ] || awk 'BEGIN {
+  srand(1)
+  printf "let c0 = 7;\n"
+  for (i = 1; i < 200; i++) printf "let c%d = (c%d * 3 + %d) %% 1000 + 2 ^ 4 - 16 * 1;\n", i, i - 1, i
+  for (i = 0; i < 20000; i++) printf "println(c%d + c%d * c%d - (%d + 0));\n", int(rand() * 200), int(rand() * 200), int(rand() * 200), i
+}' > "$lets"
+
+expression="$work/optimizer_expression.csach"
+[ -f "$expression" ] || awk 'BEGIN {
+  srand(1)
+  printf "let x = 1"
+  for (i = 1; i < 640000; i++) printf " %s %d", substr("+-*", int(rand() * 3) + 1, 1), int(rand() * 9) + 1
+  printf ";\nprintln(x);\n"
+}' > "$expression"
+
+measure "chained lets" "$csach" "$lets"
+measure "chained lets, --no-optimize" "$csach" --no-optimize "$lets"
+measure "640k-term expression" "$csach" "$expression"
+measure "640k-term expression, --no-optimize" "$csach" --no-optimize "$expression"
\ No newline at end of file
@@ -0,0 +1,13 @@
+# Printing to /dev/null through the output buffer: 10M ints one per line, and 3M lines of three ints
+. bench/common.sh
+
+ints="$work/output_ints10m.csach"
+[ -f "$ints" ] || printf 'func loop(n) { println(n); if (n > 1) { ret loop(n - 1) } };\nloop(10000000);\n' > "$ints"
+
+lines="$work/output_lines3m.csach"
+[ -f "$lines" ] || printf 'func loop(n) { println(n, -n, n * 1000000007); if (n > 1) { ret loop(n - 1) } };\nloop(3000000);\n' > "$lines"
+
+for engine in --engine=vm --engine=ast; do
+  measure "10M println(n), $engine" "$csach" $engine "$ints"
+  measure "3M println(n, -n, n * k), $engine" "$csach" $engine "$lines"
+done
\ No newline at end of file
@@ -0,0 +1,13 @@
+#!/bin/sh
+# Run every benchmark in bench/, or only the ones named, e.g. ./bench/run.sh lexer.
+# Numbers worth comparing need an optimized build: make clean && make bench flags=-O2
+cd "$(dirname "$0")/.."
+
+if [ $# -eq 0 ]; then
+  set -- $(ls bench/*.sh | sed 's#bench/\(.*\)\.sh#\1#' | grep -v '^run$\|^common$')
+fi
+
+for name in "$@"; do
+  echo "$name:"
+  sh "bench/$name.sh" || exit 1
+done
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "scope.h"
+#include "symbol.h"
+#include "arena.h"
+
+#define SCOPE_MAX_ENTRIES 100000
+
+static const size_t scopeSizes[] = { 10, 100, 1000, 10000, SCOPE_MAX_ENTRIES };
+
+// Look up random names in scopes of 10 to 100k variables, and print the time each lookup takes.
+// Usage: scope.out
+int main() {
+  programArena = initArena();
+  initSymbols();
+
+  // The names are interned once, like the lexer interns them before the resolver looks them up
+  symbol_T* symbols = malloc(SCOPE_MAX_ENTRIES * sizeof(symbol_T));
+  for (size_t i = 0; i < SCOPE_MAX_ENTRIES; i++) {
+    char name[32];
+    int length = snprintf(name, sizeof(name), "v%zu", i);
+    symbols[i] = internSymbol(name, length);
+  }
+
+  for (size_t s = 0; s < sizeof(scopeSizes) / sizeof(scopeSizes[0]); s++) {
+    size_t entries = scopeSizes[s];
+    scope_T* scope = initScope((void*) 0);
+    for (size_t i = 0; i < entries; i++) {
+      AST_T* varDef = initAST(AST_VARIABLE_DEFINITION);
+      varDef->varDefSymbol = symbols[i];
+      scopeAddVarDef(scope, varDef);
+    }
+
+    // A cheap generator keeps the names in an order the cache can't guess
+    size_t lookups = 2000000;
+    size_t found = 0;
+    unsigned int random = 1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < lookups; i++) {
+      random = random * 1103515245u + 12345u;
+      found += scopeGetVarDef(scope, symbols[(random >> 8) % entries]) != (void*) 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double nanoseconds = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / lookups;
+    printf("  %6zu entries %8.1f ns/lookup\n", entries, nanoseconds);
+
+    if (found != lookups) {
+      printf("Only %zu of %zu names were found.\n", found, lookups);
+      exit(1);
+    }
+  }
+
+  free(symbols);
+  freeArena(programArena);
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+# Lookups in scopes of 10 to 100k variables, and a program with 20k globals and 20k printlns reading them
+. bench/common.sh
+
+./bench/scope.out
+
+program="$work/scope_globals.csach"
+[ -f "$program" ] || awk 'BEGIN {
+  for (i = 0; i < 20000; i++) printf "let v%d = %d;\n", i, i
+  for (i = 0; i < 20000; i++) printf "println(v%d);\n", (i * 7919) % 20000
+}' > "$program"
+
+measure "20k globals, 20k printlns" "$csach" "$program"
\ No newline at end of file
@@ -0,0 +1,18 @@
+# String joins: 1M chained joins, which make ropes, and 1M joins of two short strings into 5 and 13 bytes,
+# with the memory the runtime allocated for them from --alloc-stats
+. bench/common.sh
+
+chain="$work/strings_chain1m.csach"
+[ -f "$chain" ] || printf 'func grow(n, s) { if (n == 0) { ret s }; ret grow(n - 1, s + "ab") };\nprintln(grow(1000000, ""));\n' > "$chain"
+
+short="$work/strings_short1m.csach"
+[ -f "$short" ] || printf 'func join(a, b) { ret a + b };\nfunc loop(n) { let s = join("ab", "cde"); if (n > 0) { ret loop(n - 1) } };\nloop(1000000);\n' > "$short"
+
+long="$work/strings_long1m.csach"
+[ -f "$long" ] || printf 'func join(a, b) { ret a + b };\nfunc loop(n) { let s = join("abcdef", "ghijklm"); if (n > 0) { ret loop(n - 1) } };\nloop(1000000);\n' > "$long"
+
+for program in "$chain" "$short" "$long"; do
+  name=$(basename "$program" .csach)
+  measure "$name" "$csach" "$program"
+  printf '    %s\n' "$("$csach" --alloc-stats "$program" 2>&1 | tail -n 1)"
+done
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Run a command a number of times with its output thrown away, and print its best wall time and its peak memory.
+// Usage: timeit.out <runs> <command> [arguments...]
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    printf("Usage: %s <runs> <command> [arguments...]\n", argv[0]);
+    exit(1);
+  }
+
+  int runs = atoi(argv[1]);
+  double best = -1;
+  long peak = 0; // Kilobytes
+  int status = 0;
+
+  for (int run = 0; run < runs; run++) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pid_t child = fork();
+    if (child == 0) {
+      int devNull = open("/dev/null", O_WRONLY);
+      dup2(devNull, 1);
+      execvp(argv[2], argv + 2);
+      _exit(127);
+    }
+
+    struct rusage usage;
+    wait4(child, &status, 0, &usage);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (best < 0 || seconds < best)
+      best = seconds;
+    if (usage.ru_maxrss > peak)
+      peak = usage.ru_maxrss;
+  }
+
+  printf("%8.3f s %10ld KB", best, peak);
+  if (WEXITSTATUS(status) != 0)
+    printf("  exit %d", WEXITSTATUS(status));
+  printf("\n");
+
+  return 0;
+}
\ No newline at end of file
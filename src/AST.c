@@ -1,9 +1,176 @@
+#include <stdio.h>
+#include <string.h>
 #include "include/AST.h"
+#include "include/token.h"
+#include "include/arena.h"
+
+AST_T** astChunks = (void*) 0; // The chunks of the node pool
+static size_t astChunksSize; // The amount of chunks
+static astIndex_T astNodesSize; // The amount of nodes
+
+astIndex_T* astLists = (void*) 0; // Every list of children, back to back
+static size_t astListsSize; // The amount of indices in the list pool
+static size_t astListsCapacity; // The amount of indices there is room for
 
 // Initialize an AST node
 AST_T* initAST(int type) {
-  AST_T* ast = calloc(1, sizeof(struct AST_STRUCT)); // Allocate memory for the AST node
+  // Node 0 stands for "no node", so the pool starts by skipping it
+  if (astNodesSize == 0)
+    astNodesSize = 1;
+
+  // Start a new chunk when the last one is full
+  if ((astNodesSize >> AST_CHUNK_BITS) == astChunksSize) {
+    astChunks = arenaGrowArray(programArena, astChunks, astChunksSize, sizeof(AST_T*));
+    astChunks[astChunksSize] = programAlloc(AST_CHUNK_SIZE * sizeof(struct AST_STRUCT));
+    astChunksSize += 1;
+  }
+
+  AST_T* ast = astGet(astNodesSize); // Take the next node from the pool
   ast->type = type; // Set the type of the AST node
+  ast->index = astNodesSize++; // Remember where it is
 
   return ast;
+}
+
+astIndex_T astAddList(const astIndex_T* items, size_t size) {
+  // Index 0 stands for "no list", so the list pool starts by skipping it
+  if (astListsSize == 0)
+    astListsSize = 1;
+
+  // Make sure the list fits, doubling the pool when it doesn't
+  if (astListsSize + size > astListsCapacity) {
+    size_t capacity = astListsCapacity ? astListsCapacity : 256;
+    while (astListsSize + size > capacity)
+      capacity *= 2;
+
+    astLists = arenaGrow(programArena, astLists, astListsCapacity * sizeof(astIndex_T), capacity * sizeof(astIndex_T));
+    astListsCapacity = capacity;
+  }
+
+  // Copy the list to the end of the pool
+  astIndex_T start = astListsSize;
+  memcpy(astLists + start, items, size * sizeof(astIndex_T));
+  astListsSize += size;
+
+  return start;
+}
+
+// The entry of a definition. The table grows to cover every node there is when it is first asked for one past its end
+uint32_t* astFunctionEntry(astFunctionTable_T* table, astIndex_T funcDef) {
+  if (funcDef >= table->capacity) {
+    table->functions = arenaGrow(programArena, table->functions, table->capacity * sizeof(uint32_t), astNodesSize * sizeof(uint32_t));
+    table->capacity = astNodesSize;
+  }
+
+  return &table->functions[funcDef];
+}
+
+// Double a work stack, which is kept in the program arena like the nodes it walks
+void astGrowWork(astWorkStack_T* stack) {
+  size_t capacity = stack->capacity ? stack->capacity * 2 : 64;
+  stack->items = arenaGrow(programArena, stack->items, stack->capacity * sizeof(astWork_T), capacity * sizeof(astWork_T));
+  stack->capacity = capacity;
+}
+
+// How an operator is written
+static const char* operatorText(int operator) {
+  switch (operator) {
+    case TOKEN_PLUS: return "+"; break;
+    case TOKEN_MINUS: return "-"; break;
+    case TOKEN_MULTIPLY: return "*"; break;
+    case TOKEN_DIVIDE: return "/"; break;
+    case TOKEN_MODULO: return "%"; break;
+    case TOKEN_POW: return "^"; break;
+    case TOKEN_EQ: return "=="; break;
+    case TOKEN_NOT_EQ: return "!="; break;
+    case TOKEN_LESS: return "<"; break;
+    case TOKEN_LESS_EQ: return "<="; break;
+    case TOKEN_GREATER: return ">"; break;
+    case TOKEN_GREATER_EQ: return ">="; break;
+    default: return "?"; break;
+  }
+}
+
+// Print an expression on one line, with every operator in parentheses
+static void printExpr(AST_T* node) {
+  switch (node->type) {
+    case INT: printf("%ld", node->intVal); break;
+    case STRING: printf("\"%s\"", node->stringVal); break;
+    case CHAR: printf("'%c'", node->charVal); break;
+    case BOOL: printf("%s", node->boolVal ? "true" : "false"); break;
+    case AST_VARIABLE: printf("%s", symbolName(node->varSymbol)); break;
+    case AST_NOOP: printf("noop"); break;
+
+    case AST_FUNCTION_CALL:
+      printf("%s(", symbolName(node->funcCallSymbol));
+      for (size_t i = 0; i < node->funcCallArgsSize; i++) {
+        if (i)
+          printf(", ");
+        printExpr(astGet(astGetList(node->funcCallArgs)[i]));
+      }
+      printf(")");
+      break;
+
+    case AST_BINOP:
+      printf("(");
+      printExpr(astGet(node->binopLeft));
+      printf(" %s ", operatorText(node->binopOperator));
+      printExpr(astGet(node->binopRight));
+      printf(")");
+      break;
+
+    default: printf("<node with type %d>", node->type); break;
+  }
+}
+
+// Print a tree as source-like text, one statement per line
+void printAST(AST_T* node, int depth) {
+  switch (node->type) {
+    case AST_COMPOUND:
+      for (size_t i = 0; i < node->compoundSize; i++)
+        printAST(astGet(astGetList(node->compoundVal)[i]), depth);
+      break;
+
+    case AST_VARIABLE_DEFINITION:
+      printf("%*slet %s = ", depth * 2, "", symbolName(node->varDefSymbol));
+      printExpr(astGet(node->varDefVal));
+      printf("\n");
+      break;
+
+    case AST_FUNCTION_DEFINITION:
+      printf("%*sfunc %s(", depth * 2, "", symbolName(node->funcDefSymbol));
+      for (size_t i = 0; i < node->funcDefArgsSize; i++)
+        printf(i ? ", %s" : "%s", symbolName(astGet(astGetList(node->funcDefArgs)[i])->varSymbol));
+      printf(") {\n");
+      printAST(astGet(node->funcDefBody), depth + 1);
+      printf("%*s}\n", depth * 2, "");
+      break;
+
+    case AST_STATEMENT_RETURN:
+      printf("%*sret", depth * 2, "");
+      if (node->returnVal) {
+        printf(" ");
+        printExpr(astGet(node->returnVal));
+      }
+      printf("\n");
+      break;
+
+    case AST_IF:
+      printf("%*sif (", depth * 2, "");
+      printExpr(astGet(node->ifCondition));
+      printf(") {\n");
+      printAST(astGet(node->ifBody), depth + 1);
+      if (node->ifElse) {
+        printf("%*s} else {\n", depth * 2, "");
+        printAST(astGet(node->ifElse), depth + 1);
+      }
+      printf("%*s}\n", depth * 2, "");
+      break;
+
+    default:
+      printf("%*s", depth * 2, "");
+      printExpr(node);
+      printf("\n");
+      break;
+  }
 }
\ No newline at end of file
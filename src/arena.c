@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024) // Default size of a block
+#define ARENA_ALIGNMENT 16 // Every allocation is aligned for any type
+
+arena_T* programArena = (void*) 0;
+
+static arenaBlock_T* addBlock(arena_T* arena, size_t size) {
+  // Big allocations get a block of their own
+  if (size < ARENA_BLOCK_SIZE)
+    size = ARENA_BLOCK_SIZE;
+
+  arenaBlock_T* block = malloc(sizeof(struct ARENA_BLOCK_STRUCT));
+  char* data = calloc(1, size); // Blocks start zeroed, so allocations come out zeroed like calloc
+
+  if (!block || !data) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+
+  block->data = data;
+  block->size = size;
+  block->used = 0;
+  block->next = arena->blocks;
+  arena->blocks = block;
+  arena->blocksSize += 1;
+
+  return block;
+}
+
+arena_T* initArena() {
+  arena_T* arena = calloc(1, sizeof(struct ARENA_STRUCT)); // Allocate memory for the arena
+  addBlock(arena, ARENA_BLOCK_SIZE); // Start with one block
+
+  return arena;
+}
+
+void* arenaAlloc(arena_T* arena, size_t size) {
+  // Round the size up so the next allocation stays aligned
+  size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+
+  arenaBlock_T* block = arena->blocks;
+
+  // If the current block is full, start a new one
+  if (block->used + size > block->size)
+    block = addBlock(arena, size);
+
+  void* ptr = block->data + block->used;
+  block->used += size;
+  arena->bytesUsed += size;
+  arena->last = ptr;
+
+  return ptr;
+}
+
+void* arenaGrow(arena_T* arena, void* ptr, size_t oldSize, size_t newSize) {
+  if (!ptr)
+    return arenaAlloc(arena, newSize);
+
+  size_t oldRounded = (oldSize + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+  size_t newRounded = (newSize + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+  arenaBlock_T* block = arena->blocks;
+
+  // The most recent allocation can simply take more of its block
+  if (ptr == arena->last && block->used - oldRounded + newRounded <= block->size) {
+    block->used = block->used - oldRounded + newRounded;
+    arena->bytesUsed = arena->bytesUsed - oldRounded + newRounded;
+    return ptr;
+  }
+
+  // Otherwise move it somewhere with enough room, the old copy is released with the arena
+  void* grown = arenaAlloc(arena, newSize);
+  memcpy(grown, ptr, oldSize);
+
+  return grown;
+}
+
+void* arenaGrowArray(arena_T* arena, void* array, size_t size, size_t elemSize) {
+  // Arrays that grow one element at a time keep a capacity of the next power of two,
+  // so they only have to move when their size reaches a power of two
+  if (size == 0)
+    return arenaAlloc(arena, elemSize);
+
+  if ((size & (size - 1)) != 0)
+    return array;
+
+  return arenaGrow(arena, array, size * elemSize, size * 2 * elemSize);
+}
+
+char* arenaStrndup(arena_T* arena, const char* str, size_t length) {
+  // Copy the text into its own null terminated string
+  char* copy = arenaAlloc(arena, length + 1);
+  memcpy(copy, str, length);
+
+  return copy;
+}
+
+void freeArena(arena_T* arena) {
+  // Free every block at once
+  arenaBlock_T* block = arena->blocks;
+  while (block) {
+    arenaBlock_T* next = block->next;
+    free(block->data);
+    free(block);
+    block = next;
+  }
+
+  free(arena);
+}
+
+void* programAlloc(size_t size) {
+  // The program's arena is created the first time something needs it
+  if (!programArena)
+    programArena = initArena();
+
+  return arenaAlloc(programArena, size);
+}
\ No newline at end of file
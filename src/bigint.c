@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/bigint.h"
+#include "include/token.h"
+#include "include/gc.h"
+
+// An int seen as a sign and a magnitude, wherever it is held
+typedef struct BIG_VIEW_STRUCT {
+  bool negative;
+  size_t length; // The last limb is never 0, so 0 has no limbs
+  const uint32_t* limbs;
+} bigView_T;
+
+// Memory for a magnitude that is being worked out. It is released once the result is in an object
+static uint32_t* allocLimbs(size_t size) {
+  uint32_t* limbs = malloc((size ? size : 1) * sizeof(uint32_t));
+
+  if (!limbs) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+
+  return limbs;
+}
+
+// The length of a magnitude without the zero limbs at its top
+static size_t trimLimbs(const uint32_t* limbs, size_t length) {
+  while (length > 0 && limbs[length - 1] == 0)
+    length -= 1;
+
+  return length;
+}
+
+// Look at an int as a sign and a magnitude. An int of the word is spread over the two limbs given
+static bigView_T viewInt(value_T value, uint32_t* wordLimbs) {
+  bigView_T view;
+
+  if (valueIsSmallInt(value)) {
+    long number = valueToSmallInt(value);
+    uint64_t magnitude = number < 0 ? 0 - (uint64_t) number : (uint64_t) number;
+
+    wordLimbs[0] = (uint32_t) magnitude;
+    wordLimbs[1] = (uint32_t) (magnitude >> 32);
+    view.negative = number < 0;
+    view.length = trimLimbs(wordLimbs, 2);
+    view.limbs = wordLimbs;
+    return view;
+  }
+
+  intObject_T* object = (intObject_T*) valueToObject(value);
+  view.negative = object->negative;
+  view.length = object->length;
+  view.limbs = object->limbs;
+  return view;
+}
+
+// Make the value of a worked out int, in the word when it fits
+static value_T makeInt(bool negative, const uint32_t* limbs, size_t length) {
+  length = trimLimbs(limbs, length);
+
+  if (length <= 2) {
+    uint64_t magnitude = length == 0 ? 0 : limbs[0] | (length == 2 ? (uint64_t) limbs[1] << 32 : 0);
+
+    // The word holds one more negative number than positive ones
+    if (magnitude <= (uint64_t) VALUE_SMALL_INT_MAX + negative)
+      return valueFromSmallInt(negative ? -(long) magnitude : (long) magnitude);
+  }
+
+  intObject_T* object = allocObject(OBJECT_INT, sizeof(struct INT_OBJECT_STRUCT) + length * sizeof(uint32_t));
+  object->negative = negative;
+  object->length = length;
+  memcpy(object->limbs, limbs, length * sizeof(uint32_t));
+
+  return (value_T) (uintptr_t) object;
+}
+
+static int compareMagnitudes(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize) {
+  if (aSize != bSize)
+    return aSize < bSize ? -1 : 1;
+
+  for (size_t i = aSize; i > 0; i--) {
+    if (a[i - 1] != b[i - 1])
+      return a[i - 1] < b[i - 1] ? -1 : 1;
+  }
+
+  return 0;
+}
+
+// a + b into out, which has room for aSize + 1 limbs. a is at least as long as b
+static size_t addMagnitudes(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize, uint32_t* out) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < aSize; i++) {
+    carry += (uint64_t) a[i] + (i < bSize ? b[i] : 0);
+    out[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+  out[aSize] = (uint32_t) carry;
+
+  return aSize + 1;
+}
+
+// a - b into out, which has room for aSize limbs. a is at least as big as b
+static size_t subtractMagnitudes(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize, uint32_t* out) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < aSize; i++) {
+    uint64_t difference = (uint64_t) a[i] - (i < bSize ? b[i] : 0) - borrow;
+    out[i] = (uint32_t) difference;
+    borrow = difference >> 63; // Going below 0 wraps around to the top of the 64 bits
+  }
+
+  return aSize;
+}
+
+// to += from, where the sum is known to fit in the limbs of to
+static void addInto(uint32_t* to, size_t toSize, const uint32_t* from, size_t fromSize) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < toSize && (i < fromSize || carry); i++) {
+    carry += (uint64_t) to[i] + (i < fromSize ? from[i] : 0);
+    to[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+}
+
+// to -= from, where to is known to be at least as big as from
+static void subtractFrom(uint32_t* to, size_t toSize, const uint32_t* from, size_t fromSize) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < toSize && (i < fromSize || borrow); i++) {
+    uint64_t difference = (uint64_t) to[i] - (i < fromSize ? from[i] : 0) - borrow;
+    to[i] = (uint32_t) difference;
+    borrow = difference >> 63;
+  }
+}
+
+static void schoolbookMultiply(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize, uint32_t* out) {
+  memset(out, 0, (aSize + bSize) * sizeof(uint32_t));
+
+  for (size_t i = 0; i < aSize; i++) {
+    uint64_t limb = a[i];
+    if (!limb)
+      continue;
+
+    // The largest a limb times a limb plus two more still fits in 64 bits
+    uint64_t carry = 0;
+    for (size_t j = 0; j < bSize; j++) {
+      carry += limb * b[j] + out[i + j];
+      out[i + j] = (uint32_t) carry;
+      carry >>= 32;
+    }
+    out[i + bSize] = (uint32_t) carry;
+  }
+}
+
+// a * b into out, which has room for aSize + bSize limbs and can't overlap either of them
+static void multiplyMagnitudes(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize, uint32_t* out) {
+  // Make a the longer one
+  if (aSize < bSize) {
+    const uint32_t* limbs = a;
+    a = b;
+    b = limbs;
+
+    size_t size = aSize;
+    aSize = bSize;
+    bSize = size;
+  }
+
+  if (bSize < BIGINT_KARATSUBA_THRESHOLD) {
+    schoolbookMultiply(a, aSize, b, bSize, out);
+    return;
+  }
+
+  size_t half = (aSize + 1) / 2;
+
+  // When b is no longer than half of a, a is multiplied a piece as long as b at a time
+  if (bSize <= half) {
+    memset(out, 0, (aSize + bSize) * sizeof(uint32_t));
+    uint32_t* product = allocLimbs(2 * bSize);
+
+    for (size_t i = 0; i < aSize; i += bSize) {
+      size_t size = aSize - i < bSize ? aSize - i : bSize;
+      multiplyMagnitudes(a + i, size, b, bSize, product);
+      addInto(out + i, aSize + bSize - i, product, size + bSize);
+    }
+
+    free(product);
+    return;
+  }
+
+  // With a = a1 B^half + a0 and b = b1 B^half + b0, a b = z2 B^2half + z1 B^half + z0,
+  // where z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1) - z0 - z2 takes one product instead of two
+  size_t highSize = aSize + bSize - 2 * half;
+  multiplyMagnitudes(a, half, b, half, out);
+  multiplyMagnitudes(a + half, aSize - half, b + half, bSize - half, out + 2 * half);
+
+  uint32_t* sums = allocLimbs(2 * (half + 1));
+  addMagnitudes(a, half, a + half, aSize - half, sums);
+  addMagnitudes(b, half, b + half, bSize - half, sums + half + 1);
+
+  uint32_t* middle = allocLimbs(2 * (half + 1));
+  multiplyMagnitudes(sums, half + 1, sums + half + 1, half + 1, middle);
+  subtractFrom(middle, 2 * (half + 1), out, 2 * half);
+  subtractFrom(middle, 2 * (half + 1), out + 2 * half, highSize);
+
+  addInto(out + half, aSize + bSize - half, middle, trimLimbs(middle, 2 * (half + 1)));
+
+  free(sums);
+  free(middle);
+}
+
+// a / b into quotient, with aSize - bSize + 1 limbs, and a % b into remainder, with bSize limbs.
+// a is at least as long as b, and b isn't 0. This is Knuth's algorithm D, which guesses each limb of the quotient
+// from the top limbs and corrects the guess, after shifting b so its top limb has its highest bit set
+static void divideMagnitudes(const uint32_t* a, size_t aSize, const uint32_t* b, size_t bSize, uint32_t* quotient, uint32_t* remainder) {
+  // Dividing by one limb takes one pass
+  if (bSize == 1) {
+    uint64_t rest = 0;
+    for (size_t i = aSize; i > 0; i--) {
+      uint64_t current = (rest << 32) | a[i - 1];
+      quotient[i - 1] = (uint32_t) (current / b[0]);
+      rest = current % b[0];
+    }
+    remainder[0] = (uint32_t) rest;
+    return;
+  }
+
+  int shift = __builtin_clz(b[bSize - 1]);
+  uint32_t* u = allocLimbs(aSize + 1);
+  uint32_t* v = allocLimbs(bSize);
+
+  for (size_t i = bSize - 1; i > 0; i--)
+    v[i] = (b[i] << shift) | (shift ? b[i - 1] >> (32 - shift) : 0);
+  v[0] = b[0] << shift;
+
+  u[aSize] = shift ? a[aSize - 1] >> (32 - shift) : 0;
+  for (size_t i = aSize - 1; i > 0; i--)
+    u[i] = (a[i] << shift) | (shift ? a[i - 1] >> (32 - shift) : 0);
+  u[0] = a[0] << shift;
+
+  for (size_t j = aSize - bSize + 1; j-- > 0;) {
+    // Guess from the top two limbs, which is at most two too big once checked against the third
+    uint64_t top = ((uint64_t) u[j + bSize] << 32) | u[j + bSize - 1];
+    uint64_t guess = top / v[bSize - 1];
+    uint64_t rest = top % v[bSize - 1];
+
+    while (guess >> 32 || guess * v[bSize - 2] > ((rest << 32) | u[j + bSize - 2])) {
+      guess -= 1;
+      rest += v[bSize - 1];
+      if (rest >> 32)
+        break;
+    }
+
+    // Take guess times v away from the running part of u
+    int64_t borrow = 0;
+    int64_t difference;
+    for (size_t i = 0; i < bSize; i++) {
+      uint64_t product = guess * v[i];
+      difference = (int64_t) u[i + j] - borrow - (int64_t) (product & 0xFFFFFFFF);
+      u[i + j] = (uint32_t) difference;
+      borrow = (int64_t) (product >> 32) - (difference >> 32);
+    }
+    difference = (int64_t) u[j + bSize] - borrow;
+    u[j + bSize] = (uint32_t) difference;
+
+    // The guess was still one too big, so v is added back
+    if (difference < 0) {
+      guess -= 1;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < bSize; i++) {
+        carry += (uint64_t) u[i + j] + v[i];
+        u[i + j] = (uint32_t) carry;
+        carry >>= 32;
+      }
+      u[j + bSize] += (uint32_t) carry;
+    }
+
+    quotient[j] = (uint32_t) guess;
+  }
+
+  // What is left of u is the remainder, shifted back
+  for (size_t i = 0; i < bSize; i++)
+    remainder[i] = (u[i] >> shift) | (shift ? u[i + 1] << (32 - shift) : 0);
+
+  free(u);
+  free(v);
+}
+
+static value_T addInts(bigView_T left, bigView_T right, bool subtract) {
+  // Subtracting adds the right side with its sign flipped
+  right.negative = right.negative != subtract;
+
+  // Make left the one with the bigger magnitude, the result takes its sign
+  if (compareMagnitudes(left.limbs, left.length, right.limbs, right.length) < 0) {
+    bigView_T view = left;
+    left = right;
+    right = view;
+  }
+
+  uint32_t* limbs = allocLimbs(left.length + 1);
+  size_t length;
+  if (left.negative == right.negative)
+    length = addMagnitudes(left.limbs, left.length, right.limbs, right.length, limbs);
+  else
+    length = subtractMagnitudes(left.limbs, left.length, right.limbs, right.length, limbs);
+
+  value_T result = makeInt(left.negative, limbs, length);
+  free(limbs);
+
+  return result;
+}
+
+static value_T multiplyInts(bigView_T left, bigView_T right) {
+  if (left.length == 0 || right.length == 0)
+    return valueFromSmallInt(0);
+
+  uint32_t* limbs = allocLimbs(left.length + right.length);
+  multiplyMagnitudes(left.limbs, left.length, right.limbs, right.length, limbs);
+
+  value_T result = makeInt(left.negative != right.negative, limbs, left.length + right.length);
+  free(limbs);
+
+  return result;
+}
+
+// Division rounds towards 0 and the remainder has the sign of the left side, the same as for ints of the word
+static value_T divideInts(int operator, bigView_T left, bigView_T right) {
+  if (right.length == 0) {
+    printf("Error: Division by zero.\n");
+    exit(1);
+  }
+
+  // A smaller magnitude goes 0 times, and is what remains
+  if (compareMagnitudes(left.limbs, left.length, right.limbs, right.length) < 0)
+    return operator == TOKEN_DIVIDE ? valueFromSmallInt(0) : makeInt(left.negative, left.limbs, left.length);
+
+  uint32_t* quotient = allocLimbs(left.length - right.length + 1);
+  uint32_t* remainder = allocLimbs(right.length);
+  divideMagnitudes(left.limbs, left.length, right.limbs, right.length, quotient, remainder);
+
+  value_T result = operator == TOKEN_DIVIDE ?
+    makeInt(left.negative != right.negative, quotient, left.length - right.length + 1) :
+    makeInt(left.negative, remainder, right.length);
+  free(quotient);
+  free(remainder);
+
+  return result;
+}
+
+// Exponentiation by squaring, from the highest bit of the exponent down, so it takes a squaring per bit
+// and a multiplication per set bit instead of a multiplication per unit of the exponent
+static value_T powerInts(bigView_T base, value_T exponent) {
+  if (bigIntCompare(exponent, valueFromSmallInt(0)) < 0) {
+    printf("Error: Negative exponents are not supported for this number type.\n");
+    exit(1);
+  }
+
+  // 0, 1 and -1 stay that small however big the exponent is
+  bool isSmall = valueIsSmallInt(exponent);
+  if (base.length == 0)
+    return valueFromSmallInt(isSmall && valueToSmallInt(exponent) == 0);
+
+  if (base.length == 1 && base.limbs[0] == 1) {
+    bool odd = isSmall ? valueToSmallInt(exponent) & 1 : ((intObject_T*) valueToObject(exponent))->limbs[0] & 1;
+    return valueFromSmallInt(base.negative && odd ? -1 : 1);
+  }
+
+  // Anything else grows with the exponent, and has to stay within what can be held
+  long power = isSmall ? valueToSmallInt(exponent) : -1;
+  if (power < 0 || (size_t) power > BIGINT_MAX_LIMBS / base.length) {
+    printf("Error: The result of ^ is too big.\n");
+    exit(1);
+  }
+
+  if (power == 0)
+    return valueFromSmallInt(1);
+
+  uint32_t* result = allocLimbs(base.length);
+  memcpy(result, base.limbs, base.length * sizeof(uint32_t));
+  size_t length = base.length;
+
+  for (int bit = 62 - __builtin_clzl((unsigned long) power); bit >= 0; bit--) {
+    uint32_t* squared = allocLimbs(2 * length);
+    multiplyMagnitudes(result, length, result, length, squared);
+    free(result);
+    result = squared;
+    length = trimLimbs(squared, 2 * length);
+
+    if (power >> bit & 1) {
+      uint32_t* product = allocLimbs(length + base.length);
+      multiplyMagnitudes(result, length, base.limbs, base.length, product);
+      free(result);
+      result = product;
+      length = trimLimbs(product, length + base.length);
+    }
+  }
+
+  value_T value = makeInt(base.negative && (power & 1), result, length);
+  free(result);
+
+  return value;
+}
+
+value_T bigIntApply(int operator, value_T left, value_T right) {
+  uint32_t leftLimbs[2];
+  uint32_t rightLimbs[2];
+  bigView_T leftView = viewInt(left, leftLimbs);
+  bigView_T rightView = viewInt(right, rightLimbs);
+
+  switch (operator) {
+    case TOKEN_PLUS: return addInts(leftView, rightView, false); break;
+    case TOKEN_MINUS: return addInts(leftView, rightView, true); break;
+    case TOKEN_MULTIPLY: return multiplyInts(leftView, rightView); break;
+    case TOKEN_DIVIDE:
+    case TOKEN_MODULO: return divideInts(operator, leftView, rightView); break;
+    case TOKEN_POW: return powerInts(leftView, right); break;
+
+    default:
+      printf("Unknown operator with type %d\n", operator);
+      exit(1);
+  }
+}
+
+int bigIntCompare(value_T left, value_T right) {
+  uint32_t leftLimbs[2];
+  uint32_t rightLimbs[2];
+  bigView_T leftView = viewInt(left, leftLimbs);
+  bigView_T rightView = viewInt(right, rightLimbs);
+
+  // 0 is never negative, so differing signs decide it
+  if (leftView.negative != rightView.negative)
+    return leftView.negative ? -1 : 1;
+
+  int order = compareMagnitudes(leftView.limbs, leftView.length, rightView.limbs, rightView.length);
+  return leftView.negative ? -order : order;
+}
+
+char* bigIntToDecimal(value_T value, size_t* length) {
+  uint32_t wordLimbs[2];
+  bigView_T view = viewInt(value, wordLimbs);
+
+  // A limb never takes more than 10 digits, and there may be a sign
+  size_t capacity = view.length * 10 + 2;
+  char* text = malloc(capacity);
+  uint32_t* rest = allocLimbs(view.length);
+  if (!text) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+
+  memcpy(rest, view.limbs, view.length * sizeof(uint32_t));
+  size_t restSize = view.length;
+
+  // Divide by 10^9 over and over, each remainder gives the next 9 digits from the right
+  char* end = text + capacity;
+  char* start = end;
+  while (restSize > 0) {
+    uint64_t remainder = 0;
+    for (size_t i = restSize; i > 0; i--) {
+      uint64_t current = (remainder << 32) | rest[i - 1];
+      rest[i - 1] = (uint32_t) (current / 1000000000);
+      remainder = current % 1000000000;
+    }
+    restSize = trimLimbs(rest, restSize);
+
+    // Every group but the first one has all of its 9 digits, leading zeros included
+    for (int digit = 0; digit < 9 && (restSize > 0 || remainder > 0); digit++) {
+      *--start = '0' + remainder % 10;
+      remainder /= 10;
+    }
+  }
+
+  if (start == end)
+    *--start = '0';
+  if (view.negative)
+    *--start = '-';
+
+  *length = end - start;
+  memmove(text, start, *length);
+  free(rest);
+
+  return text;
+}
\ No newline at end of file
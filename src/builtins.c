@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/builtins.h"
+#include "include/output.h"
+#include "include/arena.h"
+
+native_T* natives;
+static size_t nativesSize;
+
+static uint32_t* nativeOfSymbol; // The native registered under each symbol, indexed by symbol ID, NATIVE_NONE for any other name
+static size_t nativeOfSymbolSize;
+
+static uint32_t exitNative; // exit, for the error when its code can't be an exit status
+
+void initBuiltins() {
+  if (nativesSize)
+    return;
+
+  // Native 0 stands for none
+  natives = programAlloc(sizeof(struct NATIVE_STRUCT));
+  nativesSize = 1;
+
+  registerNative("print", builtinFuncPrint, 0, NATIVE_VARIADIC, ANY, VOID);
+  registerNative("println", builtinFuncPrintln, 0, NATIVE_VARIADIC, ANY, VOID);
+  registerNative("clear", builtinFuncClear, 0, 0, ANY, VOID);
+  exitNative = registerNative("exit", builtinFuncExit, 0, 1, INT, VOID);
+  registerNative("flush", builtinFuncFlush, 0, 0, ANY, VOID);
+}
+
+uint32_t registerNative(const char* name, nativeFunc_T function, int minArgs, int maxArgs, int argType, int returnType) {
+  initBuiltins();
+
+  symbol_T symbol = internSymbol(name, strlen(name));
+
+  // Registering a name again replaces the function it calls
+  uint32_t native = findNative(symbol);
+  if (native == NATIVE_NONE) {
+    natives = arenaGrowArray(programArena, natives, nativesSize, sizeof(struct NATIVE_STRUCT));
+    native = nativesSize++;
+
+    // Make room in the lookup for the symbol, the names in between have no native
+    if (symbol >= nativeOfSymbolSize) {
+      size_t size = symbol + 1;
+      nativeOfSymbol = arenaGrow(programArena, nativeOfSymbol, nativeOfSymbolSize * sizeof(uint32_t), size * sizeof(uint32_t));
+      nativeOfSymbolSize = size;
+    }
+    nativeOfSymbol[symbol] = native;
+  }
+
+  natives[native].symbol = symbol;
+  natives[native].function = function;
+  natives[native].minArgs = minArgs;
+  natives[native].maxArgs = maxArgs;
+  natives[native].argType = argType;
+  natives[native].returnType = returnType;
+
+  return native;
+}
+
+uint32_t findNative(symbol_T symbol) {
+  return symbol < nativeOfSymbolSize ? nativeOfSymbol[symbol] : NATIVE_NONE;
+}
+
+void nativeArgumentError(uint32_t native) {
+  printf("Invalid argument passed into function `%s`\n", symbolName(natives[native].symbol));
+  exit(1);
+}
+
+// Output the arguments as arg1 arg2 arg3
+static void outputArgs(value_T* args, size_t argsSize) {
+  for (size_t i = 0; i < argsSize; i++) {
+    if (i)
+      outputChar(' ');
+    outputValue(args[i]);
+  }
+}
+
+// Built-in functions, called with their arguments already worked out and checked against what they were registered with.
+// Their results are values known before the program runs, so calling them allocates nothing
+value_T builtinFuncPrint(value_T* args, size_t argsSize) {
+  // There is no space at the end
+  outputArgs(args, argsSize);
+  outputPrinted();
+
+  return VALUE_VOID;
+}
+
+value_T builtinFuncPrintln(value_T* args, size_t argsSize) {
+  // There is a new line created at the end, so no arguments print an empty line
+  outputArgs(args, argsSize);
+  outputChar('\n');
+  outputPrinted();
+
+  return VALUE_VOID;
+}
+
+value_T builtinFuncClear(value_T* args, size_t argsSize) {
+  // Clear the terminal, after what was printed before has reached it
+  flushOutput();
+  system("clear");
+
+  return VALUE_VOID;
+}
+
+value_T builtinFuncExit(value_T* args, size_t argsSize) {
+  // Exit the program with a status code
+  // If there are no arguments, exit with code 0 silently
+  if (argsSize == 0)
+    exit(0);
+
+  // The system only keeps the low byte of the status, so a code it can't hold as it is is an error instead of another code
+  if (!valueIsSmallInt(args[0]) || valueToInt(args[0]) < 0 || valueToInt(args[0]) > 255)
+    nativeArgumentError(exitNative);
+
+  // Exit with the argument's value
+  outputBytes("Exited with code ", 17);
+  outputInt(valueToInt(args[0]));
+  outputChar('.');
+  exit(valueToInt(args[0]));
+
+  return VALUE_VOID;
+}
+
+value_T builtinFuncFlush(value_T* args, size_t argsSize) {
+  // Hand everything printed so far to the system now
+  flushOutput();
+
+  return VALUE_VOID;
+}
\ No newline at end of file
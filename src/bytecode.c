@@ -0,0 +1,142 @@
+#include <string.h>
+#include "include/bytecode.h"
+#include "include/arena.h"
+
+const char* opcodeNames[OP_COUNT] = {
+  [OP_CONST] = "CONST",
+  [OP_LOAD] = "LOAD",
+  [OP_LOAD_OUTER] = "LOAD_OUTER",
+  [OP_STORE] = "STORE",
+  [OP_POP] = "POP",
+  [OP_ADD] = "ADD",
+  [OP_SUB] = "SUB",
+  [OP_MUL] = "MUL",
+  [OP_DIV] = "DIV",
+  [OP_MOD] = "MOD",
+  [OP_POW] = "POW",
+  [OP_EQ] = "EQ",
+  [OP_NOT_EQ] = "NOT_EQ",
+  [OP_LESS] = "LESS",
+  [OP_LESS_EQ] = "LESS_EQ",
+  [OP_GREATER] = "GREATER",
+  [OP_GREATER_EQ] = "GREATER_EQ",
+  [OP_JUMP] = "JUMP",
+  [OP_JUMP_IF_FALSE] = "JUMP_IF_FALSE",
+  [OP_CALL] = "CALL",
+  [OP_TAIL_CALL] = "TAIL_CALL",
+  [OP_CALL_NATIVE] = "CALL_NATIVE",
+  [OP_RETURN] = "RETURN",
+  [OP_HALT] = "HALT",
+  [OP_ADD_INT] = "ADD_INT",
+  [OP_SUB_INT] = "SUB_INT",
+  [OP_MUL_INT] = "MUL_INT",
+  [OP_JUMP_IF_NOT] = "JUMP_IF_NOT",
+  [OP_CHECK_TYPE] = "CHECK_TYPE",
+  [OP_OUTPUT_INT] = "OUTPUT_INT",
+  [OP_OUTPUT_STRING] = "OUTPUT_STRING",
+  [OP_OUTPUT_CHAR] = "OUTPUT_CHAR",
+  [OP_OUTPUT_BOOL] = "OUTPUT_BOOL",
+  [OP_OUTPUT_VALUE] = "OUTPUT_VALUE",
+  [OP_OUTPUT_END] = "OUTPUT_END",
+  [OP_LOAD_LOAD] = "LOAD_LOAD",
+  [OP_LOAD_CONST] = "LOAD_CONST",
+  [OP_LOAD_CONST_ADD] = "LOAD_CONST_ADD",
+  [OP_LOAD_CONST_ADD_STORE] = "LOAD_CONST_ADD_STORE",
+  [OP_CALL_NATIVE_POP] = "CALL_NATIVE_POP"
+};
+
+const uint8_t opcodeOperands[OP_COUNT] = {
+  [OP_CONST] = 1,
+  [OP_LOAD] = 1,
+  [OP_LOAD_OUTER] = 2,
+  [OP_STORE] = 1,
+  [OP_JUMP] = 1,
+  [OP_JUMP_IF_FALSE] = 1,
+  [OP_CALL] = 2,
+  [OP_TAIL_CALL] = 2,
+  [OP_CALL_NATIVE] = 2,
+  [OP_JUMP_IF_NOT] = 1,
+  [OP_CHECK_TYPE] = 2,
+  [OP_OUTPUT_INT] = 2,
+  [OP_OUTPUT_STRING] = 2,
+  [OP_OUTPUT_CHAR] = 2,
+  [OP_OUTPUT_BOOL] = 2,
+  [OP_OUTPUT_VALUE] = 2,
+  [OP_OUTPUT_END] = 2,
+  [OP_LOAD_LOAD] = 2,
+  [OP_LOAD_CONST] = 2,
+  [OP_LOAD_CONST_ADD] = 2,
+  [OP_LOAD_CONST_ADD_STORE] = 3,
+  [OP_CALL_NATIVE_POP] = 2
+};
+
+chunk_T* initChunk() {
+  chunk_T* chunk = programAlloc(sizeof(struct CHUNK_STRUCT)); // Allocate memory for the chunk
+
+  // Function 0 is the program itself
+  chunkAddFunction(chunk, SYMBOL_NONE);
+
+  // Constant 0 is what a call that doesn't give anything back results in
+  chunkAddConstant(chunk, VALUE_VOID);
+
+  return chunk;
+}
+
+void chunkWriteByte(chunk_T* chunk, uint8_t byte) {
+  // Make room for one more byte, the code doubles whenever it fills up
+  if (chunk->codeSize == chunk->codeCapacity) {
+    size_t capacity = chunk->codeCapacity ? chunk->codeCapacity * 2 : 256;
+    chunk->code = arenaGrow(programArena, chunk->code, chunk->codeCapacity, capacity);
+    chunk->codeCapacity = capacity;
+  }
+
+  chunk->code[chunk->codeSize++] = byte;
+}
+
+void chunkWriteOperand(chunk_T* chunk, uint32_t operand) {
+  uint8_t bytes[sizeof(uint32_t)];
+  memcpy(bytes, &operand, sizeof(uint32_t));
+
+  for (size_t i = 0; i < sizeof(uint32_t); i++)
+    chunkWriteByte(chunk, bytes[i]);
+}
+
+uint32_t chunkAddConstant(chunk_T* chunk, value_T constant) {
+  chunk->constants = arenaGrowArray(programArena, chunk->constants, chunk->constantsSize, sizeof(value_T));
+  chunk->constants[chunk->constantsSize] = constant;
+
+  return chunk->constantsSize++;
+}
+
+uint32_t chunkAddFunction(chunk_T* chunk, symbol_T symbol) {
+  chunk->functions = arenaGrowArray(programArena, chunk->functions, chunk->functionsSize, sizeof(struct FUNCTION_STRUCT));
+  memset(&chunk->functions[chunk->functionsSize], 0, sizeof(struct FUNCTION_STRUCT));
+  chunk->functions[chunk->functionsSize].symbol = symbol;
+
+  return chunk->functionsSize++;
+}
+
+void chunkAddLoad(chunk_T* chunk, size_t offset, symbol_T symbol) {
+  chunk->loads = arenaGrowArray(programArena, chunk->loads, chunk->loadsSize, sizeof(struct LOAD_INFO_STRUCT));
+  chunk->loads[chunk->loadsSize].offset = offset;
+  chunk->loads[chunk->loadsSize].symbol = symbol;
+  chunk->loadsSize += 1;
+}
+
+symbol_T chunkGetLoad(chunk_T* chunk, size_t offset) {
+  // The loads are in the order of the code, so a binary search finds the one at the offset
+  size_t low = 0;
+  size_t high = chunk->loadsSize;
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    if (chunk->loads[middle].offset < offset)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  if (low < chunk->loadsSize && chunk->loads[low].offset == offset)
+    return chunk->loads[low].symbol;
+
+  return SYMBOL_NONE;
+}
\ No newline at end of file
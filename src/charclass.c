@@ -0,0 +1,191 @@
+#include <string.h>
+#include "include/charclass.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CHARCLASS_X86
+#endif
+
+#define S CHAR_SPACE
+#define A CHAR_ALPHA
+#define D CHAR_DIGIT
+
+const unsigned char charClasses[256] = {
+  ['\t'] = S, ['\n'] = S, ['\r'] = S, [' '] = S,
+  ['0'] = D, ['1'] = D, ['2'] = D, ['3'] = D, ['4'] = D, ['5'] = D, ['6'] = D, ['7'] = D, ['8'] = D, ['9'] = D,
+  ['A'] = A, ['B'] = A, ['C'] = A, ['D'] = A, ['E'] = A, ['F'] = A, ['G'] = A, ['H'] = A, ['I'] = A, ['J'] = A, ['K'] = A, ['L'] = A, ['M'] = A,
+  ['N'] = A, ['O'] = A, ['P'] = A, ['Q'] = A, ['R'] = A, ['S'] = A, ['T'] = A, ['U'] = A, ['V'] = A, ['W'] = A, ['X'] = A, ['Y'] = A, ['Z'] = A,
+  ['a'] = A, ['b'] = A, ['c'] = A, ['d'] = A, ['e'] = A, ['f'] = A, ['g'] = A, ['h'] = A, ['i'] = A, ['j'] = A, ['k'] = A, ['l'] = A, ['m'] = A,
+  ['n'] = A, ['o'] = A, ['p'] = A, ['q'] = A, ['r'] = A, ['s'] = A, ['t'] = A, ['u'] = A, ['v'] = A, ['w'] = A, ['x'] = A, ['y'] = A, ['z'] = A
+};
+
+#undef S
+#undef A
+#undef D
+
+// Scalar scans, one character at a time through the table
+
+static size_t scalarSkipSpaces(const char* text, size_t length) {
+  size_t i = 0;
+  while (i < length && isSpaceChar(text[i]))
+    i++;
+  return i;
+}
+
+static size_t scalarSkipIdent(const char* text, size_t length) {
+  size_t i = 0;
+  while (i < length && isIdentChar(text[i]))
+    i++;
+  return i;
+}
+
+static size_t scalarSkipDigits(const char* text, size_t length) {
+  size_t i = 0;
+  while (i < length && isDigitChar(text[i]))
+    i++;
+  return i;
+}
+
+static size_t scalarSkipString(const char* text, size_t length) {
+  size_t i = 0;
+  while (i < length && text[i] != '"' && text[i] != '\0')
+    i++;
+  return i;
+}
+
+static const charScanner_T scalarScanner = {
+  "scalar", scalarSkipSpaces, scalarSkipIdent, scalarSkipDigits, scalarSkipString
+};
+
+#ifdef CHARCLASS_X86
+
+// Every kernel builds a mask with one bit per character that is still part of the run.
+// The first zero bit is where the run ends, and the scalar scan finishes the last few characters.
+
+// A byte is in [lo, lo + span] when (byte - lo) doesn't get any smaller by clamping it to span
+#define SSE2_IN_RANGE(x, lo, span) \
+  _mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8((x), _mm_set1_epi8(lo)), _mm_set1_epi8(span)), _mm_sub_epi8((x), _mm_set1_epi8(lo)))
+
+#define AVX2_IN_RANGE(x, lo, span) \
+  _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_sub_epi8((x), _mm256_set1_epi8(lo)), _mm256_set1_epi8(span)), _mm256_sub_epi8((x), _mm256_set1_epi8(lo)))
+
+static inline __m128i sse2SpaceMask(__m128i x) {
+  return _mm_or_si128(
+    _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'))),
+    _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')))
+  );
+}
+
+static inline __m128i sse2IdentMask(__m128i x) {
+  // Setting bit 5 turns upper case letters into lower case ones without touching the digits' range check
+  __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+  return _mm_or_si128(SSE2_IN_RANGE(lower, 'a', 'z' - 'a'), SSE2_IN_RANGE(x, '0', '9' - '0'));
+}
+
+static inline __m128i sse2DigitMask(__m128i x) {
+  return SSE2_IN_RANGE(x, '0', '9' - '0');
+}
+
+static inline __m128i sse2StringMask(__m128i x) {
+  // Everything except " and the null character is part of the string
+  __m128i end = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')), _mm_cmpeq_epi8(x, _mm_setzero_si128()));
+  return _mm_xor_si128(end, _mm_set1_epi8(-1));
+}
+
+#define SSE2_SCAN(name, maskFunc, scalarFunc) \
+  static size_t name(const char* text, size_t length) { \
+    size_t i = 0; \
+    while (i + 16 <= length) { \
+      unsigned int mask = (unsigned int) _mm_movemask_epi8(maskFunc(_mm_loadu_si128((const __m128i*) (text + i)))); \
+      if (mask != 0xFFFF) \
+        return i + (size_t) __builtin_ctz(~mask); \
+      i += 16; \
+    } \
+    return i + scalarFunc(text + i, length - i); \
+  }
+
+SSE2_SCAN(sse2SkipSpaces, sse2SpaceMask, scalarSkipSpaces)
+SSE2_SCAN(sse2SkipIdent, sse2IdentMask, scalarSkipIdent)
+SSE2_SCAN(sse2SkipDigits, sse2DigitMask, scalarSkipDigits)
+SSE2_SCAN(sse2SkipString, sse2StringMask, scalarSkipString)
+
+static const charScanner_T sse2Scanner = {
+  "sse2", sse2SkipSpaces, sse2SkipIdent, sse2SkipDigits, sse2SkipString
+};
+
+__attribute__((target("avx2"))) static inline __m256i avx2SpaceMask(__m256i x) {
+  return _mm256_or_si256(
+    _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'))),
+    _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r')))
+  );
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2IdentMask(__m256i x) {
+  __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+  return _mm256_or_si256(AVX2_IN_RANGE(lower, 'a', 'z' - 'a'), AVX2_IN_RANGE(x, '0', '9' - '0'));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2DigitMask(__m256i x) {
+  return AVX2_IN_RANGE(x, '0', '9' - '0');
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2StringMask(__m256i x) {
+  __m256i end = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(x, _mm256_setzero_si256()));
+  return _mm256_xor_si256(end, _mm256_set1_epi8(-1));
+}
+
+#define AVX2_SCAN(name, maskFunc, sse2Func) \
+  __attribute__((target("avx2"))) static size_t name(const char* text, size_t length) { \
+    size_t i = 0; \
+    while (i + 32 <= length) { \
+      unsigned int mask = (unsigned int) _mm256_movemask_epi8(maskFunc(_mm256_loadu_si256((const __m256i*) (text + i)))); \
+      if (mask != 0xFFFFFFFF) \
+        return i + (size_t) __builtin_ctz(~mask); \
+      i += 32; \
+    } \
+    return i + sse2Func(text + i, length - i); \
+  }
+
+AVX2_SCAN(avx2SkipSpaces, avx2SpaceMask, sse2SkipSpaces)
+AVX2_SCAN(avx2SkipIdent, avx2IdentMask, sse2SkipIdent)
+AVX2_SCAN(avx2SkipDigits, avx2DigitMask, sse2SkipDigits)
+AVX2_SCAN(avx2SkipString, avx2StringMask, sse2SkipString)
+
+static const charScanner_T avx2Scanner = {
+  "avx2", avx2SkipSpaces, avx2SkipIdent, avx2SkipDigits, avx2SkipString
+};
+
+#endif
+
+static const charScanner_T* currentScanner;
+
+const charScanner_T* getCharScanner() {
+  // Pick the widest scanner the CPU supports the first time one is needed
+  if (!currentScanner) {
+    currentScanner = &scalarScanner;
+
+#ifdef CHARCLASS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      currentScanner = &avx2Scanner;
+    else
+      currentScanner = &sse2Scanner; // Every x86-64 CPU has SSE2
+#endif
+  }
+
+  return currentScanner;
+}
+
+const charScanner_T* useCharScanner(const char* name) {
+  // Force a specific scanner, as long as the CPU can run it
+  currentScanner = &scalarScanner;
+
+#ifdef CHARCLASS_X86
+  if (strcmp(name, "sse2") == 0)
+    currentScanner = &sse2Scanner;
+  else if (strcmp(name, "avx2") == 0 && (__builtin_cpu_init(), __builtin_cpu_supports("avx2")))
+    currentScanner = &avx2Scanner;
+#endif
+
+  return currentScanner;
+}
\ No newline at end of file
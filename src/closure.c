@@ -0,0 +1,753 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "include/closure.h"
+#include "include/runtime.h"
+#include "include/typecheck.h"
+#include "include/scope.h"
+#include "include/arena.h"
+
+#define CLOSURE_STACK_RESERVE (64 * 1024) // Bytes of the C stack kept for the built-in functions and the collector
+
+// Not a value any program has. A ret whose call takes over the running frame gives it back, once the call's arguments are ready
+#define CLOSURE_TAIL_CALL ((value_T) 0x22)
+
+typedef struct CLOSURE_STRUCT closure_T;
+typedef struct CLOSURE_FRAME_STRUCT closureFrame_T;
+
+typedef value_T (*closureRun_T)(const closure_T* self, closureFrame_T* frame);
+
+typedef void (*closureOutput_T)(value_T value);
+
+// A function of the program. Its body is turned into closures once the closures of the program are done
+typedef struct CLOSURE_FUNCTION_STRUCT {
+  closure_T* body;
+  uint32_t argsSize;
+  uint32_t slotsSize; // Values of its frame, arguments first
+  bool escapes; // Whether a ret inside an expression can leave it, which jumps out of the closures running it
+} closureFunction_T;
+
+// One run of a function, or of the program, kept on the C stack of the closure that called it
+struct CLOSURE_FRAME_STRUCT {
+  value_T* slots; // Its values, on the value stack
+  closureFrame_T* parent; // The frame of the scope the function was defined in
+  jmp_buf* escape; // Where a ret inside an expression jumps to, in a function that has one
+};
+
+struct CLOSURE_STRUCT {
+  closureRun_T run;
+
+  union {
+    // For literals
+    value_T constant;
+
+    // For variables
+    struct {
+      uint32_t varDepth; // How many frames out the variable lives
+      uint32_t varSlot;
+      symbol_T varSymbol;
+    };
+
+    // For variable definitions
+    struct {
+      closure_T* defValue;
+      uint32_t defSlot;
+      int defType; // The declared type, when the value has to be checked against it
+      symbol_T defSymbol;
+    };
+
+    // For operators
+    struct {
+      closure_T* left;
+      closure_T* right;
+      value_T rightConstant; // The right operand, when it is a literal
+      int operator;
+    };
+
+    // For calls
+    struct {
+      closure_T** args;
+      uint32_t argsSize;
+      uint32_t callDepth; // How many frames out the function was defined
+      union {
+        closureFunction_T* function;
+        uint32_t native;
+        closureOutput_T* outputs; // How each value of a print is written
+      };
+      bool newline; // Whether a print is println
+    };
+
+    // For compound statements
+    struct {
+      closure_T** statements; // Definitions first, the way they are hoisted
+      uint32_t statementsSize;
+    };
+
+    // For if statements
+    struct {
+      closure_T* condition;
+      closure_T* body;
+      closure_T* otherwise; // Null when there is no else
+    };
+
+    // For rets, expressions used as statements and statements used as values
+    closure_T* value;
+  };
+};
+
+static astFunctionTable_T functionNumbers; // Which of the functions below each definition became, counting from 1
+static closureFunction_T** functions; // Every function that is called, in the order of their first calls like pendingFunctions
+static size_t functionsSize;
+
+static astIndex_T* pendingFunctions; // Definitions of functions that are called but whose bodies aren't closures yet
+static size_t pendingFunctionsSize;
+
+static closureFunction_T* currentFunction; // The function whose body is being turned into closures, null for the program
+static uint32_t expressionDepth; // Statements being turned into closures that are used as values
+
+static value_T* valueStack;
+static value_T* valueTop; // Where the next frame or value goes
+static value_T* valueLimit;
+static char* nativeBase; // Where the program's C stack starts, it grows down from there
+static char* nativeLimit; // The lowest a closure's C frame may be
+static size_t stackBudget; // Bytes the value stack and the C stack may use together
+
+// What a ret inside an expression gives back, on its way out of the closures running it
+static value_T escapeValue;
+
+// The call a ret hands its frame over to, with its arguments on top of the value stack
+static closureFunction_T* tailFunction;
+static closureFrame_T* tailParent;
+static value_T* tailArgs;
+
+static void stackOverflow() {
+  printf("Stack overflow.\n");
+  exit(1);
+}
+
+// Reserve memory the system only hands out once it is touched
+static void* reserve(size_t size) {
+  void* memory = mmap((void*) 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+
+  return memory;
+}
+
+// Every value the program works with is in a frame, or on the value stack above it while more are worked out
+static void collect() {
+  gcRoots_T roots = { valueStack, (size_t) (valueTop - valueStack) };
+  collectGarbage(&roots, 1);
+}
+
+static inline void pushValue(value_T value) {
+  if (valueTop == valueLimit)
+    stackOverflow();
+
+  *valueTop++ = value;
+}
+
+static inline closureFrame_T* outerFrame(closureFrame_T* frame, uint32_t depth) {
+  while (depth--)
+    frame = frame->parent;
+
+  return frame;
+}
+
+static void loadError(const closure_T* self) {
+  printf("Variable `%s` is used before it has a value.\n", symbolName(self->varSymbol));
+  exit(1);
+}
+
+// Run a function's body, and the bodies of the calls that take over its frame, until one gives back a value
+static inline __attribute__((always_inline)) value_T runFunction(closureFunction_T* function, closureFrame_T* frame) {
+  value_T* slots = frame->slots;
+
+  for (;;) {
+    if (function->slotsSize > (size_t) (valueLimit - slots))
+      stackOverflow();
+
+    for (size_t i = function->argsSize; i < function->slotsSize; i++)
+      slots[i] = VALUE_UNSET;
+    valueTop = slots + function->slotsSize;
+
+    // Calls are where the heap is collected, once the arguments are in the frame
+    if (gcPending)
+      collect();
+
+    value_T result = function->body->run(function->body, frame);
+    if (result != CLOSURE_TAIL_CALL) {
+      valueTop = slots;
+      return result == VALUE_UNSET ? VALUE_VOID : result;
+    }
+
+    // The callee's arguments move down to where the frame starts
+    memmove(slots, tailArgs, tailFunction->argsSize * sizeof(value_T));
+    function = tailFunction;
+    frame->parent = tailParent;
+  }
+}
+
+// A function with a ret inside an expression is run where the ret can jump back to with its value.
+// It is kept apart, so the C frame of every other call doesn't carry a jmp_buf
+static __attribute__((noinline)) value_T enterEscaping(closureFunction_T* function, closureFrame_T* frame) {
+  jmp_buf escape;
+  frame->escape = &escape;
+  if (setjmp(escape)) {
+    valueTop = frame->slots;
+    return escapeValue;
+  }
+
+  return runFunction(function, frame);
+}
+
+static value_T runConstant(const closure_T* self, closureFrame_T* frame) {
+  return self->constant;
+}
+
+// An argument always has a value
+static value_T runArgument(const closure_T* self, closureFrame_T* frame) {
+  return frame->slots[self->varSlot];
+}
+
+static value_T runLocal(const closure_T* self, closureFrame_T* frame) {
+  value_T value = frame->slots[self->varSlot];
+  if (value == VALUE_UNSET)
+    loadError(self);
+
+  return value;
+}
+
+static value_T runOuter(const closure_T* self, closureFrame_T* frame) {
+  value_T value = outerFrame(frame, self->varDepth)->slots[self->varSlot];
+  if (value == VALUE_UNSET)
+    loadError(self);
+
+  return value;
+}
+
+static inline value_T applyBinop(int operator, value_T left, value_T right) {
+  switch (operator) {
+    case TOKEN_PLUS: return runtimeAdd(left, right); break;
+    case TOKEN_MINUS: return runtimeSubtract(left, right); break;
+    case TOKEN_MULTIPLY: return runtimeMultiply(left, right); break;
+    default: return isComparison(operator) ? runtimeCompare(operator, left, right) : applyOperator(operator, left, right); break;
+  }
+}
+
+static value_T runBinop(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  value_T right = self->right->run(self->right, frame);
+  return applyBinop(self->operator, left, right);
+}
+
+// The right operand calls a function, which may collect, so the left one waits on the value stack
+static value_T runBinopKept(const closure_T* self, closureFrame_T* frame) {
+  pushValue(self->left->run(self->left, frame));
+  value_T right = self->right->run(self->right, frame);
+  value_T left = *--valueTop;
+  return applyBinop(self->operator, left, right);
+}
+
+static value_T runAdd(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeAdd(left, self->right->run(self->right, frame));
+}
+
+static value_T runSubtract(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeSubtract(left, self->right->run(self->right, frame));
+}
+
+static value_T runMultiply(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeMultiply(left, self->right->run(self->right, frame));
+}
+
+// Ints the type checker knows of skip the dispatch of the operator when they don't fit in the word
+static value_T runAddInts(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeAddInts(left, self->right->run(self->right, frame));
+}
+
+static value_T runSubtractInts(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeSubtractInts(left, self->right->run(self->right, frame));
+}
+
+static value_T runMultiplyInts(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeMultiplyInts(left, self->right->run(self->right, frame));
+}
+
+static value_T runCompare(const closure_T* self, closureFrame_T* frame) {
+  value_T left = self->left->run(self->left, frame);
+  return runtimeCompare(self->operator, left, self->right->run(self->right, frame));
+}
+
+// A literal on the right, like the 1 of n - 1, is kept in the closure
+static value_T runAddConstant(const closure_T* self, closureFrame_T* frame) {
+  return runtimeAdd(self->left->run(self->left, frame), self->rightConstant);
+}
+
+static value_T runSubtractConstant(const closure_T* self, closureFrame_T* frame) {
+  return runtimeSubtract(self->left->run(self->left, frame), self->rightConstant);
+}
+
+static value_T runCompareConstant(const closure_T* self, closureFrame_T* frame) {
+  return runtimeCompare(self->operator, self->left->run(self->left, frame), self->rightConstant);
+}
+
+// Work out a call's arguments in order, on top of the value stack, where the collector finds them and the callee's frame starts
+static inline value_T* pushArgs(const closure_T* self, closureFrame_T* frame) {
+  value_T* args = valueTop;
+  for (uint32_t i = 0; i < self->argsSize; i++)
+    pushValue(self->args[i]->run(self->args[i], frame));
+
+  return args;
+}
+
+// Run a function in a new frame, which starts with its arguments
+static value_T runCall(const closure_T* self, closureFrame_T* frame) {
+  closureFrame_T callee = { pushArgs(self, frame), outerFrame(frame, self->callDepth), (void*) 0 };
+  // The frames are on the C stack and their values on the value stack, and both are charged to the budget
+  char* native = __builtin_frame_address(0);
+  if ((size_t) (nativeBase - native) + (size_t) ((char*) valueTop - (char*) valueStack) > stackBudget || native < nativeLimit)
+    stackOverflow();
+
+  if (self->function->escapes)
+    return enterEscaping(self->function, &callee);
+
+  return runFunction(self->function, &callee);
+}
+
+// A ret that gives back a call hands it the running frame, unless the callee has to be able to jump back into its own
+static value_T runTailCall(const closure_T* self, closureFrame_T* frame) {
+  if (self->function->escapes)
+    return runCall(self, frame);
+
+  tailArgs = pushArgs(self, frame);
+  tailFunction = self->function;
+  tailParent = outerFrame(frame, self->callDepth);
+  return CLOSURE_TAIL_CALL;
+}
+
+static value_T runNative(const closure_T* self, closureFrame_T* frame) {
+  value_T* args = pushArgs(self, frame);
+  valueTop = args;
+  return callNative(self->native, args, self->argsSize);
+}
+
+static void outputCharValue(value_T value) {
+  outputChar(valueToChar(value));
+}
+
+// print and println, with each value written the way its known type is. Everything is worked out before anything is printed
+static value_T runPrint(const closure_T* self, closureFrame_T* frame) {
+  value_T* args = pushArgs(self, frame);
+  valueTop = args;
+
+  for (uint32_t i = 0; i < self->argsSize; i++) {
+    if (i)
+      outputChar(' ');
+    self->outputs[i](args[i]);
+  }
+  if (self->newline)
+    outputChar('\n');
+  outputPrinted();
+
+  return VALUE_VOID;
+}
+
+// Calls whose value isn't used, which need no closure of their own to drop it
+static value_T runCallStatement(const closure_T* self, closureFrame_T* frame) {
+  runCall(self, frame);
+  return VALUE_UNSET;
+}
+
+static value_T runNativeStatement(const closure_T* self, closureFrame_T* frame) {
+  runNative(self, frame);
+  return VALUE_UNSET;
+}
+
+static value_T runPrintStatement(const closure_T* self, closureFrame_T* frame) {
+  runPrint(self, frame);
+  return VALUE_UNSET;
+}
+
+// A statement that does nothing, or gives back nothing as a value
+static value_T runNothing(const closure_T* self, closureFrame_T* frame) {
+  return VALUE_UNSET;
+}
+
+// An expression whose value isn't used
+static value_T runExprStatement(const closure_T* self, closureFrame_T* frame) {
+  self->value->run(self->value, frame);
+  return VALUE_UNSET;
+}
+
+// A statement used as a value results in nothing, unless a ret in it leaves the function
+static value_T runStatementValue(const closure_T* self, closureFrame_T* frame) {
+  value_T result = self->value->run(self->value, frame);
+  if (result != VALUE_UNSET) {
+    escapeValue = result;
+    longjmp(*frame->escape, 1);
+  }
+
+  return VALUE_VOID;
+}
+
+static value_T runCompound(const closure_T* self, closureFrame_T* frame) {
+  for (uint32_t i = 0; i < self->statementsSize; i++) {
+    value_T result = self->statements[i]->run(self->statements[i], frame);
+    if (result != VALUE_UNSET)
+      return result;
+  }
+
+  return VALUE_UNSET;
+}
+
+static value_T runVarDef(const closure_T* self, closureFrame_T* frame) {
+  frame->slots[self->defSlot] = self->defValue->run(self->defValue, frame);
+  return VALUE_UNSET;
+}
+
+// A value the type checker couldn't tell the type of is checked once, before the variable holds it
+static value_T runVarDefChecked(const closure_T* self, closureFrame_T* frame) {
+  value_T value = self->defValue->run(self->defValue, frame);
+  if (valueType(value) != self->defType)
+    declaredTypeError(symbolName(self->defSymbol), self->defType, valueType(value));
+
+  frame->slots[self->defSlot] = value;
+  return VALUE_UNSET;
+}
+
+static value_T runIf(const closure_T* self, closureFrame_T* frame) {
+  value_T condition = self->condition->run(self->condition, frame);
+  if (condition != VALUE_TRUE && condition != VALUE_FALSE) {
+    printf("Error: The condition of an if has to be a bool.\n");
+    exit(1);
+  }
+
+  const closure_T* branch = condition == VALUE_TRUE ? self->body : self->otherwise;
+  return branch ? branch->run(branch, frame) : VALUE_UNSET;
+}
+
+// A condition known to be a bool doesn't need to be checked
+static value_T runIfBool(const closure_T* self, closureFrame_T* frame) {
+  const closure_T* branch = self->condition->run(self->condition, frame) == VALUE_TRUE ? self->body : self->otherwise;
+  return branch ? branch->run(branch, frame) : VALUE_UNSET;
+}
+
+static value_T runReturnVoid(const closure_T* self, closureFrame_T* frame) {
+  return VALUE_VOID;
+}
+
+static closure_T* initClosure(closureRun_T run) {
+  closure_T* closure = programAlloc(sizeof(struct CLOSURE_STRUCT));
+  closure->run = run;
+
+  return closure;
+}
+
+// The closures of a definition. The first call to a function makes them, and its body is turned into closures after the program
+static closureFunction_T* getFunction(AST_T* funcDef) {
+  uint32_t* entry = astFunctionEntry(&functionNumbers, funcDef->index);
+  if (*entry)
+    return functions[*entry - 1];
+
+  closureFunction_T* function = programAlloc(sizeof(struct CLOSURE_FUNCTION_STRUCT));
+  function->argsSize = funcDef->funcDefArgsSize;
+  function->slotsSize = astGet(funcDef->funcDefBody)->scope->slotsSize;
+
+  functions = arenaGrowArray(programArena, functions, functionsSize, sizeof(closureFunction_T*));
+  functions[functionsSize++] = function;
+  *entry = functionsSize;
+
+  pendingFunctions = arenaGrowArray(programArena, pendingFunctions, pendingFunctionsSize, sizeof(astIndex_T));
+  pendingFunctions[pendingFunctionsSize++] = funcDef->index;
+
+  return function;
+}
+
+static closure_T* compileStatement(AST_T* node);
+
+static closure_T* compileExpr(AST_T* node, bool* calls);
+
+// A call's arguments, and whether working them out calls a function of the program
+static closure_T** compileArgs(AST_T* node, bool* calls) {
+  closure_T** args = programAlloc(node->funcCallArgsSize * sizeof(closure_T*));
+  for (size_t i = 0; i < node->funcCallArgsSize; i++)
+    args[i] = compileExpr(astGet(astGetList(node->funcCallArgs)[i]), calls);
+
+  return args;
+}
+
+static closureOutput_T getOutput(int type) {
+  switch (type) {
+    case INT: return outputIntValue; break;
+    case STRING: return outputStringValue; break;
+    case CHAR: return outputCharValue; break;
+    case BOOL: return outputBoolValue; break;
+    default: return outputValue; break;
+  }
+}
+
+static closure_T* compileFuncCall(AST_T* node, bool* calls) {
+  closure_T* closure = initClosure(runNative);
+  closure->args = compileArgs(node, calls);
+  closure->argsSize = node->funcCallArgsSize;
+
+  if (node->isNativeCall && nativeIsPrint(node->funcCallNative)) {
+    closure->run = runPrint;
+    closure->outputs = programAlloc(node->funcCallArgsSize * sizeof(closureOutput_T));
+    for (size_t i = 0; i < node->funcCallArgsSize; i++)
+      closure->outputs[i] = getOutput(astGet(astGetList(node->funcCallArgs)[i])->valueType);
+    closure->newline = natives[node->funcCallNative].function == builtinFuncPrintln;
+  }
+  else if (node->isNativeCall)
+    closure->native = node->funcCallNative;
+  else {
+    AST_T* funcDef = astGet(node->funcCallDef);
+    closure->run = runCall;
+    closure->function = getFunction(funcDef);
+    closure->callDepth = node->scope->depth - funcDef->scope->depth;
+    *calls = true;
+  }
+
+  return closure;
+}
+
+// The closure of an operator, with the fast path its operator and operands allow
+static closure_T* compileBinop(AST_T* node, bool* calls) {
+  closure_T* closure = initClosure(runBinop);
+  int operator = node->binopOperator;
+  bool rightCalls = false;
+
+  closure->operator = operator;
+  closure->left = compileExpr(astGet(node->binopLeft), calls);
+  closure->right = compileExpr(astGet(node->binopRight), &rightCalls);
+
+  // A literal is never collected and an argument stays in its frame, anything else has to be kept while the right operand calls
+  bool leftKept = closure->left->run == runConstant || closure->left->run == runArgument;
+  *calls |= rightCalls;
+
+  if (rightCalls && !leftKept)
+    closure->run = runBinopKept;
+  else if (closure->right->run == runConstant && (operator == TOKEN_PLUS || operator == TOKEN_MINUS || isComparison(operator))) {
+    closure->rightConstant = closure->right->constant;
+    closure->run = operator == TOKEN_PLUS ? runAddConstant : operator == TOKEN_MINUS ? runSubtractConstant : runCompareConstant;
+  }
+  else if (typeIsIntArithmetic(node))
+    closure->run = operator == TOKEN_PLUS ? runAddInts : operator == TOKEN_MINUS ? runSubtractInts : runMultiplyInts;
+  else if (operator == TOKEN_PLUS || operator == TOKEN_MINUS || operator == TOKEN_MULTIPLY)
+    closure->run = operator == TOKEN_PLUS ? runAdd : operator == TOKEN_MINUS ? runSubtract : runMultiply;
+  else if (isComparison(operator))
+    closure->run = runCompare;
+
+  return closure;
+}
+
+// Turn an expression into a closure, and tell whether running it can call a function of the program, which may collect
+static closure_T* compileExpr(AST_T* node, bool* calls) {
+  // Expressions can be very deep
+  if ((char*) __builtin_frame_address(0) < nativeLimit)
+    stackOverflow();
+
+  switch (node->type) {
+    case INT:
+    case STRING:
+    case CHAR:
+    case BOOL: {
+      // A literal's value is made once, and never collected
+      closure_T* closure = initClosure(runConstant);
+      closure->constant = valueFromLiteral(node);
+      pinValue(closure->constant);
+      return closure;
+      break;
+    }
+
+    case AST_VARIABLE: {
+      closure_T* closure = initClosure(runOuter);
+      closure->varDepth = node->varDepth;
+      closure->varSlot = node->varSlot;
+      closure->varSymbol = node->varSymbol;
+
+      if (node->varDepth == 0)
+        closure->run = astGet(node->varDef)->type == AST_VARIABLE_DEFINITION ? runLocal : runArgument;
+      return closure;
+      break;
+    }
+
+    case AST_FUNCTION_CALL: return compileFuncCall(node, calls); break;
+    case AST_BINOP: return compileBinop(node, calls); break;
+
+    // Functions are bound to their calls by the resolver, so a definition used as a value is nothing
+    case AST_FUNCTION_DEFINITION:
+    case AST_NOOP: {
+      closure_T* closure = initClosure(runConstant);
+      closure->constant = VALUE_VOID;
+      return closure;
+      break;
+    }
+
+    default: {
+      // Anything else runs as a statement, which may call anything
+      expressionDepth += 1;
+      closure_T* closure = initClosure(runStatementValue);
+      closure->value = compileStatement(node);
+      expressionDepth -= 1;
+
+      *calls = true;
+      return closure;
+      break;
+    }
+  }
+}
+
+static closure_T* compileReturn(AST_T* node) {
+  if (!node->returnVal)
+    return initClosure(runReturnVoid);
+
+  // A ret inside an expression has to jump out of the closures running it
+  if (expressionDepth > 0)
+    currentFunction->escapes = true;
+
+  bool calls = false;
+  AST_T* value = astGet(node->returnVal);
+  closure_T* closure = compileExpr(value, &calls);
+
+  // A call whose result is given straight back takes over the running frame, unless the callee is defined in it
+  if (closure->run == runCall && value->isTailCall && closure->callDepth > 0 && expressionDepth == 0) {
+    closure->run = runTailCall;
+    return closure;
+  }
+
+  // No value is ever VALUE_UNSET, so the value's closure gives it back from the statement itself
+  return closure;
+}
+
+static closure_T* compileStatement(AST_T* node) {
+  switch (node->type) {
+    case AST_COMPOUND: {
+      closure_T* closure = initClosure(runCompound);
+      closure->statements = programAlloc(node->compoundSize * sizeof(closure_T*));
+
+      // Definitions run first, in the order they are written, then everything else. Functions and noops do nothing
+      for (int definitions = 1; definitions >= 0; definitions--) {
+        for (size_t i = 0; i < node->compoundSize; i++) {
+          AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+          if ((child->type == AST_VARIABLE_DEFINITION) != definitions || child->type == AST_FUNCTION_DEFINITION || child->type == AST_NOOP)
+            continue;
+
+          closure->statements[closure->statementsSize++] = compileStatement(child);
+        }
+      }
+
+      // A block of one statement is that statement
+      if (closure->statementsSize == 1)
+        return closure->statements[0];
+      return closure;
+      break;
+    }
+
+    case AST_VARIABLE_DEFINITION: {
+      bool calls = false;
+      closure_T* closure = initClosure(typeNeedsCheck(node) ? runVarDefChecked : runVarDef);
+      closure->defValue = compileExpr(astGet(node->varDefVal), &calls);
+      closure->defSlot = node->varDefSlot;
+      closure->defType = node->varType;
+      closure->defSymbol = node->varDefSymbol;
+      return closure;
+      break;
+    }
+
+    case AST_IF: {
+      bool calls = false;
+      AST_T* condition = astGet(node->ifCondition);
+      closure_T* closure = initClosure(condition->valueType == BOOL ? runIfBool : runIf);
+      closure->condition = compileExpr(condition, &calls);
+      closure->body = compileStatement(astGet(node->ifBody));
+      closure->otherwise = node->ifElse ? compileStatement(astGet(node->ifElse)) : (void*) 0;
+      return closure;
+      break;
+    }
+
+    case AST_STATEMENT_RETURN: return compileReturn(node); break;
+
+    case AST_FUNCTION_DEFINITION:
+    case AST_NOOP: return initClosure(runNothing); break;
+
+    default: {
+      // Anything else is an expression whose value isn't used
+      bool calls = false;
+      closure_T* value = compileExpr(node, &calls);
+
+      if (value->run == runCall)
+        value->run = runCallStatement;
+      else if (value->run == runNative)
+        value->run = runNativeStatement;
+      else if (value->run == runPrint)
+        value->run = runPrintStatement;
+      else {
+        closure_T* closure = initClosure(runExprStatement);
+        closure->value = value;
+        return closure;
+      }
+
+      return value;
+      break;
+    }
+  }
+}
+
+static void* runThread(void* root) {
+  AST_T* program = root;
+
+  // The program is turned into closures first, then every function it calls, and every function those call
+  closure_T* closure = compileStatement(program);
+  for (size_t i = 0; i < pendingFunctionsSize; i++) {
+    AST_T* funcDef = astGet(pendingFunctions[i]);
+    currentFunction = functions[i];
+    currentFunction->body = compileStatement(astGet(funcDef->funcDefBody));
+  }
+
+  // The program gets the first frame
+  closureFrame_T frame = { valueStack, (void*) 0, (void*) 0 };
+  for (size_t i = 0; i < program->scope->slotsSize; i++)
+    pushValue(VALUE_UNSET);
+
+  closure->run(closure, &frame);
+  return (void*) 0;
+}
+
+void runClosures(AST_T* root, size_t budget) {
+  valueStack = reserve(budget);
+  valueTop = valueStack;
+  valueLimit = valueStack + budget / sizeof(value_T);
+  stackBudget = budget;
+
+  // The program runs on a thread whose C stack is the size of the budget, with room for the built-in functions below it
+  size_t nativeSize = budget + CLOSURE_STACK_RESERVE;
+  char* nativeStack = reserve(nativeSize);
+  nativeLimit = nativeStack + CLOSURE_STACK_RESERVE;
+  nativeBase = nativeStack + nativeSize;
+
+  pthread_attr_t attributes;
+  pthread_t thread;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstack(&attributes, nativeStack, nativeSize);
+  if (pthread_create(&thread, &attributes, runThread, root) != 0) {
+    printf("The program's thread couldn't be started.\n");
+    exit(1);
+  }
+  pthread_join(thread, (void*) 0);
+
+  munmap(nativeStack, nativeSize);
+  munmap(valueStack, budget);
+}
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <string.h>
+#include "include/compiler.h"
+#include "include/typecheck.h"
+#include "include/builtins.h"
+#include "include/scope.h"
+#include "include/token.h"
+#include "include/arena.h"
+
+static chunk_T* chunk; // The chunk being compiled
+
+static uint32_t stackSize; // How many values the code compiled so far leaves on top of the frame
+static uint32_t maxStack; // The most values the function being compiled ever has on top of its frame
+
+static astWorkStack_T workStack; // Expressions still to be walked, see AST.h
+
+static astFunctionTable_T compiledFunctions; // The function each definition is compiled into
+
+static astIndex_T* pendingFunctions; // Definitions of functions that are called but not compiled yet, by function
+static size_t pendingFunctionsSize;
+
+static void compileStatement(AST_T* node);
+
+static void compileExpr(AST_T* node);
+
+// Keep track of how many values the code leaves on the stack
+static void changeStack(int change) {
+  stackSize += change;
+  if (stackSize > maxStack)
+    maxStack = stackSize;
+}
+
+static void emit(opcode_T op) {
+  chunkWriteByte(chunk, op);
+}
+
+static void emitWithOperand(opcode_T op, uint32_t operand) {
+  chunkWriteByte(chunk, op);
+  chunkWriteOperand(chunk, operand);
+}
+
+// Emit a jump whose target isn't known yet, and return where its operand is so it can be filled in
+static size_t emitJump(opcode_T op) {
+  emitWithOperand(op, 0);
+  return chunk->codeSize - sizeof(uint32_t);
+}
+
+// Make a jump go to the code that comes next
+static void patchJump(size_t operand) {
+  uint32_t target = chunk->codeSize;
+  memcpy(chunk->code + operand, &target, sizeof(uint32_t));
+}
+
+// The function a definition is compiled into. The first call to a function gives it one, and its body is compiled after the program
+static uint32_t getFunction(AST_T* funcDef) {
+  // Function 0 is the program, so a definition's function is never 0
+  uint32_t* entry = astFunctionEntry(&compiledFunctions, funcDef->index);
+  if (*entry)
+    return *entry;
+
+  *entry = chunkAddFunction(chunk, funcDef->funcDefSymbol);
+
+  pendingFunctions = arenaGrowArray(programArena, pendingFunctions, pendingFunctionsSize, sizeof(astIndex_T));
+  pendingFunctions[pendingFunctionsSize++] = funcDef->index;
+
+  return *entry;
+}
+
+// The instruction that prints a value of a type without looking at it
+static opcode_T getOutputOp(int type) {
+  switch (type) {
+    case INT: return OP_OUTPUT_INT; break;
+    case STRING: return OP_OUTPUT_STRING; break;
+    case CHAR: return OP_OUTPUT_CHAR; break;
+    case BOOL: return OP_OUTPUT_BOOL; break;
+    default: return OP_OUTPUT_VALUE; break;
+  }
+}
+
+// print and println with their arguments on the stack, each printed by the instruction for its type
+static void compilePrint(AST_T* node) {
+  uint32_t argsSize = node->funcCallArgsSize;
+  for (uint32_t i = 0; i < argsSize; i++) {
+    emitWithOperand(getOutputOp(astGet(astGetList(node->funcCallArgs)[i])->valueType), argsSize - 1 - i);
+    chunkWriteOperand(chunk, i > 0);
+  }
+
+  emitWithOperand(OP_OUTPUT_END, argsSize);
+  chunkWriteOperand(chunk, natives[node->funcCallNative].function == builtinFuncPrintln);
+}
+
+static void compileFuncCall(AST_T* node) {
+  // The arguments go on the stack in order, so they become the first values of the callee's frame
+  for (size_t i = 0; i < node->funcCallArgsSize; i++)
+    compileExpr(astGet(astGetList(node->funcCallArgs)[i]));
+
+  // The arguments are replaced by the result
+  changeStack(1 - (int) node->funcCallArgsSize);
+
+  if (node->isNativeCall && nativeIsPrint(node->funcCallNative)) {
+    compilePrint(node);
+    return;
+  }
+
+  // Built-in functions are called through the registry
+  if (node->isNativeCall) {
+    emitWithOperand(OP_CALL_NATIVE, node->funcCallNative);
+    chunkWriteOperand(chunk, node->funcCallArgsSize);
+    return;
+  }
+
+  // The callee's frame is nested in the frame it was defined in, which is as many frames out as the call is nested deeper
+  AST_T* funcDef = astGet(node->funcCallDef);
+  emitWithOperand(OP_CALL, getFunction(funcDef));
+  chunkWriteOperand(chunk, node->scope->depth - funcDef->scope->depth);
+}
+
+// Compile a value that isn't an operator
+static void compileOperand(AST_T* node) {
+  switch (node->type) {
+    case INT:
+    case STRING:
+    case CHAR:
+    case BOOL:
+      emitWithOperand(OP_CONST, chunkAddConstant(chunk, valueFromLiteral(node)));
+      changeStack(1);
+      break;
+
+    case AST_VARIABLE:
+      // Remember which variable is loaded, so an error can name it
+      chunkAddLoad(chunk, chunk->codeSize, node->varSymbol);
+
+      if (node->varDepth == 0)
+        emitWithOperand(OP_LOAD, node->varSlot);
+      else {
+        emitWithOperand(OP_LOAD_OUTER, node->varDepth);
+        chunkWriteOperand(chunk, node->varSlot);
+      }
+      changeStack(1);
+      break;
+
+    case AST_FUNCTION_CALL: compileFuncCall(node); break;
+
+    default:
+      // Anything else runs as a statement and results in nothing
+      compileStatement(node);
+      emitWithOperand(OP_CONST, 0);
+      changeStack(1);
+      break;
+  }
+}
+
+static opcode_T getOperatorOp(int operator) {
+  switch (operator) {
+    case TOKEN_PLUS: return OP_ADD; break;
+    case TOKEN_MINUS: return OP_SUB; break;
+    case TOKEN_MULTIPLY: return OP_MUL; break;
+    case TOKEN_DIVIDE: return OP_DIV; break;
+    case TOKEN_MODULO: return OP_MOD; break;
+    case TOKEN_POW: return OP_POW; break;
+    case TOKEN_EQ: return OP_EQ; break;
+    case TOKEN_NOT_EQ: return OP_NOT_EQ; break;
+    case TOKEN_LESS: return OP_LESS; break;
+    case TOKEN_LESS_EQ: return OP_LESS_EQ; break;
+    case TOKEN_GREATER: return OP_GREATER; break;
+    case TOKEN_GREATER_EQ: return OP_GREATER_EQ; break;
+    default:
+      printf("Unknown operator with type %d\n", operator);
+      exit(1);
+  }
+}
+
+static void compileExpr(AST_T* node) {
+  // Compile the expression in post order with an explicit work stack, so operands come before
+  // the operators using them and long expressions don't recurse
+  size_t workBase = workStack.size;
+
+  astPushWork(&workStack, node->index, false);
+
+  while (workStack.size > workBase) {
+    astWork_T work = workStack.items[--workStack.size];
+    AST_T* current = astGet(work.index);
+
+    if (current->type != AST_BINOP) {
+      compileOperand(current);
+      continue;
+    }
+
+    // The first time an operator is seen, its operands have to be compiled first, left before right
+    if (!work.expanded) {
+      astPushWork(&workStack, work.index, true);
+      astPushWork(&workStack, current->binopRight, false);
+      astPushWork(&workStack, current->binopLeft, false);
+      continue;
+    }
+
+    // Both operands are on the stack, the operator replaces them with the result. Ints skip the check of what the operands are
+    opcode_T op = getOperatorOp(current->binopOperator);
+    emit(typeIsIntArithmetic(current) ? OP_ADD_INT + (op - OP_ADD) : op);
+    changeStack(-1);
+  }
+}
+
+static void compileReturn(AST_T* node) {
+  AST_T* value = node->returnVal ? astGet(node->returnVal) : (void*) 0;
+
+  // A call whose result is given straight back takes over the running frame, unless the callee is defined in it
+  if (value && value->isTailCall && !value->isNativeCall) {
+    AST_T* funcDef = astGet(value->funcCallDef);
+    uint32_t depth = value->scope->depth - funcDef->scope->depth;
+
+    if (depth > 0) {
+      for (size_t i = 0; i < value->funcCallArgsSize; i++)
+        compileExpr(astGet(astGetList(value->funcCallArgs)[i]));
+
+      emitWithOperand(OP_TAIL_CALL, getFunction(funcDef));
+      chunkWriteOperand(chunk, depth);
+      changeStack(-(int) value->funcCallArgsSize);
+      return;
+    }
+  }
+
+  if (value)
+    compileExpr(value);
+  else {
+    emitWithOperand(OP_CONST, 0);
+    changeStack(1);
+  }
+
+  emit(OP_RETURN);
+  changeStack(-1);
+}
+
+static void compileIf(AST_T* node) {
+  // A condition known to be a bool doesn't need to be checked
+  AST_T* condition = astGet(node->ifCondition);
+  compileExpr(condition);
+  size_t elseJump = emitJump(condition->valueType == BOOL ? OP_JUMP_IF_NOT : OP_JUMP_IF_FALSE);
+  changeStack(-1);
+
+  compileStatement(astGet(node->ifBody));
+
+  if (!node->ifElse) {
+    patchJump(elseJump);
+    return;
+  }
+
+  // The body skips over the else
+  size_t endJump = emitJump(OP_JUMP);
+  patchJump(elseJump);
+  compileStatement(astGet(node->ifElse));
+  patchJump(endJump);
+}
+
+static void compileStatement(AST_T* node) {
+  // Check the type of the node and compile accordingly
+  switch (node->type) {
+    case AST_COMPOUND:
+      // Definitions run first, the same way the visitor hoists them
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type == AST_VARIABLE_DEFINITION)
+          compileStatement(child);
+      }
+
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type != AST_VARIABLE_DEFINITION)
+          compileStatement(child);
+      }
+      break;
+
+    case AST_VARIABLE_DEFINITION:
+      compileExpr(astGet(node->varDefVal));
+
+      // A value that isn't known to have the declared type is checked once, before the variable holds it
+      if (typeNeedsCheck(node)) {
+        emitWithOperand(OP_CHECK_TYPE, node->varType);
+        chunkWriteOperand(chunk, node->varDefSymbol);
+      }
+
+      emitWithOperand(OP_STORE, node->varDefSlot);
+      changeStack(-1);
+      break;
+
+    // Functions are compiled once they are called, and nothing is left to do for the rest
+    case AST_FUNCTION_DEFINITION:
+    case AST_NOOP: break;
+
+    case AST_STATEMENT_RETURN: compileReturn(node); break;
+    case AST_IF: compileIf(node); break;
+
+    default:
+      // Anything else is an expression whose result isn't used
+      compileExpr(node);
+      emit(OP_POP);
+      changeStack(-1);
+      break;
+  }
+}
+
+static void compileFunction(uint32_t function, AST_T* funcDef) {
+  AST_T* body = astGet(funcDef->funcDefBody);
+
+  chunk->functions[function].entry = chunk->codeSize;
+  chunk->functions[function].argsSize = funcDef->funcDefArgsSize;
+  chunk->functions[function].slotsSize = body->scope->slotsSize;
+
+  stackSize = 0;
+  maxStack = 0;
+
+  // A body that ends without a ret gives back nothing
+  compileStatement(body);
+  emitWithOperand(OP_CONST, 0);
+  changeStack(1);
+  emit(OP_RETURN);
+
+  chunk->functions[function].maxStack = maxStack;
+}
+
+chunk_T* compile(AST_T* root) {
+  chunk = initChunk();
+
+  // The program is function 0, and its code comes first
+  chunk->functions[0].slotsSize = root->scope->slotsSize;
+  stackSize = 0;
+  maxStack = 0;
+
+  compileStatement(root);
+  emit(OP_HALT);
+
+  chunk->functions[0].maxStack = maxStack;
+
+  // Then every function that is called, which may find more functions that are called
+  for (size_t i = 0; i < pendingFunctionsSize; i++)
+    compileFunction(i + 1, astGet(pendingFunctions[i]));
+
+  return chunk;
+}
\ No newline at end of file
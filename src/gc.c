@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "include/gc.h"
+
+bool gcPending = false;
+
+size_t objectsAllocated = 0;
+size_t objectBytesAllocated = 0;
+
+static object_T** objects; // Every object that hasn't been freed, in the order they were allocated
+static size_t objectsSize;
+static size_t objectsCapacity;
+
+static size_t heapBytes; // Bytes of every object that hasn't been freed
+static size_t heapLimit = GC_MIN_HEAP; // How big the heap may get before the next collection
+static size_t heapPeak;
+
+static ropeObject_T** markStack; // Ropes that are marked but whose strings haven't been yet
+static size_t markStackSize;
+static size_t markStackCapacity;
+
+static size_t collections;
+static size_t objectsFreed;
+static double pauseTotal; // Seconds spent collecting
+static double pauseLongest;
+
+static void outOfMemory() {
+  printf("Out of memory.\n");
+  exit(1);
+}
+
+static double now() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// The bytes an object was allocated with
+static size_t objectSize(object_T* object) {
+  switch (object->type) {
+    case OBJECT_STRING: return sizeof(struct STRING_OBJECT_STRUCT) + ((stringObject_T*) object)->length + 1; break;
+    case OBJECT_ROPE: return sizeof(struct ROPE_OBJECT_STRUCT); break;
+    default: return sizeof(struct INT_OBJECT_STRUCT) + ((intObject_T*) object)->length * sizeof(uint32_t); break;
+  }
+}
+
+// Every object is allocated here, so the collector and the counters see all of them
+void* allocObject(objectType_T type, size_t size) {
+  object_T* object = malloc(size);
+  if (!object)
+    outOfMemory();
+
+  object->type = type;
+  object->marked = false;
+  object->pinned = false;
+
+  if (objectsSize == objectsCapacity) {
+    objectsCapacity = objectsCapacity ? objectsCapacity * 2 : 1024;
+    objects = realloc(objects, objectsCapacity * sizeof(object_T*));
+    if (!objects)
+      outOfMemory();
+  }
+  objects[objectsSize++] = object;
+
+  objectsAllocated += 1;
+  objectBytesAllocated += size;
+
+  heapBytes += size;
+  if (heapBytes > heapPeak)
+    heapPeak = heapBytes;
+
+  // The engine collects once it is somewhere all of its values are on its stacks
+  if (heapBytes > heapLimit)
+    gcPending = true;
+
+  return object;
+}
+
+// Keep a value's object for as long as the program runs, whether or not it is reachable
+void pinValue(value_T value) {
+  if (valueIsObject(value))
+    valueToObject(value)->pinned = true;
+}
+
+static void markValue(value_T value) {
+  if (!valueIsObject(value))
+    return;
+
+  object_T* object = valueToObject(value);
+  if (object->marked)
+    return;
+  object->marked = true;
+
+  // Only a rope refers to other objects. Ropes can be nested as deep as the number of joins,
+  // so the ones whose strings still have to be marked are kept on a stack instead of recursing
+  if (object->type != OBJECT_ROPE)
+    return;
+
+  if (markStackSize == markStackCapacity) {
+    markStackCapacity = markStackCapacity ? markStackCapacity * 2 : 256;
+    markStack = realloc(markStack, markStackCapacity * sizeof(ropeObject_T*));
+    if (!markStack)
+      outOfMemory();
+  }
+  markStack[markStackSize++] = (ropeObject_T*) object;
+}
+
+void collectGarbage(const gcRoots_T* roots, size_t rootsSize) {
+  double start = now();
+
+  // Mark everything the roots reach
+  for (size_t i = 0; i < rootsSize; i++) {
+    for (size_t j = 0; j < roots[i].size; j++)
+      markValue(roots[i].values[j]);
+  }
+
+  while (markStackSize > 0) {
+    ropeObject_T* rope = markStack[--markStackSize];
+    markValue(rope->left);
+    markValue(rope->right);
+  }
+
+  // Free the rest, and keep the objects that are left in order for the next collection
+  size_t kept = 0;
+  heapBytes = 0;
+  for (size_t i = 0; i < objectsSize; i++) {
+    object_T* object = objects[i];
+
+    if (object->marked || object->pinned) {
+      object->marked = false;
+      objects[kept++] = object;
+      heapBytes += objectSize(object);
+      continue;
+    }
+
+    free(object);
+    objectsFreed += 1;
+  }
+  objectsSize = kept;
+
+  heapLimit = heapBytes * GC_HEAP_GROWTH;
+  if (heapLimit < GC_MIN_HEAP)
+    heapLimit = GC_MIN_HEAP;
+  gcPending = false;
+
+  double pause = now() - start;
+  collections += 1;
+  pauseTotal += pause;
+  if (pause > pauseLongest)
+    pauseLongest = pause;
+}
+
+// Free every object at once when the program is done. The counts are left as they were, so the stats show the heap it ended with
+void freeObjects() {
+  for (size_t i = 0; i < objectsSize; i++)
+    free(objects[i]);
+
+  free(objects);
+  free(markStack);
+  objects = (void*) 0;
+  markStack = (void*) 0;
+  objectsCapacity = 0;
+  markStackCapacity = 0;
+}
+
+void printAllocationStats() {
+  fprintf(stderr, "Objects allocated: %lu, %lu bytes\n", (unsigned long) objectsAllocated, (unsigned long) objectBytesAllocated);
+}
+
+void printGCStats() {
+  fprintf(stderr, "Collections: %lu, %lu objects freed\n", (unsigned long) collections, (unsigned long) objectsFreed);
+  fprintf(stderr, "Pauses: %.3f ms in total, %.3f ms at most\n", pauseTotal * 1e3, pauseLongest * 1e3);
+  fprintf(stderr, "Heap: %lu bytes in %lu objects at the end, %lu bytes at most\n",
+    (unsigned long) heapBytes, (unsigned long) objectsSize, (unsigned long) heapPeak);
+}
\ No newline at end of file
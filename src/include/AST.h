@@ -2,12 +2,20 @@
 #define AST_H
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "symbol.h"
 
 /**
  * @brief An AST, or Abstract Syntax Tree, is a data structure commonly used in programming language compilers and interpreters.
  *        It represents the structure of the source code in a hierarchical manner, capturing the structure and relationships between different elements of the code.
+ *
+ *        Nodes live in one pool and refer to each other with 32-bit indices instead of pointers.
+ *        Each node is a small header followed by a union holding only what its kind needs.
+ *        Lists of children (statements, arguments) are stored back to back in a separate list pool.
  */
 
+typedef uint32_t astIndex_T; // Index of a node in the node pool, or of a list in the list pool. 0 means none
+
 typedef struct AST_STRUCT {
   enum {
     AST_VARIABLE_DEFINITION, // let var = val;
@@ -24,48 +32,150 @@ typedef struct AST_STRUCT {
     AST_COMPOUND, // { statements }
     AST_BINOP, // Binary Operator
     AST_STATEMENT_RETURN, // ret val;
-    AST_NOOP // No operation
-  } type;
+    AST_NOOP, // No operation
+    AST_IF // if (condition) { statements } else { statements }
+  } type : 8;
+
+  unsigned int varType : 8; // The declared type of a variable definition or function argument
+  unsigned int isReassigned : 1; // Whether a variable definition is given a new value with rnew
+  unsigned int isTailCall : 1; // Whether a function call is the value of a ret, so it can take over its caller's frame
+  unsigned int isNativeCall : 1; // Whether a function call is to a built-in function, filled in by the resolver
+  unsigned int valueType : 8; // The type every value of an expression is known to have, or ANY, filled in by the type checker
+
+  astIndex_T index; // Where this node is in the pool
 
   struct SCOPE_STRUCT* scope;
 
-  // For variable definitions
-  char* varDefVarName;
-  struct AST_STRUCT* varDefVal;
-
-  // For variable references
-  char* varName;
-  struct AST_STRUCT* varVal;
-  bool isInitialized;
-
-  // For function definitions
-  char* funcDefName;
-  struct AST_STRUCT** funcDefArgs;
-  size_t funcDefArgsSize;
-  struct AST_STRUCT* funcDefBody;
-
-  // For function calls
-  char* funcCallName;
-  struct AST_STRUCT** funcCallArgs;
-  size_t funcCallArgsSize;
-  
-  // For strings
-  char* stringVal;
-
-  // For characters
-  char charVal;
-
-  // For bools
-  bool boolVal;
-
-  // For ints
-  long intVal;
-
-  // For compound statements
-  struct AST_STRUCT** compoundVal;
-  size_t compoundSize;
+  union {
+    // For variable definitions
+    struct {
+      symbol_T varDefSymbol;
+      astIndex_T varDefVal;
+      uint32_t varDefSlot; // Where the value is kept in the frame of its scope
+    };
+
+    // For variable references and function arguments
+    struct {
+      symbol_T varSymbol;
+      uint32_t varDepth; // How many frames out the variable lives, filled in by the resolver
+      uint32_t varSlot; // Where the value is kept in that frame
+      astIndex_T varDef; // The definition or argument it refers to, 0 for an argument itself
+    };
+
+    // For function definitions
+    struct {
+      symbol_T funcDefSymbol;
+      astIndex_T funcDefArgs; // Start of the arguments in the list pool
+      uint32_t funcDefArgsSize;
+      astIndex_T funcDefBody;
+    };
+
+    // For function calls
+    struct {
+      symbol_T funcCallSymbol;
+      astIndex_T funcCallArgs; // Start of the arguments in the list pool
+      uint32_t funcCallArgsSize;
+      union {
+        astIndex_T funcCallDef; // The function that is called, filled in by the resolver
+        uint32_t funcCallNative; // The built-in function that is called instead, see builtins.h
+      };
+    };
+
+    // For strings
+    struct {
+      char* stringVal;
+      uint64_t stringValue; // The string's runtime value once it has been made, see value.h
+    };
+
+    // For characters
+    char charVal;
+
+    // For bools
+    bool boolVal;
+
+    // For ints
+    long intVal;
+
+    // For compound statements
+    struct {
+      astIndex_T compoundVal; // Start of the statements in the list pool
+      uint32_t compoundSize;
+    };
+
+    // For binary operators
+    struct {
+      int binopOperator; // The token type of the operator, e.g. TOKEN_PLUS
+      astIndex_T binopLeft;
+      astIndex_T binopRight;
+    };
+
+    // For return statements
+    astIndex_T returnVal; // 0 when nothing is given back
+
+    // For if statements
+    struct {
+      astIndex_T ifCondition;
+      astIndex_T ifBody; // The statements that run when the condition is true
+      astIndex_T ifElse; // The statements that run otherwise, 0 when there is no else
+    };
+  };
 } AST_T;
 
+#define AST_CHUNK_BITS 12 // Nodes are allocated 4096 at a time, so a node never moves once it exists
+#define AST_CHUNK_SIZE (1 << AST_CHUNK_BITS)
+
+// The function an engine made of each function definition, by the index of the definition. An entry is 0 until the
+// engine gives the definition a function, so engines number their functions from 1
+typedef struct AST_FUNCTION_TABLE_STRUCT {
+  uint32_t* functions;
+  size_t capacity;
+} astFunctionTable_T;
+
+// An expression a pass still has to walk, and whether its operands already have been. Expressions can nest too deep
+// to recurse, so the optimizer, the type checker, the compiler and the transpiler walk them in post order with these
+typedef struct AST_WORK_STRUCT {
+  astIndex_T index;
+  bool expanded;
+} astWork_T;
+
+typedef struct AST_WORK_STACK_STRUCT {
+  astWork_T* items;
+  size_t size;
+  size_t capacity;
+} astWorkStack_T;
+
+extern AST_T** astChunks;
+
+extern astIndex_T* astLists;
+
 AST_T* initAST(int type);
 
+astIndex_T astAddList(const astIndex_T* items, size_t size);
+
+uint32_t* astFunctionEntry(astFunctionTable_T* table, astIndex_T funcDef);
+
+void astGrowWork(astWorkStack_T* stack);
+
+void printAST(AST_T* node, int depth);
+
+// Get a node from its index
+static inline AST_T* astGet(astIndex_T index) {
+  return &astChunks[index >> AST_CHUNK_BITS][index & (AST_CHUNK_SIZE - 1)];
+}
+
+// Get the first item of a list from its index
+static inline astIndex_T* astGetList(astIndex_T index) {
+  return astLists + index;
+}
+
+// Push an expression for a pass to walk
+static inline void astPushWork(astWorkStack_T* stack, astIndex_T index, bool expanded) {
+  if (stack->size == stack->capacity)
+    astGrowWork(stack);
+
+  stack->items[stack->size].index = index;
+  stack->items[stack->size].expanded = expanded;
+  stack->size += 1;
+}
+
 #endif
\ No newline at end of file
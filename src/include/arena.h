@@ -0,0 +1,42 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <stddef.h>
+
+/**
+ * @brief An arena, or region, hands out memory from a few large blocks instead of one allocation per object.
+ *        Nothing in an arena is freed on its own. Everything is released together when the arena is freed,
+ *        which matches tokens, AST nodes and scopes that all live as long as the program does.
+ */
+
+typedef struct ARENA_BLOCK_STRUCT {
+  struct ARENA_BLOCK_STRUCT* next; // The block that was filled before this one
+  size_t size; // Bytes of data in the block
+  size_t used; // Bytes of data handed out so far
+  char* data; // The memory itself
+} arenaBlock_T;
+
+typedef struct ARENA_STRUCT {
+  arenaBlock_T* blocks; // The block currently being filled, followed by the older ones
+  void* last; // The most recent allocation, which can still grow in place
+  size_t blocksSize; // The amount of blocks
+  size_t bytesUsed; // Bytes handed out across all blocks
+} arena_T;
+
+// The arena for everything that lives as long as the program
+extern arena_T* programArena;
+
+arena_T* initArena();
+
+void* arenaAlloc(arena_T* arena, size_t size);
+
+void* arenaGrow(arena_T* arena, void* ptr, size_t oldSize, size_t newSize);
+
+void* arenaGrowArray(arena_T* arena, void* array, size_t size, size_t elemSize);
+
+char* arenaStrndup(arena_T* arena, const char* str, size_t length);
+
+void freeArena(arena_T* arena);
+
+void* programAlloc(size_t size);
+
+#endif
\ No newline at end of file
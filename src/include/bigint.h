@@ -0,0 +1,25 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+#include <stddef.h>
+#include "value.h"
+
+/**
+ * @brief Ints that don't fit in the word are kept as objects holding a sign and a magnitude of 32 bit limbs,
+ *        so arithmetic never overflows. An operation on ints of the word that would overflow is done here instead,
+ *        and a result that fits in the word again goes back into it.
+ *
+ *        Multiplying uses the schoolbook method for small magnitudes, and Karatsuba's method once both
+ *        have at least BIGINT_KARATSUBA_THRESHOLD limbs, where its three half size products win over four.
+ */
+
+#define BIGINT_KARATSUBA_THRESHOLD 32
+
+#define BIGINT_MAX_LIMBS ((size_t) 1 << 27) // The biggest result ^ will try to make, 512 megabytes
+
+value_T bigIntApply(int operator, value_T left, value_T right);
+
+int bigIntCompare(value_T left, value_T right);
+
+char* bigIntToDecimal(value_T value, size_t* length);
+
+#endif
\ No newline at end of file
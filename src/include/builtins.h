@@ -0,0 +1,74 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+#include <stdint.h>
+#include "AST.h"
+#include "value.h"
+#include "symbol.h"
+
+/**
+ * @brief Built-in functions are C functions registered under a name, along with how many arguments they take
+ *        and what types those and their result have. The resolver looks a call's name up once, and both engines
+ *        call the function through its pointer from then on.
+ *
+ *        A host embedding the interpreter can add its own functions with registerNative before the program is resolved:
+ *
+ *          value_T hostTwice(value_T* args, size_t argsSize) { return valueFromInt(2 * valueToInt(args[0])); }
+ *          registerNative("twice", hostTwice, 1, 1, INT, INT);
+ */
+
+typedef value_T (*nativeFunc_T)(value_T* args, size_t argsSize);
+
+#define NATIVE_NONE 0 // Native 0 is never registered, so a call that isn't to one can be told apart
+#define NATIVE_VARIADIC -1 // The most arguments of a function that takes any amount
+
+typedef struct NATIVE_STRUCT {
+  symbol_T symbol;
+  nativeFunc_T function;
+  int minArgs;
+  int maxArgs; // NATIVE_VARIADIC when there is no limit
+  int argType; // The type every argument has to have, or ANY to take anything
+  int returnType; // The type of the result, or ANY when it depends on the arguments
+} native_T;
+
+extern native_T* natives; // Every registered function, indexed by the number registerNative gave it
+
+void initBuiltins();
+
+uint32_t registerNative(const char* name, nativeFunc_T function, int minArgs, int maxArgs, int argType, int returnType);
+
+uint32_t findNative(symbol_T symbol);
+
+void nativeArgumentError(uint32_t native);
+
+value_T builtinFuncPrint(value_T* args, size_t argsSize);
+
+value_T builtinFuncPrintln(value_T* args, size_t argsSize);
+
+// Whether a native is print or println, which the engines write out themselves when the types of the values are known.
+// A host that registers its own print under the name is called like any other function
+static inline bool nativeIsPrint(uint32_t native) {
+  return natives[native].function == builtinFuncPrint || natives[native].function == builtinFuncPrintln;
+}
+
+// Call a registered function with its arguments already worked out
+static inline value_T callNative(uint32_t native, value_T* args, size_t argsSize) {
+  native_T* entry = &natives[native];
+
+  // The arguments only have to be looked at when the function asks for a type
+  if (entry->argType != ANY) {
+    for (size_t i = 0; i < argsSize; i++) {
+      if (valueType(args[i]) != entry->argType)
+        nativeArgumentError(native);
+    }
+  }
+
+  return entry->function(args, argsSize);
+}
+
+value_T builtinFuncClear(value_T* args, size_t argsSize);
+
+value_T builtinFuncExit(value_T* args, size_t argsSize);
+
+value_T builtinFuncFlush(value_T* args, size_t argsSize);
+
+#endif
\ No newline at end of file
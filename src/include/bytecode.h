@@ -0,0 +1,120 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+#include <string.h>
+#include "AST.h"
+#include "value.h"
+
+/**
+ * @brief Bytecode is the compact form of a program that the virtual machine runs.
+ *        Every instruction is a one byte opcode followed by its operands, each a 32 bit number,
+ *        and values that are known before the program runs are kept in a constant pool.
+ */
+
+typedef enum {
+  OP_CONST, // index: push a constant
+  OP_LOAD, // slot: push a value of the running frame
+  OP_LOAD_OUTER, // depth slot: push a value of a frame the running one is nested in
+  OP_STORE, // slot: pop a value into the running frame
+  OP_POP, // drop the value on top
+  OP_ADD, // pop two values, push their sum
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_MOD,
+  OP_POW,
+  OP_EQ, // pop two values, push whether they are equal
+  OP_NOT_EQ,
+  OP_LESS,
+  OP_LESS_EQ,
+  OP_GREATER,
+  OP_GREATER_EQ,
+  OP_JUMP, // offset: go on at an offset of the code
+  OP_JUMP_IF_FALSE, // offset: pop a bool, and go on at the offset when it is false
+  OP_CALL, // function depth: call a function defined depth frames out, with its arguments on top
+  OP_TAIL_CALL, // function depth: call a function in place of the running one, which is done
+  OP_CALL_NATIVE, // native size: call a built-in function with the values on top, see builtins.h
+  OP_RETURN, // pop the result and go back to the caller
+  OP_HALT, // stop the program
+
+  // Instructions the compiler picks when the type checker knows the types of the values, see typecheck.h
+  OP_ADD_INT, // pop two ints, push their sum
+  OP_SUB_INT,
+  OP_MUL_INT,
+  OP_JUMP_IF_NOT, // offset: pop a value known to be a bool, and go on at the offset when it is false
+  OP_CHECK_TYPE, // type symbol: stop the program unless the value on top has the type a variable is declared with
+  OP_OUTPUT_INT, // distance spaced: print the int distance values below the top, after a space when spaced is 1
+  OP_OUTPUT_STRING,
+  OP_OUTPUT_CHAR,
+  OP_OUTPUT_BOOL,
+  OP_OUTPUT_VALUE, // distance spaced: print a value of any type
+  OP_OUTPUT_END, // size newline: end a print of the values on top, and replace them with its result
+
+  // Superinstructions the peephole stage fuses common sequences into
+  OP_LOAD_LOAD, // slot slot: push two values of the running frame
+  OP_LOAD_CONST, // slot index: push a value of the running frame and a constant
+  OP_LOAD_CONST_ADD, // slot index: push a value of the running frame plus a constant
+  OP_LOAD_CONST_ADD_STORE, // slot index slot: add a constant to a value of the running frame and store it
+  OP_CALL_NATIVE_POP, // native size: call a built-in function with the values on top and drop its result
+
+  OP_COUNT // How many instructions there are
+} opcode_T;
+
+extern const char* opcodeNames[OP_COUNT];
+
+extern const uint8_t opcodeOperands[OP_COUNT]; // How many operands each instruction has
+
+// A function the program can call. The program itself is function 0
+typedef struct FUNCTION_STRUCT {
+  size_t entry; // Where its code starts
+  symbol_T symbol;
+  uint32_t argsSize; // Arguments are the first values of its frame
+  uint32_t slotsSize; // Every value of its frame
+  uint32_t maxStack; // The most values its code ever has on top of its frame
+  uint32_t jitCalls; // How many times it has been called without machine code, see jit.h
+  uint32_t jitState;
+  void* jitCode; // Its machine code, or 0 when it has none
+} function_T;
+
+// Where a load happens in the code, so an error can name the variable
+typedef struct LOAD_INFO_STRUCT {
+  size_t offset;
+  symbol_T symbol;
+} loadInfo_T;
+
+typedef struct CHUNK_STRUCT {
+  uint8_t* code;
+  size_t codeSize;
+  size_t codeCapacity;
+
+  value_T* constants; // Constant 0 is the value of a call that doesn't give anything back
+  size_t constantsSize;
+
+  function_T* functions;
+  size_t functionsSize;
+
+  loadInfo_T* loads; // In the order they are in the code
+  size_t loadsSize;
+} chunk_T;
+
+chunk_T* initChunk();
+
+void chunkWriteByte(chunk_T* chunk, uint8_t byte);
+
+void chunkWriteOperand(chunk_T* chunk, uint32_t operand);
+
+uint32_t chunkAddConstant(chunk_T* chunk, value_T constant);
+
+uint32_t chunkAddFunction(chunk_T* chunk, symbol_T symbol);
+
+void chunkAddLoad(chunk_T* chunk, size_t offset, symbol_T symbol);
+
+symbol_T chunkGetLoad(chunk_T* chunk, size_t offset);
+
+// Read an operand that starts anywhere in the code
+static inline uint32_t readOperand(const uint8_t* code) {
+  uint32_t operand;
+  memcpy(&operand, code, sizeof(uint32_t));
+  return operand;
+}
+
+#endif
\ No newline at end of file
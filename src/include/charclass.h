@@ -0,0 +1,40 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+#include <stddef.h>
+
+/**
+ * @brief The character classes decide what kind of token a character can start or continue.
+ *        They are looked up in a table instead of calling isalpha/isdigit, which depend on the locale.
+ *        Runs of whitespace, identifier characters, digits and string contents are skipped by a scanner,
+ *        which uses SSE2 or AVX2 to look at 16 or 32 characters at a time when the CPU supports it.
+ */
+
+enum {
+  CHAR_SPACE = 1, // ' ', '\n', '\t', '\r'
+  CHAR_ALPHA = 2, // a-z, A-Z
+  CHAR_DIGIT = 4 // 0-9
+};
+
+extern const unsigned char charClasses[256];
+
+#define isSpaceChar(c) (charClasses[(unsigned char) (c)] & CHAR_SPACE)
+#define isAlphaChar(c) (charClasses[(unsigned char) (c)] & CHAR_ALPHA)
+#define isDigitChar(c) (charClasses[(unsigned char) (c)] & CHAR_DIGIT)
+#define isIdentChar(c) (charClasses[(unsigned char) (c)] & (CHAR_ALPHA | CHAR_DIGIT))
+
+// Each scan returns how many characters from the start of the text belong to the run
+typedef size_t (*scanFunc_T)(const char* text, size_t length);
+
+typedef struct CHAR_SCANNER_STRUCT {
+  const char* name; // scalar, sse2 or avx2
+  scanFunc_T skipSpaces; // Whitespace
+  scanFunc_T skipIdent; // Letters and numbers
+  scanFunc_T skipDigits; // Numbers
+  scanFunc_T skipString; // Everything up to a " or a null character
+} charScanner_T;
+
+const charScanner_T* getCharScanner();
+
+const charScanner_T* useCharScanner(const char* name);
+
+#endif
\ No newline at end of file
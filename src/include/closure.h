@@ -0,0 +1,26 @@
+#ifndef CLOSURE_H
+#define CLOSURE_H
+#include <stddef.h>
+#include "AST.h"
+#include "value.h"
+
+/**
+ * @brief The closure engine, picked with --engine=closure, turns every node of the AST into a closure before the program runs:
+ *        a C function that runs one kind of node, and what it needs to run it, with its children turned into closures already.
+ *        Running a node is then one indirect call, instead of a switch on its type and a step of the visitor's work stack.
+ *
+ *        What can be worked out before the program runs is picked once, when a node is turned into a closure: the slot of a variable,
+ *        the function a call runs, an operator's fast path for ints, a right operand that is a constant, the output of a print
+ *        whose values have known types, and whether a type still has to be checked.
+ *
+ *        A closure gives back the value of its node. A statement gives back VALUE_UNSET unless a ret runs in it, and then
+ *        the value that is given back, so a function stops as soon as its body gives back anything else.
+ *
+ *        Closures call each other in C, so the program runs on a thread with a C stack of its own, and the values of its frames
+ *        are kept on a value stack, where the garbage collector finds them. What the two stacks use together is charged to
+ *        the stack budget, so a C frame is bigger than the VM's and recursion doesn't go quite as deep under the same budget.
+ */
+
+void runClosures(AST_T* root, size_t budget);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+#include "AST.h"
+#include "bytecode.h"
+
+/**
+ * @brief The compiler turns a resolved AST into bytecode for the virtual machine.
+ *        Expressions become stack instructions, variables become loads and stores of frame slots,
+ *        and every function that is called gets its code after the program's.
+ *        Where the type checker knows what a value is, the instruction that works with it doesn't check it again.
+ */
+
+chunk_T* compile(AST_T* root);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef GC_H
+#define GC_H
+#include <stddef.h>
+#include "value.h"
+
+/**
+ * @brief The garbage collector frees the objects a running program can't reach anymore. Every object is allocated
+ *        on its own and kept in one list, and a collection marks everything reachable from the roots, then frees the rest.
+ *
+ *        The roots are handed over by the engine that runs the program: its stacks, which hold every frame's values and every
+ *        value being worked out, and the constants of its code. A literal's string is pinned instead, since it is kept in its
+ *        node for as long as the program lives.
+ *
+ *        Allocating never collects. Once the heap has grown past its limit, gcPending is set and the engine collects at the
+ *        next call, where every value it is working with is on one of its stacks. Since there are no loops, every long running
+ *        program goes through calls. After a collection the limit is set to GC_HEAP_GROWTH times the heap that is left,
+ *        so the time spent collecting stays in proportion to the time spent allocating.
+ */
+
+#define GC_MIN_HEAP (4 * 1024 * 1024) // The limit in bytes is never smaller than this
+#define GC_HEAP_GROWTH 2
+
+// Values an engine keeps, which a collection starts from
+typedef struct GC_ROOTS_STRUCT {
+  const value_T* values;
+  size_t size;
+} gcRoots_T;
+
+extern bool gcPending; // Whether the heap has grown past its limit since the last collection
+
+extern size_t objectsAllocated; // How many objects the program has allocated
+extern size_t objectBytesAllocated;
+
+void* allocObject(objectType_T type, size_t size);
+
+void pinValue(value_T value);
+
+void collectGarbage(const gcRoots_T* roots, size_t rootsSize);
+
+void freeObjects();
+
+void printAllocationStats();
+
+void printGCStats();
+
+#endif
\ No newline at end of file
@@ -1,7 +1,11 @@
 #ifndef IO_H
 #define IO_H
+#include <stddef.h>
 
-// Function to read the contents of a .csach file
-char* getFileContents(const char* path);
+// Function to map the contents of a .csach file into memory, storing its length in size
+char* getFileContents(const char* path, size_t* size);
+
+// Function to release the contents returned by getFileContents
+void releaseFileContents(char* contents, size_t size);
 
 #endif
\ No newline at end of file
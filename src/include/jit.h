@@ -0,0 +1,34 @@
+#ifndef JIT_H
+#define JIT_H
+#include "bytecode.h"
+
+/**
+ * @brief The JIT compiles hot functions of the bytecode to x86-64 machine code, on Linux, when the program is run with --jit.
+ *        Every instruction becomes a fixed template of machine code working on the function's frame on the value stack,
+ *        with the place of each operand worked out while compiling.
+ *
+ *        Only functions made for ints and bools are compiled: ones that don't call built-in functions, don't look at the frames
+ *        they are nested in, don't use ^, and only call functions that can be compiled too. Such a function can't change anything
+ *        but its own frame, so whenever its code meets something it doesn't handle, like an int that outgrows the word, a string,
+ *        or a value used before it has one, it bails out: the call is run again from the start by the virtual machine, which
+ *        does whatever the program would have done. The function that bailed out is never run as machine code again.
+ *
+ *        A function is compiled once it has been called jitThreshold times, along with every function it calls.
+ */
+
+#define JIT_DEFAULT_THRESHOLD 100
+#define JIT_NATIVE_STACK (1024 * 1024) // Bytes of the C stack the machine code may use, deeper calls bail out
+#define JIT_MAX_DEPTH (JIT_NATIVE_STACK / 16) // Each call of the machine code takes 16 bytes of the C stack
+#define JIT_MAX_ARGS 32
+
+enum {
+  JIT_COLD, // Not compiled yet
+  JIT_COMPILED,
+  JIT_NEVER // It can't be compiled, or it bailed out
+};
+
+extern uint32_t jitThreshold;
+
+bool jitCall(chunk_T* chunk, function_T* function, value_T* slots, value_T* limit, value_T* result);
+
+#endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef LEXER_H
 #define LEXER_H
+#include <stddef.h>
 #include "token.h"
+#include "charclass.h"
 
 /**
  * @brief A lexer is a component of a compiler or interpreter that breaks down the source code into a sequence of tokens.
@@ -11,14 +13,18 @@
 
 typedef struct LEXER_STRUCT {
 	char c; // Current character
-	unsigned int i; // Current index
+	size_t i; // Current index
 	char* contents; // File contents
+	size_t contentsSize; // Length of the contents, measured once when the lexer is created
+	const charScanner_T* scanner; // Skips runs of characters, picked for the CPU we run on
 } lexer_T;
 
-lexer_T* initLexer(char* contents);
+lexer_T* initLexer(char* contents, size_t contentsSize);
 
 void advance(lexer_T* lexer);
 
+void advanceBy(lexer_T* lexer, size_t amount);
+
 void skipWhitespace(lexer_T* lexer);
 
 token_T* getNextToken(lexer_T* lexer);
@@ -33,8 +39,8 @@ token_T* collectType(lexer_T* lexer);
 
 token_T* collectInt(lexer_T* lexer);
 
-token_T* advanceWithToken(lexer_T* lexer, token_T* token);
+token_T* collectComparison(lexer_T* lexer, int type, int typeWithEquals);
 
-char* getCurrentCharAsString(lexer_T* lexer);
+token_T* advanceWithToken(lexer_T* lexer, token_T* token);
 
 #endif
\ No newline at end of file
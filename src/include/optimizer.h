@@ -0,0 +1,13 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+#include "AST.h"
+
+/**
+ * @brief The optimizer rewrites the tree between parsing and visiting, so the visitor has less to do.
+ *        It folds operators whose operands are known, replaces constant variables with their values
+ *        and removes operators that can't change their operand, such as x * 1.
+ */
+
+void optimize(AST_T* node);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+#include <stddef.h>
+#include "value.h"
+
+/**
+ * @brief The output of a running program is gathered in one buffer of the interpreter's own, and handed to the system
+ *        with a write(2) whenever it fills up, instead of going through stdio one value at a time.
+ *
+ *        The buffer is flushed when the program ends, however it ends, by the flush() built-in function,
+ *        and after every print when the output is a terminal, so a user watching it sees each line as it comes.
+ *        An error message printed with printf just before exit() still comes out after the program's output,
+ *        since the buffer is flushed before stdio's is.
+ */
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+void initOutput();
+
+void flushOutput();
+
+void outputBytes(const char* bytes, size_t size);
+
+void outputChar(char c);
+
+void outputInt(long value);
+
+void outputIntValue(value_T value);
+
+void outputStringValue(value_T value);
+
+void outputBoolValue(value_T value);
+
+void outputValue(value_T value);
+
+// Flush after a print when someone may be watching the output
+void outputPrinted();
+
+#endif
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include "AST.h"
 #include "lexer.h"
 #include "scope.h"
-#include "list.h"
 #include "visitor.h"
 
 /**
@@ -15,11 +14,29 @@
  *        Additionally, parsers are also used in data processing tasks such as data validation, data extraction, and query parsing.
  */
 
+#define PARSER_MAX_DEPTH 10000 // Calls, blocks, ifs and functions nested deeper than this are an error, rather than overflowing the C stack
+#define PARSER_BIG_INT_DIGITS 18 // Digits of a number too big for a long that are worked out at a time
+#define PARSER_BIG_INT_BASE 1000000000000000000L // 10^PARSER_BIG_INT_DIGITS, which still fits in a long
+
+// An operator whose right operand hasn't been parsed yet, a sign before an operand, or an open parenthesis
+typedef struct PARSER_OPERATOR_STRUCT {
+  int type; // The operator's token, TOKEN_LPAREN for a parenthesis
+  int precedence;
+  bool unary; // A sign, which takes one operand
+} parserOperator_T;
+
 typedef struct PARSER_STRUCT {
   lexer_T* lexer;
   token_T* currentToken;
   token_T* prevToken;
   scope_T* scope;
+  astIndex_T* scratch; // Children of the lists being parsed, before they are copied into the list pool
+  size_t scratchSize;
+  size_t scratchCapacity;
+  struct PARSER_OPERATOR_STRUCT* operators; // Operators and parentheses of the expressions being parsed, waiting for their operands
+  size_t operatorsSize;
+  size_t operatorsCapacity;
+  size_t depth; // How many calls, blocks, ifs and functions the parser is inside of
 } parser_T;
 
 parser_T* initParser(lexer_T* lexer);
@@ -38,6 +55,10 @@ AST_T* parseNewVarDef(parser_T* parser, scope_T* scope);
 
 AST_T* parseFuncDef(parser_T* parser, scope_T* scope);
 
+AST_T* parseReturn(parser_T* parser, scope_T* scope);
+
+AST_T* parseIf(parser_T* parser, scope_T* scope);
+
 AST_T* parseVar(parser_T* parser, scope_T* scope);
 
 AST_T* parseString(parser_T* parser, scope_T* scope);
@@ -46,7 +67,7 @@ AST_T* parseBool(parser_T* parser, scope_T* scope);
 
 AST_T* parseChar(parser_T* parser, scope_T* scope);
 
-AST_T* parseIntExpr(parser_T* parser, scope_T* scope);
+AST_T* parseExpr(parser_T* parser, scope_T* scope, int minPrecedence);
 
 AST_T* parseID(parser_T* parser, scope_T* scope);
 
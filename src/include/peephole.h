@@ -0,0 +1,13 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+#include "bytecode.h"
+
+/**
+ * @brief The peephole stage looks at short runs of compiled instructions and fuses the common ones
+ *        into superinstructions, so the virtual machine dispatches fewer instructions for the same work.
+ *        Function entries and the names of loads are moved along with the code.
+ */
+
+void peephole(chunk_T* chunk);
+
+#endif
\ No newline at end of file
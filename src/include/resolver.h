@@ -0,0 +1,14 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+#include "AST.h"
+
+/**
+ * @brief The resolver runs once the whole program is parsed and works out what every name refers to.
+ *        A variable is bound to the slot its value is kept in and how many frames out that slot is,
+ *        and a function call is bound to the function it calls, so running the program never looks up a name.
+ *        Names that don't refer to anything are reported before the program starts.
+ */
+
+void resolve(AST_T* node);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+#include <stddef.h>
+#include <string.h>
+#include "value.h"
+#include "gc.h"
+#include "builtins.h"
+#include "output.h"
+#include "bigint.h"
+#include "token.h"
+
+/**
+ * @brief The runtime is what a program compiled to C with --emit-c or --build links against. It holds the values, strings,
+ *        big ints, garbage collector and built-in functions of the interpreter, and the little the generated code needs on top.
+ *
+ *        Every function of the program is a C function. Its frame is a window of the runtime's value stack, holding its
+ *        variables and, right above them, the values it is working out while it calls another function. The collector
+ *        finds every value the program works with there, and only runs when a function is entered.
+ *
+ *        The program runs on a thread of its own. Its C stack and the value stack together are charged to the budget
+ *        --stack-budget gave when the program was built, so it overflows about where the interpreter does.
+ */
+
+#define RUNTIME_STACK_RESERVE (64 * 1024) // Bytes of the C stack kept for the runtime and the built-in functions
+
+extern value_T* runtimeStack;
+extern value_T* runtimeTop; // Where the next frame starts
+extern size_t runtimeBudget; // Bytes the value stack and the C stack may use together
+extern char* runtimeNativeBase; // Where the program's C stack starts, it grows down from here
+extern char* runtimeNativeLimit; // The lowest a function's C frame may be
+
+void initRuntime(size_t budget);
+
+value_T runtimeString(const char* chars, size_t length);
+
+value_T runtimeInt(long value);
+
+uint32_t runtimeNative(const char* name);
+
+void runProgram(void (*program)());
+
+void runtimeCollect();
+
+void runtimeStackOverflow();
+
+void runtimeLoadError(const char* name);
+
+void runtimeConditionError();
+
+// Push a function's frame, with its arguments first and every other value unset.
+// The arguments may be where the frame goes, when a tail call hands over the frame of its caller
+static inline value_T* runtimeEnter(const value_T* args, size_t argsSize, size_t size, void* nativeFrame) {
+  value_T* frame = runtimeTop;
+  size_t used = (size_t) (runtimeNativeBase - (char*) nativeFrame) + (size_t) ((char*) (frame + size) - (char*) runtimeStack);
+  if (used > runtimeBudget || (char*) nativeFrame < runtimeNativeLimit)
+    runtimeStackOverflow();
+
+  memmove(frame, args, argsSize * sizeof(value_T));
+  for (size_t i = argsSize; i < size; i++)
+    frame[i] = VALUE_UNSET;
+  runtimeTop = frame + size;
+
+  // Everything the program is working with is in a frame now
+  if (gcPending)
+    runtimeCollect();
+
+  return frame;
+}
+
+// Pop a function's frame and give back its result
+static inline value_T runtimeLeave(value_T* frame, value_T result) {
+  runtimeTop = frame;
+  return result;
+}
+
+// Start a function over in its own frame, once the arguments of the call to itself are in place
+static inline void runtimeRestart(value_T* frame, size_t argsSize, size_t slotsSize) {
+  for (size_t i = argsSize; i < slotsSize; i++)
+    frame[i] = VALUE_UNSET;
+
+  // A function that only calls itself still has to collect
+  if (gcPending)
+    runtimeCollect();
+}
+
+static inline value_T runtimeLoad(value_T value, const char* name) {
+  if (value == VALUE_UNSET)
+    runtimeLoadError(name);
+
+  return value;
+}
+
+static inline bool runtimeCondition(value_T value) {
+  if (value != VALUE_TRUE && value != VALUE_FALSE)
+    runtimeConditionError();
+
+  return value == VALUE_TRUE;
+}
+
+// A value given to a variable declared with a type, when the type checker couldn't tell its type
+static inline value_T runtimeCheckType(value_T value, int type, const char* name) {
+  if (valueType(value) != type)
+    declaredTypeError(name, type, valueType(value));
+
+  return value;
+}
+
+// Ints of the word are worked with directly, the same way the virtual machine does, and anything else goes through applyOperator
+static inline value_T runtimeAdd(value_T left, value_T right) {
+  value_T result;
+  if (valueIsSmallInt(left & right) && !__builtin_add_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) &result))
+    return result;
+
+  return applyOperator(TOKEN_PLUS, left, right);
+}
+
+static inline value_T runtimeSubtract(value_T left, value_T right) {
+  value_T result;
+  if (valueIsSmallInt(left & right) && !__builtin_sub_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) &result))
+    return result;
+
+  return applyOperator(TOKEN_MINUS, left, right);
+}
+
+static inline value_T runtimeMultiply(value_T left, value_T right) {
+  long product;
+  if (valueIsSmallInt(left & right) && !__builtin_mul_overflow(valueToSmallInt(left), valueToSmallInt(right), &product))
+    return valueFromInt(product);
+
+  return applyOperator(TOKEN_MULTIPLY, left, right);
+}
+
+// Ints the type checker knows of go straight to the arithmetic of big ints when they don't fit in the word
+static inline value_T runtimeAddInts(value_T left, value_T right) {
+  value_T result;
+  if (valueIsSmallInt(left & right) && !__builtin_add_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) &result))
+    return result;
+
+  return bigIntApply(TOKEN_PLUS, left, right);
+}
+
+static inline value_T runtimeSubtractInts(value_T left, value_T right) {
+  value_T result;
+  if (valueIsSmallInt(left & right) && !__builtin_sub_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) &result))
+    return result;
+
+  return bigIntApply(TOKEN_MINUS, left, right);
+}
+
+static inline value_T runtimeMultiplyInts(value_T left, value_T right) {
+  long product;
+  if (valueIsSmallInt(left & right) && !__builtin_mul_overflow(valueToSmallInt(left), valueToSmallInt(right), &product))
+    return valueFromInt(product);
+
+  return bigIntApply(TOKEN_MULTIPLY, left, right);
+}
+
+// Tagged ints of the word compare the same way the ints do
+static inline value_T runtimeCompare(int operator, value_T left, value_T right) {
+  if (!valueIsSmallInt(left & right))
+    return applyOperator(operator, left, right);
+
+  switch (operator) {
+    case TOKEN_EQ: return valueFromBool(left == right); break;
+    case TOKEN_NOT_EQ: return valueFromBool(left != right); break;
+    case TOKEN_LESS: return valueFromBool((int64_t) left < (int64_t) right); break;
+    case TOKEN_LESS_EQ: return valueFromBool((int64_t) left <= (int64_t) right); break;
+    case TOKEN_GREATER: return valueFromBool((int64_t) left > (int64_t) right); break;
+    default: return valueFromBool((int64_t) left >= (int64_t) right); break;
+  }
+}
+
+#endif
\ No newline at end of file
@@ -7,22 +7,41 @@
  *        It determines the visibility and lifetime of variables and functions.
  */
 
+// A definition in a scope's hash table, an empty slot has SYMBOL_NONE as its symbol
+typedef struct SCOPE_ENTRY_STRUCT {
+  symbol_T symbol;
+  astIndex_T def;
+} scopeEntry_T;
+
+// Open addressing hash table from symbols to definitions
+typedef struct SCOPE_TABLE_STRUCT {
+  scopeEntry_T* entries;
+  size_t size; // The amount of definitions
+  size_t capacity; // Always a power of two, or 0 before the first definition
+} scopeTable_T;
+
 typedef struct SCOPE_STRUCT {  
-  AST_T** varDefs;
-  size_t varDefsSize;
+  scopeTable_T varDefs;
+  scopeTable_T funcDefs;
 
-  AST_T** funcDefs;
-  size_t funcDefsSize;
+  struct SCOPE_STRUCT* parent; // The scope this one is nested in, null for the global scope
+  struct SCOPE_STRUCT* owner; // The scope whose frame holds this one's values, itself unless it is a block
+  uint32_t depth; // How many scopes with a frame of their own this one is nested in
+  uint32_t slotsSize; // How many values a frame of this scope holds
 } scope_T;
 
-scope_T* initScope();
+scope_T* initScope(scope_T* parent);
+
+scope_T* initBlockScope(scope_T* parent);
 
 AST_T* scopeAddVarDef(scope_T* scope, AST_T* varDef);
 
-AST_T* scopeGetVarDef(scope_T* scope, const char* varDefName);
+AST_T* scopeAddArgument(scope_T* scope, AST_T* arg);
+
+AST_T* scopeGetVarDef(scope_T* scope, symbol_T varDefSymbol);
 
 AST_T* scopeAddFuncDef(scope_T* scope, AST_T* funcDef);
 
-AST_T* scopeGetFuncDef(scope_T* scope, const char* funcName);
+AST_T* scopeGetFuncDef(scope_T* scope, symbol_T funcSymbol);
 
 #endif
\ No newline at end of file
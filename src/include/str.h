@@ -0,0 +1,36 @@
+#ifndef STR_H
+#define STR_H
+#include <stddef.h>
+#include "value.h"
+
+/**
+ * @brief Strings are immutable and always know their length. They come in three forms:
+ *
+ *          A short string of up to STR_SHORT_MAX bytes is held in the value itself, its length in the tag byte
+ *          and its characters in the 7 bytes above it, so it never needs an object.
+ *          A flat string is one object holding its length, its hash once it has been needed, and its characters.
+ *          A rope is two strings joined. Joining makes one without copying either side, so building a string
+ *          with + one piece at a time stays linear. The first time its characters are needed, they are copied
+ *          into one flat string that the rope keeps from then on.
+ *
+ *        Joins shorter than STR_ROPE_MIN are copied right away, since a rope would take more memory than they do.
+ */
+
+#define STR_SHORT_MAX 7
+#define STR_ROPE_MIN 64
+
+value_T valueFromString(const char* chars, size_t length);
+
+size_t strLength(value_T string);
+
+const char* strChars(value_T string, char* shortChars, size_t* length);
+
+uint32_t strHash(value_T string);
+
+value_T strJoin(value_T left, value_T right);
+
+bool strEquals(value_T left, value_T right);
+
+int strCompare(value_T left, value_T right);
+
+#endif
\ No newline at end of file
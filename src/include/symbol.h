@@ -0,0 +1,43 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+#include <stddef.h>
+
+/**
+ * @brief A symbol is an identifier that has been interned into one global table.
+ *        Every distinct name is stored once and given a small integer ID, so names can be compared with == instead of strcmp.
+ *        Keywords and type names are interned first, so their IDs are known ahead of time.
+ */
+
+typedef unsigned int symbol_T;
+
+enum {
+  SYMBOL_NONE, // Not a symbol
+
+  // Keywords
+  SYMBOL_LET, // let
+  SYMBOL_FUNC, // func
+  SYMBOL_RNEW, // rnew
+  SYMBOL_TRUE, // true
+  SYMBOL_FALSE, // false
+  SYMBOL_RET, // ret
+  SYMBOL_IF, // if
+  SYMBOL_ELSE, // else
+
+  // Types
+  SYMBOL_INT, // int
+  SYMBOL_FLOAT, // float
+  SYMBOL_CHAR, // char
+  SYMBOL_BOOL, // bool
+  SYMBOL_STR, // str
+  SYMBOL_ANY, // any
+
+  SYMBOL_RESERVED_COUNT // The first ID given to a user's name
+};
+
+void initSymbols();
+
+symbol_T internSymbol(const char* name, size_t length);
+
+const char* symbolName(symbol_T symbol);
+
+#endif
\ No newline at end of file
@@ -1,5 +1,8 @@
 #ifndef TOKEN_H
 #define TOKEN_H
+#include <stddef.h>
+#include <stdbool.h>
+#include "symbol.h"
 /**
  * @brief A token represents a single unit of meaning in a program.
  * 				Tokens are the smallest individual elements of a program's source code.
@@ -32,14 +35,30 @@ typedef struct TOKEN_STRUCT {
 		TOKEN_POW, // ^
 		TOKEN_MODULO, // %
 
+		// Comparison operators
+		TOKEN_EQ, // ==
+		TOKEN_NOT_EQ, // !=
+		TOKEN_LESS, // <
+		TOKEN_LESS_EQ, // <=
+		TOKEN_GREATER, // >
+		TOKEN_GREATER_EQ, // >=
+
 		TOKEN_COLON, // : for type annotations
 		
 		TOKEN_EOF // The end of the file
   } type;
 
-	void* val; // Value of the token
+	const char* val; // Start of the token's text inside the source buffer (not null terminated)
+	size_t length; // Length of the token's text
+	long intVal; // Value of an integer token
+	bool isBigInt; // An integer too big for intVal, which the parser works out from its digits
+	symbol_T symbol; // Interned name of an identifier token
 } token_T;
 
-token_T* initToken(int tokType, void* val);
+token_T* initToken(int tokType, const char* val, size_t length);
+
+void freeToken(token_T* token);
+
+char* tokenToString(token_T* token);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef TRANSPILER_H
+#define TRANSPILER_H
+#include <stdio.h>
+#include "AST.h"
+
+/**
+ * @brief The transpiler turns a resolved AST into a C program that links against the runtime, see runtime.h,
+ *        so a program that runs often can be compiled once instead of being parsed and interpreted every time.
+ *
+ *        Every function of the program becomes a C function taking its arguments and the frames of the functions it is
+ *        nested in, since how deep a function is nested is known before it runs. Expressions become one C statement per
+ *        operator working on locals, which are only written to the frame when a call could collect the heap.
+ *        A function that gives back a call to itself jumps back to its start, and any other call that is given back
+ *        is left for the C compiler to turn into a jump.
+ *
+ *        Variables stay values of the runtime even when their type is given, since an int grows into a big int
+ *        instead of overflowing. What the type checker knows still lets operators, ifs and prints skip their checks.
+ */
+
+#define TRANSPILER_CC "cc" // The C compiler --build runs when CC isn't set
+#define TRANSPILER_INSTALL_DIR "/usr/local/lib/csach" // Where make install puts the runtime and its headers
+
+void emitC(AST_T* root, const char* filePath, size_t stackBudget, FILE* out);
+
+int buildExecutable(AST_T* root, const char* filePath, size_t stackBudget);
+
+#endif
\ No newline at end of file
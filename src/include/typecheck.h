@@ -0,0 +1,61 @@
+#ifndef TYPECHECK_H
+#define TYPECHECK_H
+#include "AST.h"
+#include "token.h"
+
+/**
+ * @brief The type checker runs once the program is resolved and optimized, and works out the type of every expression
+ *        that is known before the program runs: literals, variables declared with a type, variables whose value has
+ *        a known type, operators on known types and built-in functions that say what they give back.
+ *        Anything else is ANY and is still checked as the program runs.
+ *
+ *        A call whose arguments have known types runs a specialization of its function: a copy of the function whose
+ *        arguments have those types, so its body is typed with them and gives back a known type when every ret does.
+ *        Each function keeps its specializations, one per signature up to TYPE_MAX_SPECIALIZATIONS, and the calls are
+ *        pointed at theirs before the program runs. Calls with no known argument type run the original, where arguments are ANY.
+ *        A function's body is typed once it is called, so a function that is never called isn't checked.
+ *
+ *        A variable declared with a type is held to it, so its uses can be trusted. A value whose known type is another one
+ *        is reported before the program starts, and a value of type ANY is checked once, when the variable is given it.
+ *
+ *        The engines use the types to pick operations that skip the checks of what is already known, see the helpers below.
+ */
+
+#define TYPE_MAX_SPECIALIZATIONS 8 // Specializations a function may have before other signatures run the original
+#define TYPE_MAX_DEPTH 64 // Specializations typed inside each other before the rest wait their turn
+#define TYPE_CLONE_BUDGET (1 << 20) // Nodes all the specializations may copy together
+
+// How many places of each kind check a type as the program runs, and how many of them the types made unnecessary
+typedef struct TYPE_STATS_STRUCT {
+  unsigned long operators;
+  unsigned long operatorsKnown; // Ints added, subtracted or multiplied, which skip the operator's dispatch
+  unsigned long conditions;
+  unsigned long conditionsKnown; // Conditions known to be bools
+  unsigned long printed;
+  unsigned long printedKnown; // Values printed without looking at their type
+  unsigned long declared;
+  unsigned long declaredKnown; // Variables whose declared type is known to hold before the program runs
+  unsigned long calls; // Calls to functions of the program, which don't check types themselves
+  unsigned long callsSpecialized; // Calls that run a specialization
+  unsigned long specializations;
+} typeStats_T;
+
+extern typeStats_T typeStats;
+
+void typeCheck(AST_T* root);
+
+void printTypeStats();
+
+// Whether an operator works on two ints, and can skip straight to the arithmetic of ints
+static inline bool typeIsIntArithmetic(AST_T* binop) {
+  int operator = binop->binopOperator;
+  return (operator == TOKEN_PLUS || operator == TOKEN_MINUS || operator == TOKEN_MULTIPLY)
+    && astGet(binop->binopLeft)->valueType == INT && astGet(binop->binopRight)->valueType == INT;
+}
+
+// Whether the value a variable definition is given has to be checked against its declared type as the program runs
+static inline bool typeNeedsCheck(AST_T* varDef) {
+  return varDef->varType != ANY && astGet(varDef->varDefVal)->valueType != varDef->varType;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef VALUE_H
+#define VALUE_H
+#include <stdint.h>
+#include <stdbool.h>
+#include "AST.h"
+#include "token.h"
+
+/**
+ * @brief A value is what a running program works with. It is one 64 bit word that is copied around,
+ *        holding ints, chars, bools, void and strings of up to 7 bytes in the word itself and pointing to an object for anything bigger.
+ *        The lowest bits tell them apart:
+ *
+ *          ...1  an int of 63 bits, shifted up by one
+ *          ..10  void, false, true, a char, which has the third bit set, or a short string, see str.h
+ *          ..00  a pointer to an object, or 0 for a slot that hasn't been given a value yet
+ *
+ *        Objects are allocated and freed by the garbage collector, see gc.h.
+ */
+
+typedef uint64_t value_T;
+
+typedef enum {
+  OBJECT_STRING,
+  OBJECT_ROPE, // Two strings joined, whose characters are only copied together once they are needed
+  OBJECT_INT // An int that doesn't fit in 63 bits, see bigint.h
+} objectType_T;
+
+typedef struct OBJECT_STRUCT {
+  uint8_t type; // An objectType_T, kept small so the fields of each kind of object fit right after it
+  bool marked; // Reached during the collection that is running
+  bool pinned; // Never collected
+} object_T;
+
+typedef struct STRING_OBJECT_STRUCT {
+  object_T object;
+  uint32_t hash; // 0 until it is first needed
+  size_t length;
+  char chars[]; // Kept right after the length, and ends with a 0 that isn't part of it
+} stringObject_T;
+
+typedef struct ROPE_OBJECT_STRUCT {
+  object_T object;
+  size_t length; // Of both strings together
+  value_T left; // Once the rope has been flattened, the string holding all of it
+  value_T right; // VALUE_UNSET once the rope has been flattened
+} ropeObject_T;
+
+typedef struct INT_OBJECT_STRUCT {
+  object_T object;
+  bool negative;
+  size_t length; // How many limbs the magnitude has, the last one is never 0
+  uint32_t limbs[]; // The magnitude, lowest limb first
+} intObject_T;
+
+// Values that are known before the program runs, so they never need an allocation
+#define VALUE_UNSET ((value_T) 0) // What a slot holds before it is given a value
+#define VALUE_VOID ((value_T) 0x02)
+#define VALUE_FALSE ((value_T) 0x0A)
+#define VALUE_TRUE ((value_T) 0x12)
+#define VALUE_CHAR_TAG ((value_T) 0x06)
+#define VALUE_SHORT_STRING_TAG ((value_T) 0x1A) // In the lowest 5 bits, the length is in the 3 above them
+
+#define VALUE_SMALL_INT_MIN (INT64_MIN >> 1)
+#define VALUE_SMALL_INT_MAX (INT64_MAX >> 1)
+
+value_T valueFromBigInt(long value);
+
+value_T valueFromLiteral(AST_T* node);
+
+long valueToInt(value_T value);
+
+bool valueIsInt(value_T value);
+
+int valueType(value_T value);
+
+const char* typeName(int type);
+
+void declaredTypeError(const char* name, int declared, int given);
+
+bool applyIntOperator(int operator, long left, long right, long* result);
+
+bool applyIntComparison(int operator, long left, long right);
+
+value_T applyOperator(int operator, value_T left, value_T right);
+
+static inline bool isComparison(int operator) {
+  return operator >= TOKEN_EQ && operator <= TOKEN_GREATER_EQ;
+}
+
+static inline bool valueIsSmallInt(value_T value) {
+  return value & 1;
+}
+
+static inline bool valueIsObject(value_T value) {
+  return (value & 3) == 0 && value != VALUE_UNSET;
+}
+
+static inline object_T* valueToObject(value_T value) {
+  return (object_T*) (uintptr_t) value;
+}
+
+// Only for ints that fit in 63 bits
+static inline value_T valueFromSmallInt(long value) {
+  return ((value_T) value << 1) | 1;
+}
+
+static inline long valueToSmallInt(value_T value) {
+  return (int64_t) value >> 1; // The shift is arithmetic, so the sign comes back
+}
+
+static inline value_T valueFromInt(long value) {
+  if (value >= VALUE_SMALL_INT_MIN && value <= VALUE_SMALL_INT_MAX)
+    return valueFromSmallInt(value);
+
+  return valueFromBigInt(value);
+}
+
+static inline value_T valueFromBool(bool value) {
+  return value ? VALUE_TRUE : VALUE_FALSE;
+}
+
+static inline value_T valueFromChar(char value) {
+  return ((value_T) (unsigned char) value << 3) | VALUE_CHAR_TAG;
+}
+
+static inline char valueToChar(value_T value) {
+  return (char) (value >> 3);
+}
+
+static inline bool valueIsShortString(value_T value) {
+  return (value & 0x1F) == VALUE_SHORT_STRING_TAG;
+}
+
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef VISITOR_H
 #define VISITOR_H
 #include "AST.h"
+#include "value.h"
 
 /**
  * @brief A visitor is a design pattern that allows you to separate an algorithm from the objects it operates on.
@@ -9,24 +10,8 @@
  *        for each operation you want to perform on the objects.
  */
 
-static AST_T* builtinFuncPrint(AST_T** args, size_t argsSize);
+value_T visitProgram(AST_T* node, size_t budget);
 
-static AST_T* builtinFuncPrintln(AST_T** args, size_t argsSize);
-
-static AST_T* builtinFuncClear(size_t argsSize);
-
-static AST_T* builtinFuncExit(AST_T** args, size_t argsSize);
-
-AST_T* visit(AST_T* node);
-
-AST_T* visitVarDef(AST_T* node);
-
-AST_T* visitVar(AST_T* node);
-
-AST_T* visitFuncDef(AST_T* node);
-
-AST_T* visitFuncCall(AST_T* node);
-
-AST_T* visitCompound(AST_T* node);
+value_T visit(AST_T* node);
 
 #endif
\ No newline at end of file
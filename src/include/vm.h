@@ -0,0 +1,13 @@
+#ifndef VM_H
+#define VM_H
+#include "bytecode.h"
+
+/**
+ * @brief The virtual machine runs the bytecode the compiler produces.
+ *        Values live on one stack: every call's frame is a window of it, with the operands
+ *        of the running code right above, so arguments become the callee's values without being copied.
+ */
+
+void runVM(chunk_T* chunk, bool profile, bool jit, size_t budget);
+
+#endif
\ No newline at end of file
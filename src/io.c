@@ -1,40 +1,63 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "include/io.h"
 
-char* getFileContents(const char* path) {
+char* getFileContents(const char* path, size_t* size) {
   const char* givenExt = strrchr(path, '.');
 
-  if (strcmp(givenExt, ".csach") != 0) {
+  if (!givenExt || strcmp(givenExt, ".csach") != 0) {
     printf("File %s does not have the correct extention of \".csach\"\n", path);
     exit(2);
   }
 
-  char* buffer = 0;
-  long len;
+  int fd = open(path, O_RDONLY);
 
-  FILE* f = fopen(path, "rb");
+  if (fd < 0) {
+    printf("Error reading file %s\n", path);
+    exit(2);
+  }
 
-  if (!f) {
+  // Find out how big the file is
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
     printf("Error reading file %s\n", path);
     exit(2);
   }
 
-  fseek(f, 0, SEEK_END);
-  len = ftell(f);
-  fseek(f, 0, SEEK_SET);
+  *size = (size_t) st.st_size;
 
-  buffer = calloc(len, len);
+  // An empty file can't be mapped, so hand back an empty buffer instead
+  if (*size == 0) {
+    close(fd);
+    return "";
+  }
 
-  if (!buffer) {
+  // Map the file read-only so the lexer and the tokens can point straight into the page cache
+  char* buffer = mmap((void*) 0, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (buffer == MAP_FAILED) {
     printf("Error reading file %s\n", path);
     exit(2);
   }
 
-  fread(buffer, 1, len, f);
+  // The lexer reads the file front to back exactly once
+  madvise(buffer, *size, MADV_SEQUENTIAL);
 
-  fclose(f);
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
 
   return buffer;  
+}
+
+void releaseFileContents(char* contents, size_t size) {
+  // Nothing was mapped for an empty file
+  if (size == 0)
+    return;
+
+  munmap(contents, size);
 }
\ No newline at end of file
@@ -0,0 +1,867 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/jit.h"
+
+uint32_t jitThreshold = JIT_DEFAULT_THRESHOLD;
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define JIT_PROLOGUE_SIZE 4 // push rbx; mov rbx, rdi. A tail call jumps right after it, since it stays in the same frame
+#define JIT_BAIL SIZE_MAX // The target of a jump that bails out
+#define JIT_ENTRY (SIZE_MAX - 1) // The target of a call of the function being compiled
+
+// Registers, numbered the way instructions encode them
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RDI 7
+
+// Condition codes, a condition and its opposite only differ in the lowest bit
+#define CC_OVERFLOW 0x0
+#define CC_BELOW 0x2
+#define CC_EQUAL 0x4
+#define CC_NOT_EQUAL 0x5
+#define CC_ABOVE 0x7
+#define CC_LESS 0xC
+#define CC_GREATER_EQUAL 0xD
+#define CC_LESS_EQUAL 0xE
+#define CC_GREATER 0xF
+
+// The machine code runs with the running frame's values in rbx, the end of the value stack it may use in r15,
+// and the lowest the C stack may go in r14. The trampoline sets them up, calls the function and gives back whether it finished
+typedef bool (*jitEntry_T)(value_T* slots, void* code, value_T* result, value_T* limit, char* nativeLimit);
+
+// A jump whose target isn't known until the whole function is written
+typedef struct JIT_PATCH_STRUCT {
+  size_t at; // Where its 32 bit displacement is in the machine code
+  size_t target; // The offset of the bytecode it goes to, JIT_BAIL or JIT_ENTRY
+} jitPatch_T;
+
+// Where the value on top of the operand stack is. Only the top can be kept out of the frame, everything under it is in memory
+enum {
+  TOP_MEMORY,
+  TOP_CONSTANT, // A constant that hasn't been written yet
+  TOP_RAX // A result that is still in rax
+};
+
+static jitEntry_T entry; // The trampoline
+static void* bailCode; // Where the trampoline unwinds a bail out
+static void* entryStack; // The C stack pointer of the trampoline while the machine code runs
+static uint32_t bailedFunction; // The function that bailed out last
+
+static uint8_t* machineCode; // The machine code being written
+static size_t machineCodeSize;
+static size_t machineCodeCapacity;
+
+static jitPatch_T* patches;
+static size_t patchesSize;
+static size_t patchesCapacity;
+
+static chunk_T* chunk; // The chunk being compiled
+static uint32_t slotsSize; // Values of the frame of the function being compiled
+static size_t depth; // Values on top of its frame at the instruction being compiled
+static int top;
+static value_T topConstant;
+
+static void outOfMemory() {
+  printf("Out of memory.\n");
+  exit(1);
+}
+
+static void emitByte(uint8_t byte) {
+  if (machineCodeSize == machineCodeCapacity) {
+    machineCodeCapacity = machineCodeCapacity ? machineCodeCapacity * 2 : 4096;
+    machineCode = realloc(machineCode, machineCodeCapacity);
+    if (!machineCode)
+      outOfMemory();
+  }
+
+  machineCode[machineCodeSize++] = byte;
+}
+
+static void emitBytes(const char* bytes, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    emitByte((uint8_t) bytes[i]);
+}
+
+static void emit32(uint32_t value) {
+  for (size_t i = 0; i < 4; i++)
+    emitByte((uint8_t) (value >> (8 * i)));
+}
+
+static void emit64(uint64_t value) {
+  emit32((uint32_t) value);
+  emit32((uint32_t) (value >> 32));
+}
+
+static bool fitsInt32(int64_t value) {
+  return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+// Where a value on top of the frame is, as a displacement from rbx
+static int32_t operandAt(size_t position) {
+  return (int32_t) ((slotsSize + position) * sizeof(value_T));
+}
+
+static int32_t slotAt(uint32_t slot) {
+  return (int32_t) (slot * sizeof(value_T));
+}
+
+// mov reg, [rbx + displacement]
+static void emitLoad(int reg, int32_t displacement) {
+  emitBytes("\x48\x8B", 2);
+  emitByte(0x83 | reg << 3);
+  emit32(displacement);
+}
+
+// mov [rbx + displacement], reg
+static void emitStore(int reg, int32_t displacement) {
+  emitBytes("\x48\x89", 2);
+  emitByte(0x83 | reg << 3);
+  emit32(displacement);
+}
+
+// mov reg, value
+static void emitMoveImmediate(int reg, value_T value) {
+  if (fitsInt32((int64_t) value)) {
+    emitBytes("\x48\xC7", 2);
+    emitByte(0xC0 | reg);
+    emit32((uint32_t) value);
+    return;
+  }
+
+  emitByte(0x48);
+  emitByte(0xB8 | reg);
+  emit64(value);
+}
+
+// mov qword [base + displacement], value, where the base is rbx or rdi
+static void emitStoreImmediate(int base, int32_t displacement, value_T value) {
+  if (!fitsInt32((int64_t) value)) {
+    emitMoveImmediate(RAX, value);
+    emitBytes("\x48\x89", 2);
+    emitByte(0x80 | base);
+    emit32(displacement);
+    return;
+  }
+
+  emitBytes("\x48\xC7", 2);
+  emitByte(0x80 | base);
+  emit32(displacement);
+  emit32((uint32_t) value);
+}
+
+// A jump with a 32 bit displacement, to be filled in once the function is written
+static void emitPatch(size_t target) {
+  if (patchesSize == patchesCapacity) {
+    patchesCapacity = patchesCapacity ? patchesCapacity * 2 : 64;
+    patches = realloc(patches, patchesCapacity * sizeof(jitPatch_T));
+    if (!patches)
+      outOfMemory();
+  }
+
+  patches[patchesSize].at = machineCodeSize;
+  patches[patchesSize].target = target;
+  patchesSize += 1;
+  emit32(0);
+}
+
+static void emitJump(size_t target) {
+  emitByte(0xE9);
+  emitPatch(target);
+}
+
+static void emitJumpIf(int condition, size_t target) {
+  emitByte(0x0F);
+  emitByte(0x80 | condition);
+  emitPatch(target);
+}
+
+// Go to where an address in memory points: mov rax, address; mov rax, [rax]
+static void emitLoadPointer(const void* address) {
+  emitMoveImmediate(RAX, (uintptr_t) address);
+  emitBytes("\x48\x8B\x00", 3);
+}
+
+// Write the value on top to its place in the frame
+static void flushTop() {
+  if (top == TOP_RAX)
+    emitStore(RAX, operandAt(depth - 1));
+  else if (top == TOP_CONSTANT)
+    emitStoreImmediate(RBX, operandAt(depth - 1), topConstant);
+
+  top = TOP_MEMORY;
+}
+
+// Take the value on top into a register
+static void popTop(int reg) {
+  if (top == TOP_RAX && reg != RAX) {
+    emitBytes("\x48\x89", 2); // mov reg, rax
+    emitByte(0xC0 | reg);
+  }
+  else if (top == TOP_CONSTANT)
+    emitMoveImmediate(reg, topConstant);
+  else if (top == TOP_MEMORY)
+    emitLoad(reg, operandAt(depth - 1));
+
+  top = TOP_MEMORY;
+  depth -= 1;
+}
+
+// Load a value of the frame into rax, and bail out when it doesn't have one yet
+static void emitLoadSlot(uint32_t slot) {
+  emitLoad(RAX, slotAt(slot));
+  emitBytes("\x48\x85\xC0", 3); // test rax, rax
+  emitJumpIf(CC_EQUAL, JIT_BAIL);
+}
+
+// Bail out unless rax holds an int of the word, and rcx too when the right operand isn't a known int
+static void emitIntGuard(bool rightKnown) {
+  if (rightKnown)
+    emitBytes("\xA8\x01", 2); // test al, 1
+  else {
+    emitBytes("\x89\xC2", 2); // mov edx, eax
+    emitBytes("\x21\xCA", 2); // and edx, ecx
+    emitBytes("\xF6\xC2\x01", 3); // test dl, 1
+  }
+  emitJumpIf(CC_EQUAL, JIT_BAIL);
+}
+
+// Work out an operator on the ints in rax and rcx, or rax and a constant, into rax. Ints that outgrow the word bail out
+static void emitArithmetic(opcode_T op, bool rightConstant, value_T constant) {
+  // Any other constant is checked like a value that isn't known
+  if (rightConstant && !valueIsSmallInt(constant)) {
+    emitMoveImmediate(RCX, constant);
+    rightConstant = false;
+  }
+
+  // Adding and subtracting a constant takes it as an immediate, with the tag taken off it the same way as below
+  if (rightConstant && (op == OP_ADD || op == OP_SUB) && fitsInt32((int64_t) constant - 1)) {
+    emitIntGuard(true);
+    emitBytes(op == OP_ADD ? "\x48\x05" : "\x48\x2D", 2); // add/sub rax, constant - 1
+    emit32((uint32_t) ((int64_t) constant - 1));
+    emitJumpIf(CC_OVERFLOW, JIT_BAIL);
+    return;
+  }
+
+  if (rightConstant)
+    emitMoveImmediate(RCX, constant);
+  emitIntGuard(rightConstant);
+
+  switch (op) {
+    case OP_ADD:
+    case OP_SUB:
+      // (2a+1) + (2b+1) - 1 is 2(a+b)+1, and (2a+1) - (2b+1) + 1 is 2(a-b)+1
+      emitBytes("\x48\x83\xE9\x01", 4); // sub rcx, 1
+      emitBytes(op == OP_ADD ? "\x48\x01\xC8" : "\x48\x29\xC8", 3); // add/sub rax, rcx
+      emitJumpIf(CC_OVERFLOW, JIT_BAIL);
+      break;
+
+    case OP_MUL:
+      // a * 2b is 2ab, and the tag goes back on with an or
+      emitBytes("\x48\xD1\xF8", 3); // sar rax, 1
+      emitBytes("\x48\x83\xE9\x01", 4); // sub rcx, 1
+      emitBytes("\x48\x0F\xAF\xC1", 4); // imul rax, rcx
+      emitJumpIf(CC_OVERFLOW, JIT_BAIL);
+      emitBytes("\x48\x83\xC8\x01", 4); // or rax, 1
+      break;
+
+    case OP_DIV:
+    case OP_MOD:
+      // Dividing by zero bails out, so the virtual machine reports it
+      emitBytes("\x48\xD1\xF8", 3); // sar rax, 1
+      emitBytes("\x48\xD1\xF9", 3); // sar rcx, 1
+      emitBytes("\x48\x85\xC9", 3); // test rcx, rcx
+      emitJumpIf(CC_EQUAL, JIT_BAIL);
+      emitBytes("\x48\x99", 2); // cqo
+      emitBytes("\x48\xF7\xF9", 3); // idiv rcx
+
+      // The smallest int of the word divided by -1 is the only quotient that doesn't fit back in it
+      if (op == OP_DIV) {
+        emitBytes("\x48\x01\xC0", 3); // add rax, rax
+        emitJumpIf(CC_OVERFLOW, JIT_BAIL);
+        emitBytes("\x48\x83\xC8\x01", 4); // or rax, 1
+      }
+      else
+        emitBytes("\x48\x8D\x44\x12\x01", 5); // lea rax, [rdx + rdx + 1]
+      break;
+
+    default: break;
+  }
+}
+
+static int comparisonCondition(opcode_T op) {
+  switch (op) {
+    case OP_EQ: return CC_EQUAL; break;
+    case OP_NOT_EQ: return CC_NOT_EQUAL; break;
+    case OP_LESS: return CC_LESS; break;
+    case OP_LESS_EQ: return CC_LESS_EQUAL; break;
+    case OP_GREATER: return CC_GREATER; break;
+    default: return CC_GREATER_EQUAL; break;
+  }
+}
+
+// Compare rax with rcx or a constant. Ints of the word keep their order with the tag on, and any two values that aren't objects
+// are equal exactly when their words are, so anything else bails out
+static void emitComparison(opcode_T op, bool rightConstant, value_T constant) {
+  bool isEquality = op == OP_EQ || op == OP_NOT_EQ;
+
+  // A constant is compared as an immediate when it already passes the check the other operand has to
+  if (rightConstant && (!fitsInt32((int64_t) constant) || (isEquality ? valueIsObject(constant) : !valueIsSmallInt(constant)))) {
+    emitMoveImmediate(RCX, constant);
+    rightConstant = false;
+  }
+
+  if (!isEquality)
+    emitIntGuard(rightConstant);
+  else {
+    emitBytes("\xA8\x03", 2); // test al, 3
+    emitJumpIf(CC_EQUAL, JIT_BAIL);
+    if (!rightConstant) {
+      emitBytes("\xF6\xC1\x03", 3); // test cl, 3
+      emitJumpIf(CC_EQUAL, JIT_BAIL);
+    }
+  }
+
+  if (rightConstant) {
+    emitBytes("\x48\x3D", 2); // cmp rax, constant
+    emit32((uint32_t) constant);
+  }
+  else
+    emitBytes("\x48\x39\xC8", 3); // cmp rax, rcx
+}
+
+// Take the two operands on top for an operator, rax gets the left one. Returns whether the right one is the constant given back
+static bool popOperands(value_T* constant) {
+  bool rightConstant = top == TOP_CONSTANT;
+  *constant = topConstant;
+
+  if (rightConstant) {
+    top = TOP_MEMORY;
+    depth -= 1;
+  }
+  else
+    popTop(RCX);
+
+  popTop(RAX);
+  return rightConstant;
+}
+
+// Make the frame of a function that is called, and bail out when it doesn't fit or the function has lost its machine code.
+// base is the register pointing at the frame
+static void emitFrameCheck(int base, function_T* callee) {
+  emitBytes("\x48\x8D", 2); // lea rax, [base + end of the callee's frame]
+  emitByte(0x80 | base);
+  emit32((callee->slotsSize + callee->maxStack) * sizeof(value_T));
+  emitBytes("\x4C\x39\xF8", 3); // cmp rax, r15
+  emitJumpIf(CC_ABOVE, JIT_BAIL);
+}
+
+static void emitCall(uint32_t function, uint32_t self) {
+  function_T* callee = &chunk->functions[function];
+  uint32_t argsSize = callee->argsSize;
+
+  // The arguments on top become the first values of the callee's frame
+  emitBytes("\x48\x8D\xBB", 3); // lea rdi, [rbx + arguments]
+  emit32(operandAt(depth - argsSize));
+  emitFrameCheck(RDI, callee);
+  emitBytes("\x4C\x39\xF4", 3); // cmp rsp, r14
+  emitJumpIf(CC_BELOW, JIT_BAIL);
+
+  for (uint32_t i = argsSize; i < callee->slotsSize; i++)
+    emitStoreImmediate(RDI, slotAt(i), VALUE_UNSET);
+
+  // A function calling itself goes straight to its code, any other function can lose its machine code when it bails out
+  if (function == self) {
+    emitByte(0xE8); // call
+    emitPatch(JIT_ENTRY);
+  }
+  else {
+    emitLoadPointer(&callee->jitCode);
+    emitBytes("\x48\x85\xC0", 3); // test rax, rax
+    emitJumpIf(CC_EQUAL, JIT_BAIL);
+    emitBytes("\xFF\xD0", 2); // call rax
+  }
+
+  // The result replaces the arguments
+  depth -= argsSize;
+  depth += 1;
+  top = TOP_RAX;
+}
+
+static void emitTailCall(uint32_t function, uint32_t self) {
+  function_T* callee = &chunk->functions[function];
+  uint32_t argsSize = callee->argsSize;
+
+  emitFrameCheck(RBX, callee);
+  if (function != self) {
+    emitLoadPointer(&callee->jitCode);
+    emitBytes("\x48\x85\xC0", 3); // test rax, rax
+    emitJumpIf(CC_EQUAL, JIT_BAIL);
+  }
+
+  // The arguments move down to the start of the running frame, which the callee takes over
+  for (uint32_t i = 0; i < argsSize; i++) {
+    emitLoad(RCX, operandAt(depth - argsSize + i));
+    emitStore(RCX, slotAt(i));
+  }
+  for (uint32_t i = argsSize; i < callee->slotsSize; i++)
+    emitStoreImmediate(RBX, slotAt(i), VALUE_UNSET);
+
+  if (function == self)
+    emitJump(chunk->functions[self].entry);
+  else {
+    emitBytes("\x48\x83\xC0", 3); // add rax, JIT_PROLOGUE_SIZE
+    emitByte(JIT_PROLOGUE_SIZE);
+    emitBytes("\xFF\xE0", 2); // jmp rax
+  }
+
+  depth -= argsSize;
+}
+
+static size_t nextInstruction(size_t offset) {
+  return offset + 1 + opcodeOperands[chunk->code[offset]] * sizeof(uint32_t);
+}
+
+static uint32_t operand(size_t offset, size_t which) {
+  return readOperand(chunk->code + offset + 1 + which * sizeof(uint32_t));
+}
+
+// Where a function's code ends, which is where the next one starts
+static size_t functionEnd(uint32_t function) {
+  return function + 1 < chunk->functionsSize ? chunk->functions[function + 1].entry : chunk->codeSize;
+}
+
+static void assembleFunction(uint32_t function) {
+  function_T* info = &chunk->functions[function];
+  size_t start = info->entry;
+  size_t end = functionEnd(function);
+
+  // Which instructions a jump goes to, and where each one starts in the machine code
+  bool* jumpTargets = calloc(end - start + 1, sizeof(bool));
+  size_t* nativeOffsets = calloc(end - start + 1, sizeof(size_t));
+  if (!jumpTargets || !nativeOffsets)
+    outOfMemory();
+
+  for (size_t offset = start; offset < end; offset = nextInstruction(offset)) {
+    opcode_T op = chunk->code[offset];
+    if (op == OP_JUMP || op == OP_JUMP_IF_FALSE || op == OP_JUMP_IF_NOT)
+      jumpTargets[operand(offset, 0) - start] = true;
+  }
+
+  size_t functionStart = machineCodeSize;
+  patchesSize = 0;
+  slotsSize = info->slotsSize;
+  depth = 0;
+  top = TOP_MEMORY;
+
+  emitBytes("\x53\x48\x89\xFB", JIT_PROLOGUE_SIZE); // push rbx; mov rbx, rdi
+
+  size_t offset = start;
+  while (offset < end) {
+    // Every way into a jump target has to leave the operands in memory
+    if (jumpTargets[offset - start])
+      flushTop();
+    nativeOffsets[offset - start] = machineCodeSize;
+
+    opcode_T op = chunk->code[offset];
+    size_t next = nextInstruction(offset);
+    value_T constant;
+
+    switch (op) {
+      case OP_CONST:
+        flushTop();
+        top = TOP_CONSTANT;
+        topConstant = chunk->constants[operand(offset, 0)];
+        depth += 1;
+        break;
+
+      case OP_LOAD:
+        flushTop();
+        emitLoadSlot(operand(offset, 0));
+        top = TOP_RAX;
+        depth += 1;
+        break;
+
+      case OP_STORE:
+        if (top == TOP_CONSTANT) {
+          emitStoreImmediate(RBX, slotAt(operand(offset, 0)), topConstant);
+          top = TOP_MEMORY;
+          depth -= 1;
+          break;
+        }
+
+        popTop(RAX);
+        emitStore(RAX, slotAt(operand(offset, 0)));
+        break;
+
+      case OP_POP:
+        top = TOP_MEMORY;
+        depth -= 1;
+        break;
+
+      // Ints the type checker knows of still bail out once they outgrow the word
+      case OP_ADD_INT:
+      case OP_SUB_INT:
+      case OP_MUL_INT:
+        op = OP_ADD + (op - OP_ADD_INT);
+        // fall through
+
+      case OP_ADD:
+      case OP_SUB:
+      case OP_MUL:
+      case OP_DIV:
+      case OP_MOD: {
+        bool rightConstant = popOperands(&constant);
+        emitArithmetic(op, rightConstant, constant);
+        top = TOP_RAX;
+        depth += 1;
+        break;
+      }
+
+      case OP_EQ:
+      case OP_NOT_EQ:
+      case OP_LESS:
+      case OP_LESS_EQ:
+      case OP_GREATER:
+      case OP_GREATER_EQ: {
+        bool rightConstant = popOperands(&constant);
+        emitComparison(op, rightConstant, constant);
+        int condition = comparisonCondition(op);
+
+        // A comparison an if goes on jumps on the flags, without making a bool
+        if (next < end && (chunk->code[next] == OP_JUMP_IF_FALSE || chunk->code[next] == OP_JUMP_IF_NOT) && !jumpTargets[next - start]) {
+          emitJumpIf(condition ^ 1, operand(next, 0));
+          next = nextInstruction(next);
+          break;
+        }
+
+        emitByte(0x0F); // setcc dl
+        emitByte(0x90 | condition);
+        emitByte(0xC2);
+        emitBytes("\x0F\xB6\xD2", 3); // movzx edx, dl
+        emitBytes("\x48\x8D\x04\xD5", 4); // lea rax, [rdx * 8 + false], which is true when dl is 1
+        emit32((uint32_t) VALUE_FALSE);
+        top = TOP_RAX;
+        depth += 1;
+        break;
+      }
+
+      case OP_JUMP:
+        flushTop();
+        emitJump(operand(offset, 0));
+        break;
+
+      case OP_JUMP_IF_FALSE:
+      case OP_JUMP_IF_NOT:
+        popTop(RAX);
+        emitBytes("\x48\x83\xF8", 3); // cmp rax, false
+        emitByte((uint8_t) VALUE_FALSE);
+        emitJumpIf(CC_EQUAL, operand(offset, 0));
+        if (op == OP_JUMP_IF_NOT)
+          break;
+
+        emitBytes("\x48\x83\xF8", 3); // cmp rax, true
+        emitByte((uint8_t) VALUE_TRUE);
+        emitJumpIf(CC_NOT_EQUAL, JIT_BAIL);
+        break;
+
+      // Only ints of the word and bools get here, anything else bails out for the virtual machine to check
+      case OP_CHECK_TYPE:
+        flushTop();
+        emitLoad(RAX, operandAt(depth - 1));
+        if (operand(offset, 0) == INT)
+          emitIntGuard(true);
+        else {
+          emitBytes("\x48\x83\xE8", 3); // sub rax, false, which leaves 0 for false and true - false for true
+          emitByte((uint8_t) VALUE_FALSE);
+          emitBytes("\x48\x83\xE0", 3); // and rax, ~(true - false)
+          emitByte((uint8_t) ~(VALUE_TRUE - VALUE_FALSE));
+          emitJumpIf(CC_NOT_EQUAL, JIT_BAIL);
+        }
+        break;
+
+      case OP_CALL:
+        flushTop();
+        emitCall(operand(offset, 0), function);
+        break;
+
+      case OP_TAIL_CALL:
+        flushTop();
+        emitTailCall(operand(offset, 0), function);
+        break;
+
+      case OP_RETURN:
+        popTop(RAX);
+        emitBytes("\x5B\xC3", 2); // pop rbx; ret
+        break;
+
+      case OP_LOAD_LOAD:
+        flushTop();
+        emitLoadSlot(operand(offset, 0));
+        emitStore(RAX, operandAt(depth));
+        emitLoadSlot(operand(offset, 1));
+        top = TOP_RAX;
+        depth += 2;
+        break;
+
+      case OP_LOAD_CONST:
+        flushTop();
+        emitLoadSlot(operand(offset, 0));
+        emitStore(RAX, operandAt(depth));
+        top = TOP_CONSTANT;
+        topConstant = chunk->constants[operand(offset, 1)];
+        depth += 2;
+        break;
+
+      // A value without one yet fails the int check, so it doesn't need a check of its own
+      case OP_LOAD_CONST_ADD:
+      case OP_LOAD_CONST_ADD_STORE:
+        flushTop();
+        emitLoad(RAX, slotAt(operand(offset, 0)));
+        emitArithmetic(OP_ADD, true, chunk->constants[operand(offset, 1)]);
+
+        if (op == OP_LOAD_CONST_ADD) {
+          top = TOP_RAX;
+          depth += 1;
+        }
+        else
+          emitStore(RAX, slotAt(operand(offset, 2)));
+        break;
+
+      // canCompile only lets through the instructions above
+      default:
+        printf("The JIT can't compile %s.\n", opcodeNames[op]);
+        abort();
+        break;
+    }
+
+    offset = next;
+  }
+
+  // Bailing out notes which function did, then unwinds through the trampoline
+  size_t bail = machineCodeSize;
+  emitMoveImmediate(RAX, (uintptr_t) &bailedFunction);
+  emitBytes("\xC7\x00", 2); // mov dword [rax], function
+  emit32(function);
+  emitMoveImmediate(RAX, (uintptr_t) bailCode);
+  emitBytes("\xFF\xE0", 2); // jmp rax
+
+  for (size_t i = 0; i < patchesSize; i++) {
+    size_t target = patches[i].target;
+    if (target == JIT_BAIL)
+      target = bail;
+    else if (target == JIT_ENTRY)
+      target = functionStart;
+    else
+      target = nativeOffsets[target - start];
+
+    uint32_t displacement = (uint32_t) (target - (patches[i].at + sizeof(uint32_t)));
+    memcpy(machineCode + patches[i].at, &displacement, sizeof(uint32_t));
+  }
+
+  free(jumpTargets);
+  free(nativeOffsets);
+}
+
+// Copy machine code into pages of its own that can run but not be written to anymore
+static uint8_t* mapCode() {
+  size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+  size_t size = (machineCodeSize + pageSize - 1) & ~(pageSize - 1);
+
+  uint8_t* pages = mmap((void*) 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED)
+    outOfMemory();
+
+  memcpy(pages, machineCode, machineCodeSize);
+  if (mprotect(pages, size, PROT_READ | PROT_EXEC) != 0)
+    outOfMemory();
+
+  return pages;
+}
+
+static void initTrampoline() {
+  machineCodeSize = 0;
+
+  // Keep the registers C expects to be kept, and set up the ones the machine code runs with
+  emitBytes("\x55\x53\x41\x54\x41\x55\x41\x56\x41\x57", 10); // push rbp, rbx, r12, r13, r14, r15
+  emitBytes("\x49\x89\xD5", 3); // mov r13, rdx
+  emitBytes("\x49\x89\xCF", 3); // mov r15, rcx
+  emitBytes("\x4D\x89\xC6", 3); // mov r14, r8
+  emitMoveImmediate(RAX, (uintptr_t) &entryStack);
+  emitBytes("\x48\x89\x20", 3); // mov [rax], rsp
+  emitBytes("\xFF\xD6", 2); // call rsi
+  emitBytes("\x49\x89\x45\x00", 4); // mov [r13], rax
+  emitBytes("\xB8\x01\x00\x00\x00", 5); // mov eax, 1
+
+  size_t exit = machineCodeSize;
+  emitBytes("\x41\x5F\x41\x5E\x41\x5D\x41\x5C\x5B\x5D\xC3", 11); // pop r15, r14, r13, r12, rbx, rbp; ret
+
+  // A bail out drops every frame of the machine code at once
+  size_t bail = machineCodeSize;
+  emitMoveImmediate(RAX, (uintptr_t) &entryStack);
+  emitBytes("\x48\x8B\x20", 3); // mov rsp, [rax]
+  emitBytes("\x31\xC0", 2); // xor eax, eax
+  emitByte(0xEB); // jmp exit
+  emitByte((uint8_t) (exit - (machineCodeSize + 1)));
+
+  uint8_t* pages = mapCode();
+  entry = (jitEntry_T) (uintptr_t) pages;
+  bailCode = pages + bail;
+}
+
+// Whether every instruction of a function can be compiled. The functions it calls that have no machine code yet join the batch
+static bool canCompile(uint32_t function, uint32_t* batch, size_t* batchSize, bool* inBatch) {
+  function_T* info = &chunk->functions[function];
+  if (info->jitState == JIT_NEVER || info->argsSize > JIT_MAX_ARGS)
+    return false;
+
+  size_t end = functionEnd(function);
+  for (size_t offset = info->entry; offset < end; offset = nextInstruction(offset)) {
+    switch (chunk->code[offset]) {
+      // The instructions assembleFunction has machine code for
+      case OP_CONST:
+      case OP_LOAD:
+      case OP_STORE:
+      case OP_POP:
+      case OP_ADD_INT:
+      case OP_SUB_INT:
+      case OP_MUL_INT:
+      case OP_ADD:
+      case OP_SUB:
+      case OP_MUL:
+      case OP_DIV:
+      case OP_MOD:
+      case OP_EQ:
+      case OP_NOT_EQ:
+      case OP_LESS:
+      case OP_LESS_EQ:
+      case OP_GREATER:
+      case OP_GREATER_EQ:
+      case OP_JUMP:
+      case OP_JUMP_IF_FALSE:
+      case OP_JUMP_IF_NOT:
+      case OP_RETURN:
+      case OP_LOAD_LOAD:
+      case OP_LOAD_CONST:
+      case OP_LOAD_CONST_ADD:
+      case OP_LOAD_CONST_ADD_STORE:
+        break;
+
+      case OP_CHECK_TYPE:
+        if (operand(offset, 0) != INT && operand(offset, 0) != BOOL) {
+          info->jitState = JIT_NEVER;
+          return false;
+        }
+        break;
+
+      case OP_CALL:
+      case OP_TAIL_CALL: {
+        uint32_t callee = operand(offset, 0);
+        if (chunk->functions[callee].jitState == JIT_NEVER)
+          return false;
+
+        if (chunk->functions[callee].jitState == JIT_COLD && !inBatch[callee]) {
+          inBatch[callee] = true;
+          batch[(*batchSize)++] = callee;
+        }
+        break;
+      }
+
+      // Anything else, including instructions added later, stays on the virtual machine
+      default:
+        info->jitState = JIT_NEVER;
+        return false;
+        break;
+    }
+  }
+
+  return true;
+}
+
+// Compile a function along with every function it calls, or mark it as one that can't be
+static void compileBatch(uint32_t function) {
+  if (!entry)
+    initTrampoline();
+
+  uint32_t* batch = malloc(chunk->functionsSize * sizeof(uint32_t));
+  bool* inBatch = calloc(chunk->functionsSize, sizeof(bool));
+  if (!batch || !inBatch)
+    outOfMemory();
+
+  size_t batchSize = 0;
+  batch[batchSize++] = function;
+  inBatch[function] = true;
+
+  for (size_t i = 0; i < batchSize; i++) {
+    if (!canCompile(batch[i], batch, &batchSize, inBatch)) {
+      chunk->functions[function].jitState = JIT_NEVER;
+      free(batch);
+      free(inBatch);
+      return;
+    }
+  }
+
+  machineCodeSize = 0;
+  size_t* starts = malloc(batchSize * sizeof(size_t));
+  if (!starts)
+    outOfMemory();
+
+  for (size_t i = 0; i < batchSize; i++) {
+    starts[i] = machineCodeSize;
+    assembleFunction(batch[i]);
+  }
+
+  uint8_t* pages = mapCode();
+  for (size_t i = 0; i < batchSize; i++) {
+    chunk->functions[batch[i]].jitCode = pages + starts[i];
+    chunk->functions[batch[i]].jitState = JIT_COMPILED;
+  }
+
+  free(starts);
+  free(batch);
+  free(inBatch);
+}
+
+// Run a call of a function as machine code, compiling it first if it hasn't been. The arguments are the first values of
+// its frame, and limit is the end of the value stack its calls may use. Gives false when the virtual machine has to run the call instead
+bool jitCall(chunk_T* running, function_T* function, value_T* slots, value_T* limit, value_T* result) {
+  chunk = running;
+
+  if (function->jitState == JIT_COLD)
+    compileBatch(function - chunk->functions);
+  if (!function->jitCode)
+    return false;
+
+  // A tail call replaces the arguments, and the call starts over if it bails out
+  value_T args[JIT_MAX_ARGS];
+  memcpy(args, slots, function->argsSize * sizeof(value_T));
+
+  // The machine code's calls may take JIT_NATIVE_STACK bytes below where the C stack is now
+  uintptr_t nativeLimit = (uintptr_t) __builtin_frame_address(0) - JIT_NATIVE_STACK;
+  if (entry(slots, function->jitCode, result, limit, (char*) nativeLimit))
+    return true;
+
+  chunk->functions[bailedFunction].jitCode = (void*) 0;
+  chunk->functions[bailedFunction].jitState = JIT_NEVER;
+
+  memcpy(slots, args, function->argsSize * sizeof(value_T));
+  for (uint32_t i = function->argsSize; i < function->slotsSize; i++)
+    slots[i] = VALUE_UNSET;
+
+  return false;
+}
+
+#else
+
+// Machine code is only written for x86-64 on Linux, anywhere else every call runs on the virtual machine
+bool jitCall(chunk_T* running, function_T* function, value_T* slots, value_T* limit, value_T* result) {
+  function->jitState = JIT_NEVER;
+  return false;
+}
+
+#endif
\ No newline at end of file
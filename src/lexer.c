@@ -1,14 +1,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <ctype.h>
 #include "include/lexer.h"
+#include "include/arena.h"
 
 // Initialize a new lexer with the contents of a file
-lexer_T* initLexer(char* contents) {
-  lexer_T* lexer = calloc(1, sizeof(struct LEXER_STRUCT)); // Allocate memory for the lexer
+lexer_T* initLexer(char* contents, size_t contentsSize) {
+  lexer_T* lexer = programAlloc(sizeof(struct LEXER_STRUCT)); // Allocate memory for the lexer
   lexer->contents = contents; // Set the contents of the lexer to the contents of the file
-  lexer->c = contents[lexer->i]; // Set the current character to the first character in the file
+  lexer->contentsSize = contentsSize; // The contents don't have to be null terminated, so remember their length
+  lexer->c = contentsSize ? contents[lexer->i] : '\0'; // Set the current character to the first character in the file
+  lexer->scanner = getCharScanner(); // Use the fastest way to skip characters that the CPU supports
 
   return lexer;
 }
@@ -16,84 +18,98 @@ lexer_T* initLexer(char* contents) {
 // Advance the lexer
 void advance(lexer_T* lexer) {
   // If the current character isn't null and we aren't at the end of the file, advance
-  if ((lexer->c != '\0') && (lexer->i < strlen(lexer->contents))) {
+  if ((lexer->c != '\0') && (lexer->i < lexer->contentsSize)) {
     lexer->i += 1;
-    lexer->c = lexer->contents[lexer->i];
+    lexer->c = lexer->i < lexer->contentsSize ? lexer->contents[lexer->i] : '\0';
   }
 }
 
+// Advance the lexer by many characters at once
+void advanceBy(lexer_T* lexer, size_t amount) {
+  lexer->i += amount;
+  lexer->c = lexer->i < lexer->contentsSize ? lexer->contents[lexer->i] : '\0';
+}
+
 void skipWhitespace(lexer_T* lexer) {
-  // While there is either a space or a new line, we advance or "skip" it
-  while (lexer->c == ' ' || lexer->c == '\n')
-    advance(lexer);  
+  // Skip the whole run of spaces, tabs and new lines in one go
+  advanceBy(lexer, lexer->scanner->skipSpaces(lexer->contents + lexer->i, lexer->contentsSize - lexer->i));
 }
 
 token_T* getNextToken(lexer_T* lexer) {
   // While the character isn't null and we aren't at the end of the line, get the next token
-  while (lexer->c != '\0' && lexer->i < strlen(lexer->contents)) {
+  while (lexer->c != '\0' && lexer->i < lexer->contentsSize) {
     // Whitespace
-    if (lexer->c == ' ' || lexer->c == '\n')
+    if (isSpaceChar(lexer->c)) {
       skipWhitespace(lexer);  
+      continue;
+    }
 
     // Numbers
-    if (isdigit(lexer->c)) 
+    if (isDigitChar(lexer->c)) 
       return collectInt(lexer);
 
     // Identifiers
-		if (isalpha(lexer->c)) 
+		if (isAlphaChar(lexer->c)) 
 			return collectID(lexer);
     
     switch (lexer->c) {
       case '"': return collectString(lexer); break;
       case '\'': return collectChar(lexer); break;
-      case ':': return advanceWithToken(lexer, initToken(TOKEN_COLON, getCurrentCharAsString(lexer))); break;;
-      case '=': return advanceWithToken(lexer, initToken(TOKEN_EQUALS, getCurrentCharAsString(lexer))); break;
-      case ';': return advanceWithToken(lexer, initToken(TOKEN_SEMI, getCurrentCharAsString(lexer))); break;
-      case '(': return advanceWithToken(lexer, initToken(TOKEN_LPAREN, getCurrentCharAsString(lexer))); break;
-      case ')': return advanceWithToken(lexer, initToken(TOKEN_RPAREN, getCurrentCharAsString(lexer))); break;
-      case '{': return advanceWithToken(lexer, initToken(TOKEN_LBRACE, getCurrentCharAsString(lexer))); break;
-      case '}': return advanceWithToken(lexer, initToken(TOKEN_RBRACE, getCurrentCharAsString(lexer))); break;
-      case '[': return advanceWithToken(lexer, initToken(TOKEN_LBRACKET, getCurrentCharAsString(lexer))); break;
-      case ']': return advanceWithToken(lexer, initToken(TOKEN_RBRACKET, getCurrentCharAsString(lexer))); break;
-      case ',': return advanceWithToken(lexer, initToken(TOKEN_COMMA, getCurrentCharAsString(lexer))); break;
+      case ':': return advanceWithToken(lexer, initToken(TOKEN_COLON, lexer->contents + lexer->i, 1)); break;;
+      case '=': return collectComparison(lexer, TOKEN_EQUALS, TOKEN_EQ); break;
+      case ';': return advanceWithToken(lexer, initToken(TOKEN_SEMI, lexer->contents + lexer->i, 1)); break;
+      case '(': return advanceWithToken(lexer, initToken(TOKEN_LPAREN, lexer->contents + lexer->i, 1)); break;
+      case ')': return advanceWithToken(lexer, initToken(TOKEN_RPAREN, lexer->contents + lexer->i, 1)); break;
+      case '{': return advanceWithToken(lexer, initToken(TOKEN_LBRACE, lexer->contents + lexer->i, 1)); break;
+      case '}': return advanceWithToken(lexer, initToken(TOKEN_RBRACE, lexer->contents + lexer->i, 1)); break;
+      case '[': return advanceWithToken(lexer, initToken(TOKEN_LBRACKET, lexer->contents + lexer->i, 1)); break;
+      case ']': return advanceWithToken(lexer, initToken(TOKEN_RBRACKET, lexer->contents + lexer->i, 1)); break;
+      case ',': return advanceWithToken(lexer, initToken(TOKEN_COMMA, lexer->contents + lexer->i, 1)); break;
 
       // Math
-      case '+': return advanceWithToken(lexer, initToken(TOKEN_PLUS, getCurrentCharAsString(lexer))); break;
-      case '-': return advanceWithToken(lexer, initToken(TOKEN_MINUS, getCurrentCharAsString(lexer))); break;
-      case '*': return advanceWithToken(lexer, initToken(TOKEN_MULTIPLY, getCurrentCharAsString(lexer))); break;
-      case '/': return advanceWithToken(lexer, initToken(TOKEN_DIVIDE, getCurrentCharAsString(lexer))); break;
-      case '^': return advanceWithToken(lexer, initToken(TOKEN_POW, getCurrentCharAsString(lexer))); break;
-      case '%': return advanceWithToken(lexer, initToken(TOKEN_MODULO, getCurrentCharAsString(lexer))); break;
+      case '+': return advanceWithToken(lexer, initToken(TOKEN_PLUS, lexer->contents + lexer->i, 1)); break;
+      case '-': return advanceWithToken(lexer, initToken(TOKEN_MINUS, lexer->contents + lexer->i, 1)); break;
+      case '*': return advanceWithToken(lexer, initToken(TOKEN_MULTIPLY, lexer->contents + lexer->i, 1)); break;
+      case '/': return advanceWithToken(lexer, initToken(TOKEN_DIVIDE, lexer->contents + lexer->i, 1)); break;
+      case '^': return advanceWithToken(lexer, initToken(TOKEN_POW, lexer->contents + lexer->i, 1)); break;
+      case '%': return advanceWithToken(lexer, initToken(TOKEN_MODULO, lexer->contents + lexer->i, 1)); break;
+
+      // Comparisons
+      case '<': return collectComparison(lexer, TOKEN_LESS, TOKEN_LESS_EQ); break;
+      case '>': return collectComparison(lexer, TOKEN_GREATER, TOKEN_GREATER_EQ); break;
+      case '!':
+        if (lexer->i + 1 < lexer->contentsSize && lexer->contents[lexer->i + 1] == '=')
+          return collectComparison(lexer, TOKEN_NOT_EQ, TOKEN_NOT_EQ);
+        printf("Unexpected character `%c`\n", lexer->c);
+        exit(1);
+        break;
+
+      default:
+        printf("Unexpected character `%c`\n", lexer->c);
+        exit(1);
     }
   }
 
   // Return the end of file token
-	return initToken(TOKEN_EOF, "\0");
+	return initToken(TOKEN_EOF, "\0", 0);
 }
 
 token_T* collectString(lexer_T* lexer) {
   // Move past the first "
   advance(lexer);
 
-  char* value = calloc(1, sizeof(char)); // Allocate memory for the value
-  value[0] = '\0'; // Set the first character to null
+  size_t start = lexer->i; // Remember where the string starts
 
-  // While we are not at the final 
-  while(lexer->c != '"') {
-    char* s = getCurrentCharAsString(lexer); // Get the current character as a string
-    value = realloc(value, (strlen(value) + strlen(s) + 1) * sizeof(char)); // Reallocate memory for the value
+  // Move to the final " without copying anything
+  advanceBy(lexer, lexer->scanner->skipString(lexer->contents + start, lexer->contentsSize - start));
 
-    // Append 
-    strlcat(value, s, strlen(value) + strlen(s) + 1);
-
-		// Advance to the next character
-		advance(lexer);
-  }
+  // The token is a view of the string's text, nothing is copied
+  token_T* token = initToken(TOKEN_STRING, lexer->contents + start, lexer->i - start);
 
   // Move past the final "
   advance(lexer);
 
-	return initToken(TOKEN_STRING, value); // Return the token
+	return token; // Return the token
 }
 
 token_T* collectChar(lexer_T* lexer) {
@@ -104,7 +120,7 @@ token_T* collectChar(lexer_T* lexer) {
     exit(1);
   
 
-  char value = lexer->c; // Get the current character
+  size_t start = lexer->i; // Remember where the character is
   advance(lexer); // Move past the current character
 
   // Check if the next character is a closing single quote
@@ -116,55 +132,59 @@ token_T* collectChar(lexer_T* lexer) {
   // Move past the final '
   advance(lexer);
 
-	return initToken(TOKEN_CHAR, &value); // Return the token
+	return initToken(TOKEN_CHAR, lexer->contents + start, 1); // Return the token
 }
 
 token_T* collectID(lexer_T* lexer) {
-  char* value = calloc(1, sizeof(char)); // Allocate memory for the value
-  value[0] = '\0'; // Set the first character to null
+  size_t start = lexer->i; // Remember where the identifier starts
 
-  // While the current character is a letter
-  while(isalpha(lexer->c)) { 
-    char* s = getCurrentCharAsString(lexer); // Get the current character as a string
-    value = realloc(value, (strlen(value) + strlen(s) + 1) * sizeof(char)); // Reallocate memory for the value
+  // An identifier starts with a letter and may continue with letters or numbers (e.g. var1, var2, var3, etc.)
+	// CHARGE!!! ATTACK THE NEXT CHARACTERS!
+	// WE WILL NOT STOP UNTIL OUR KINGDOM IS VICTORIOUS!
+  advanceBy(lexer, lexer->scanner->skipIdent(lexer->contents + start, lexer->contentsSize - start));
 
-    // Append 
-    strlcat(value, s, strlen(value) + strlen(s) + 1); // Append the current character to the value
+  token_T* token = initToken(TOKEN_ID, lexer->contents + start, lexer->i - start); // Create the token as a view of the identifier
+  token->symbol = internSymbol(token->val, token->length); // Intern the identifier so the parser can compare IDs instead of strings
 
-		// CHARGE!!! ATTACK THE NEXT CHARACTER!
-		// WE WILL NOT STOP UNTIL OUR KINGDOM IS VICTORIOUS!
-		advance(lexer);
-  }
-
-	return initToken(TOKEN_ID, value); // Return the token
+	return token;
 }
 
 token_T* collectInt(lexer_T* lexer) {
-  char* value = calloc(1, sizeof(char)); // Allocate memory for the value
-  char* endptr; // Create a pointer to the end of the string
-  value[0] = '\0'; // Set the first character to null
-
-  // While the current character is a number
-  while (isdigit(lexer->c)) {
-    char* s = getCurrentCharAsString(lexer); // Get the current character as a string
-    value = realloc(value, (strlen(value) + strlen(s) + 1) * sizeof(char)); // Reallocate memory for the value
-    strcat(value, s); // Append 
-		advance(lexer); // Advance to the next character
+  size_t start = lexer->i; // Remember where the number starts
+  long valAsInt = 0; // The value of the number
+
+  bool isBigInt = false; // Whether the number doesn't fit in a long
+
+  // Find where the number ends, then add up its digits without building a string first
+  size_t length = lexer->scanner->skipDigits(lexer->contents + start, lexer->contentsSize - start);
+  for (size_t i = 0; i < length; i++) {
+    if (__builtin_mul_overflow(valAsInt, 10, &valAsInt) || __builtin_add_overflow(valAsInt, lexer->contents[start + i] - '0', &valAsInt)) {
+      isBigInt = true; // The parser makes a big int of the digits instead
+      break;
+    }
   }
 
-  long valAsInt = strtol(value, &endptr, 10); // Convert the value to an integer
+  advanceBy(lexer, length); // Move past the number
+
+  token_T* token = initToken(TOKEN_INT, lexer->contents + start, lexer->i - start); // Create the token as a view of the number
+  token->intVal = isBigInt ? 0 : valAsInt; // Give the token its value
+  token->isBigInt = isBigInt;
+
+	return token;
+}
+
+// A character that means something else when it is followed by =, like < and <=
+token_T* collectComparison(lexer_T* lexer, int type, int typeWithEquals) {
+  if (lexer->i + 1 < lexer->contentsSize && lexer->contents[lexer->i + 1] == '=') {
+    token_T* token = initToken(typeWithEquals, lexer->contents + lexer->i, 2);
+    advanceBy(lexer, 2);
+    return token;
+  }
 
-	return initToken(TOKEN_INT, (void*) valAsInt); // Return the token with the value as a void pointer casted from an integer
+  return advanceWithToken(lexer, initToken(type, lexer->contents + lexer->i, 1));
 }
 
 token_T* advanceWithToken(lexer_T* lexer, token_T* token) {
   advance(lexer); // Advance the lexer
   return token;
-}
-
-char* getCurrentCharAsString(lexer_T* lexer) {
-	char* str = calloc(2, sizeof(char)); // Allocate memory for the string
-	str[0] = lexer->c; // Set the first character to the current character
-	str[1] = '\0'; // Set the second character to null
-	return str;
 }
\ No newline at end of file
@@ -1,35 +1,256 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "include/lexer.h"
 #include "include/parser.h"
 #include "include/visitor.h"
+#include "include/closure.h"
+#include "include/builtins.h"
+#include "include/resolver.h"
+#include "include/optimizer.h"
+#include "include/typecheck.h"
+#include "include/compiler.h"
+#include "include/peephole.h"
+#include "include/vm.h"
+#include "include/jit.h"
+#include "include/transpiler.h"
+#include "include/value.h"
+#include "include/gc.h"
 #include "include/io.h"
+#include "include/output.h"
+#include "include/arena.h"
 
 void printHelp();
 
 // Print a help message
 void printHelp() {
   printf(
-    "Local usage: ./csach.out <filePath>\nSystem-wide usage: csach <filePath>\n"
+    "Local usage: ./csach.out [options] <filePath>\nSystem-wide usage: csach [options] <filePath>\n\n"
+    "Options:\n"
+    "  --engine=vm       Compile the program to bytecode and run it on the virtual machine (default)\n"
+    "  --engine=ast      Run the program by walking its AST\n"
+    "  --engine=closure  Turn every node of the AST into a closure that runs it, and run those\n"
+    "  --no-optimize     Run the program exactly as it was parsed\n"
+    "  --profile-ops     Print how often each instruction of the virtual machine ran\n"
+    "  --jit             Compile hot functions of ints and bools to machine code, on Linux x86-64\n"
+    "  --jit-threshold=N Compile a function once it has been called N times (100 by default)\n"
+    "  --jit-check       Run the program with and without the JIT, and compare what it prints and how it ends\n"
+    "  --emit-c          Print the program compiled to C, which links against the runtime libcsach.a\n"
+    "  --build           Compile the program to C and build an executable named after its file\n"
+    "  --alloc-stats     Print how many runtime objects, like strings, were allocated\n"
+    "  --gc-stats        Print how often the garbage collector ran, how long it paused and how big the heap got\n"
+    "  --type-stats      Print how many checks of types the type checker made unnecessary\n"
+    "  --stack-budget=N  Let the program's call stack use up to N megabytes (256 by default)\n"
+    "  --dump-optimized  Print the program after optimizing it instead of running it\n"
     );
   exit(1);
 }
 
+// Run the program in two processes, on the virtual machine alone and with the JIT, and report whether both print the same
+// and end the same way. Only returns in the two processes, telling each whether to use the JIT
+static bool checkJIT() {
+  FILE* outputs[2];
+  pid_t children[2];
+
+  for (int i = 0; i < 2; i++) {
+    outputs[i] = tmpfile();
+    fflush(stdout);
+    children[i] = outputs[i] ? fork() : -1;
+
+    if (children[i] < 0) {
+      printf("Couldn't start the program to check the JIT.\n");
+      exit(1);
+    }
+
+    if (children[i] == 0) {
+      dup2(fileno(outputs[i]), STDOUT_FILENO);
+      return i == 1;
+    }
+  }
+
+  int statuses[2];
+  for (int i = 0; i < 2; i++) {
+    waitpid(children[i], &statuses[i], 0);
+    rewind(outputs[i]);
+  }
+
+  // Find the first byte where the outputs differ
+  long offset = 0;
+  int vmByte;
+  int jitByte;
+  while ((vmByte = fgetc(outputs[0])) == (jitByte = fgetc(outputs[1])) && vmByte != EOF)
+    offset += 1;
+
+  if (vmByte != jitByte) {
+    printf("The JIT and the virtual machine print differently, from byte %ld on.\n", offset);
+    exit(1);
+  }
+
+  if (statuses[0] != statuses[1]) {
+    printf("The JIT and the virtual machine end differently, with status %d and %d.\n", statuses[1], statuses[0]);
+    exit(1);
+  }
+
+  printf("The JIT and the virtual machine agree, on %ld bytes of output.\n", offset);
+  exit(0);
+}
+
 int main(int argc, char* argv[]) {
+  const char* filePath = (void*) 0;
+  bool shouldOptimize = true;
+  bool dumpOptimized = false;
+  bool useVM = true;
+  bool useClosures = false;
+  bool profileOps = false;
+  bool useJIT = false;
+  bool jitCheck = false;
+  bool allocStats = false;
+  bool gcStats = false;
+  bool typeCheckStats = false;
+  bool emitCode = false;
+  bool build = false;
+  size_t stackBudget = (size_t) 256 << 20; // Bytes the stack of any engine may use
+
+  // Read the options and the file
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-optimize") == 0)
+      shouldOptimize = false;
+    else if (strcmp(argv[i], "--dump-optimized") == 0)
+      dumpOptimized = true;
+    else if (strcmp(argv[i], "--engine=vm") == 0) {
+      useVM = true;
+      useClosures = false;
+    }
+    else if (strcmp(argv[i], "--engine=ast") == 0) {
+      useVM = false;
+      useClosures = false;
+    }
+    else if (strcmp(argv[i], "--engine=closure") == 0) {
+      useVM = false;
+      useClosures = true;
+    }
+    else if (strcmp(argv[i], "--profile-ops") == 0)
+      profileOps = true;
+    else if (strcmp(argv[i], "--jit") == 0)
+      useJIT = true;
+    else if (strcmp(argv[i], "--jit-check") == 0)
+      jitCheck = true;
+    else if (strncmp(argv[i], "--jit-threshold=", 16) == 0) {
+      char* end;
+      unsigned long threshold = strtoul(argv[i] + 16, &end, 10);
+      if (*end || threshold == 0 || threshold > UINT32_MAX) {
+        printf("Invalid JIT threshold `%s`\n", argv[i] + 16);
+        printHelp();
+      }
+      jitThreshold = (uint32_t) threshold;
+    }
+    else if (strcmp(argv[i], "--emit-c") == 0)
+      emitCode = true;
+    else if (strcmp(argv[i], "--build") == 0)
+      build = true;
+    else if (strcmp(argv[i], "--alloc-stats") == 0)
+      allocStats = true;
+    else if (strcmp(argv[i], "--gc-stats") == 0)
+      gcStats = true;
+    else if (strcmp(argv[i], "--type-stats") == 0)
+      typeCheckStats = true;
+    else if (strncmp(argv[i], "--stack-budget=", 15) == 0) {
+      char* end;
+      unsigned long megabytes = strtoul(argv[i] + 15, &end, 10);
+      if (*end || megabytes == 0) {
+        printf("Invalid stack budget `%s`\n", argv[i] + 15);
+        printHelp();
+      }
+      stackBudget = (size_t) megabytes << 20;
+    }
+    else if (argv[i][0] == '-') {
+      printf("Unknown option `%s`\n", argv[i]);
+      printHelp();
+    }
+    else if (!filePath)
+      filePath = argv[i];
+    else
+      printHelp();
+  }
+
   // Check if the user has provided a file
-  if (argc != 2) 
+  if (!filePath) 
+    printHelp();
+
+  // The JIT compiles the bytecode, so it only runs with the virtual machine
+  if ((useJIT || jitCheck) && !useVM) {
+    printf("The JIT only works with --engine=vm\n");
     printHelp();
+  }
+
+  if (jitCheck)
+    useJIT = checkJIT();
+
+  // Everything the program needs until it ends is allocated from one arena
+  programArena = initArena();
+
+  // The program's output is buffered, and flushed however it ends
+  initOutput();
 
-  // Initialize the lexer
-  lexer_T* lexer = initLexer(
-    getFileContents(argv[1])
-  );
+  // The built-in functions are registered before the program is resolved against them
+  initBuiltins();
+
+  // Map the file and initialize the lexer with it
+  size_t contentsSize;
+  char* contents = getFileContents(filePath, &contentsSize);
+  lexer_T* lexer = initLexer(contents, contentsSize);
 
   // Initialize the parser
 	parser_T* parser = initParser(lexer);
   AST_T* root = parseStatements(parser, parser->scope);
 
-  // Visit the AST
-  visit(root);
+  // Bind every name to what it refers to
+  resolve(root);
+
+  // Simplify the AST before running it
+  if (shouldOptimize)
+    optimize(root);
+
+  // Work out the types that are known before the program runs, so the engines don't check them again
+  typeCheck(root);
+
+  // The counts are printed however the program ends, exit() included
+  if (allocStats)
+    atexit(printAllocationStats);
+  if (gcStats)
+    atexit(printGCStats);
+  if (typeCheckStats)
+    atexit(printTypeStats);
+
+  // Show what the program looks like after optimizing, compile it to C, or run it
+  if (dumpOptimized)
+    printAST(root, 0);
+  else if (emitCode)
+    emitC(root, filePath, stackBudget, stdout);
+  else if (build)
+    return buildExecutable(root, filePath, stackBudget);
+  else if (useVM) {
+    chunk_T* chunk = compile(root);
+
+    // Fuse common instruction sequences
+    if (shouldOptimize)
+      peephole(chunk);
+
+    runVM(chunk, profileOps, useJIT, stackBudget);
+  }
+  else if (useClosures)
+    runClosures(root, stackBudget);
+  else
+    visitProgram(root, stackBudget);
+
+  flushOutput();
+
+  // Release the program's memory in one go
+  freeObjects();
+  freeArena(programArena);
+  releaseFileContents(contents, contentsSize);
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include <string.h>
+#include "include/optimizer.h"
+#include "include/builtins.h"
+#include "include/value.h"
+#include "include/token.h"
+#include "include/arena.h"
+
+// What is known about an expression once it has been optimized
+typedef struct FACT_STRUCT {
+  bool isInt; // It evaluates to an int, or stops the program with an error
+  bool isPure; // Evaluating it can't print, fail or call anything, so it can be left out
+} fact_T;
+
+// The stacks used to walk expressions without recursion, shared the same way as the visitor's
+static astWorkStack_T workStack;
+
+static fact_T* factStack;
+static size_t factStackSize;
+static size_t factStackCapacity;
+
+static void pushFact(bool isInt, bool isPure) {
+  if (factStackSize == factStackCapacity) {
+    size_t capacity = factStackCapacity ? factStackCapacity * 2 : 64;
+    factStack = arenaGrow(programArena, factStack, factStackCapacity * sizeof(fact_T), capacity * sizeof(fact_T));
+    factStackCapacity = capacity;
+  }
+
+  factStack[factStackSize].isInt = isInt;
+  factStack[factStackSize].isPure = isPure;
+  factStackSize += 1;
+}
+
+static fact_T optimizeExpr(AST_T* node);
+
+static bool isLiteral(AST_T* node) {
+  return node->type == INT || node->type == STRING || node->type == CHAR || node->type == BOOL;
+}
+
+// Turn a node into a copy of another one, keeping its place in the pool
+static void replaceNode(AST_T* node, AST_T* with) {
+  astIndex_T index = node->index;
+  *node = *with;
+  node->index = index;
+}
+
+static void replaceWithInt(AST_T* node, long value) {
+  node->type = INT;
+  node->intVal = value;
+}
+
+static void replaceWithBool(AST_T* node, bool value) {
+  node->type = BOOL;
+  node->boolVal = value;
+}
+
+// Whether an operator on two known ints can be worked out now. The ones that would fail are left for
+// the visitor, so the program still stops where it used to, and huge powers aren't computed for nothing
+static bool canFoldInts(int operator, long right) {
+  switch (operator) {
+    case TOKEN_DIVIDE:
+    case TOKEN_MODULO: return right != 0; break;
+    case TOKEN_POW: return right >= 0; break;
+    default: return true; break;
+  }
+}
+
+// Optimize a value that isn't an operator
+static void optimizeOperand(AST_T* node) {
+  switch (node->type) {
+    case INT: pushFact(true, true); break;
+
+    case STRING:
+    case CHAR:
+    case BOOL: pushFact(false, true); break;
+
+    case AST_VARIABLE: {
+      // A let that is never given a new value is a constant, so its uses can be replaced by its value.
+      // Only uses written after the let are replaced, since one written before it may run before it has a value
+      AST_T* varDef = astGet(node->varDef);
+      if (varDef->type == AST_VARIABLE_DEFINITION && varDef->index < node->index && !varDef->isReassigned && isLiteral(astGet(varDef->varDefVal))) {
+        struct SCOPE_STRUCT* scope = node->scope;
+        replaceNode(node, astGet(varDef->varDefVal));
+        node->scope = scope;
+        pushFact(node->type == INT, true);
+        break;
+      }
+
+      // Reading anything else may evaluate a function call
+      pushFact(false, false);
+      break;
+    }
+
+    case AST_FUNCTION_CALL:
+      for (size_t i = 0; i < node->funcCallArgsSize; i++)
+        optimizeExpr(astGet(astGetList(node->funcCallArgs)[i]));
+
+      // A built-in function says what its result is, a call to anything else could give back anything
+      pushFact(node->isNativeCall && natives[node->funcCallNative].returnType == INT, false);
+      break;
+
+    default:
+      optimize(node);
+      pushFact(false, false);
+      break;
+  }
+}
+
+// Simplify an operator whose operands have been optimized, and work out what is known about the result
+static fact_T optimizeBinop(AST_T* node, fact_T leftFact, fact_T rightFact) {
+  AST_T* left = astGet(node->binopLeft);
+  AST_T* right = astGet(node->binopRight);
+  int operator = node->binopOperator;
+
+  fact_T fact;
+  fact.isInt = !isComparison(operator) && (operator != TOKEN_PLUS || leftFact.isInt || rightFact.isInt); // Only + works on strings
+  fact.isPure = false;
+
+  // Both operands are known ints
+  if (left->type == INT && right->type == INT) {
+    if (isComparison(operator)) {
+      replaceWithBool(node, applyIntComparison(operator, left->intVal, right->intVal));
+      fact.isPure = true;
+      return fact;
+    }
+
+    // A result too big for a long is left to be worked out as a bigint when the program runs
+    long result;
+    if (!canFoldInts(operator, right->intVal) || !applyIntOperator(operator, left->intVal, right->intVal, &result))
+      return fact;
+
+    replaceWithInt(node, result);
+    fact.isPure = true;
+    return fact;
+  }
+
+  // Both operands are known strings, so they are joined now instead of every time they are evaluated
+  if (operator == TOKEN_PLUS && left->type == STRING && right->type == STRING) {
+    size_t leftSize = strlen(left->stringVal);
+    size_t rightSize = strlen(right->stringVal);
+
+    char* joined = arenaAlloc(programArena, leftSize + rightSize + 1);
+    memcpy(joined, left->stringVal, leftSize);
+    memcpy(joined + leftSize, right->stringVal, rightSize);
+
+    node->type = STRING;
+    node->stringVal = joined;
+    node->stringValue = VALUE_UNSET;
+    fact.isPure = true;
+    return fact;
+  }
+
+  // Operators that can't change an int operand. They are only removed when the other side is
+  // known to be an int, so a string that would have stopped the program still does
+  bool rightIs0 = right->type == INT && right->intVal == 0;
+  bool rightIs1 = right->type == INT && right->intVal == 1;
+  bool leftIs0 = left->type == INT && left->intVal == 0;
+  bool leftIs1 = left->type == INT && left->intVal == 1;
+
+  switch (operator) {
+    case TOKEN_PLUS:
+      if (rightIs0 && leftFact.isInt) { replaceNode(node, left); return leftFact; } // x + 0
+      if (leftIs0 && rightFact.isInt) { replaceNode(node, right); return rightFact; } // 0 + x
+      break;
+
+    case TOKEN_MINUS:
+      if (rightIs0 && leftFact.isInt) { replaceNode(node, left); return leftFact; } // x - 0
+      break;
+
+    case TOKEN_MULTIPLY:
+      if (rightIs1 && leftFact.isInt) { replaceNode(node, left); return leftFact; } // x * 1
+      if (leftIs1 && rightFact.isInt) { replaceNode(node, right); return rightFact; } // 1 * x
+      break;
+
+    case TOKEN_DIVIDE:
+      if (rightIs1 && leftFact.isInt) { replaceNode(node, left); return leftFact; } // x / 1
+      break;
+
+    case TOKEN_POW:
+      if (rightIs1 && leftFact.isInt) { replaceNode(node, left); return leftFact; } // x ^ 1
+
+      // x ^ 0 leaves x out entirely, so x must not do anything when evaluated
+      if (rightIs0 && leftFact.isInt && leftFact.isPure) {
+        replaceWithInt(node, 1);
+        fact.isPure = true;
+        return fact;
+      }
+      break;
+  }
+
+  // Adding, subtracting, multiplying or comparing two ints can't fail
+  fact.isPure = leftFact.isPure && rightFact.isPure && leftFact.isInt && rightFact.isInt &&
+    (operator == TOKEN_PLUS || operator == TOKEN_MINUS || operator == TOKEN_MULTIPLY || isComparison(operator));
+
+  return fact;
+}
+
+static fact_T optimizeExpr(AST_T* node) {
+  // Walk the expression in post order with an explicit work stack, so operands are simplified
+  // before the operators using them and long expressions don't recurse
+  size_t workBase = workStack.size;
+  size_t factBase = factStackSize;
+
+  astPushWork(&workStack, node->index, false);
+
+  while (workStack.size > workBase) {
+    astWork_T work = workStack.items[--workStack.size];
+    AST_T* current = astGet(work.index);
+
+    if (current->type != AST_BINOP) {
+      optimizeOperand(current);
+      continue;
+    }
+
+    // The first time an operator is seen, its operands have to be optimized first
+    if (!work.expanded) {
+      astPushWork(&workStack, work.index, true);
+      astPushWork(&workStack, current->binopRight, false);
+      astPushWork(&workStack, current->binopLeft, false);
+      continue;
+    }
+
+    // Both operands are done, so replace their facts with the operator's
+    factStackSize -= 2;
+    factStack[factStackSize] = optimizeBinop(current, factStack[factStackSize], factStack[factStackSize + 1]);
+    factStackSize += 1;
+  }
+
+  fact_T fact = factStack[factBase];
+  factStackSize = factBase;
+
+  return fact;
+}
+
+void optimize(AST_T* node) {
+  // Check the type of the node and optimize accordingly
+  switch (node->type) {
+    case AST_COMPOUND:
+      // Definitions first, in the same order the visitor hoists them, so constants are known before they are used
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type == AST_VARIABLE_DEFINITION)
+          optimize(child);
+      }
+
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type != AST_VARIABLE_DEFINITION)
+          optimize(child);
+      }
+      break;
+
+    case AST_VARIABLE_DEFINITION: optimizeExpr(astGet(node->varDefVal)); break;
+    case AST_FUNCTION_DEFINITION: optimize(astGet(node->funcDefBody)); break;
+
+    case AST_VARIABLE:
+    case AST_FUNCTION_CALL:
+    case AST_BINOP: optimizeExpr(node); break;
+
+    case AST_STATEMENT_RETURN:
+      if (node->returnVal)
+        optimizeExpr(astGet(node->returnVal));
+      break;
+
+    case AST_IF: {
+      optimizeExpr(astGet(node->ifCondition));
+      optimize(astGet(node->ifBody));
+      if (node->ifElse)
+        optimize(astGet(node->ifElse));
+
+      // A condition that is already known picks its branch now, and the other one is dropped
+      AST_T* condition = astGet(node->ifCondition);
+      if (condition->type == BOOL) {
+        if (condition->boolVal)
+          replaceNode(node, astGet(node->ifBody));
+        else if (node->ifElse)
+          replaceNode(node, astGet(node->ifElse));
+        else
+          node->type = AST_NOOP;
+      }
+      break;
+    }
+
+    default: break;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "include/output.h"
+#include "include/bigint.h"
+#include "include/str.h"
+
+static char buffer[OUTPUT_BUFFER_SIZE];
+static size_t bufferSize;
+
+static bool isTerminal; // Whether the output goes to a terminal, which is flushed after every print
+
+// Two digits at a time, "00" to "99", so an int takes half as many divisions to format
+static const char digitPairs[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+void initOutput() {
+  isTerminal = isatty(STDOUT_FILENO);
+
+  // exit() can be called from anywhere, and the program's output has to come out before it ends
+  atexit(flushOutput);
+}
+
+// Write everything given, going on after a write that was interrupted or only took part of it
+static void writeAll(const char* bytes, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(STDOUT_FILENO, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+
+      // Nowhere to put the output, like a closed pipe, so it is dropped the way stdio would
+      return;
+    }
+
+    bytes += written;
+    size -= written;
+  }
+}
+
+void flushOutput() {
+  writeAll(buffer, bufferSize);
+  bufferSize = 0;
+}
+
+void outputBytes(const char* bytes, size_t size) {
+  if (bufferSize + size > OUTPUT_BUFFER_SIZE) {
+    flushOutput();
+
+    // Something bigger than the whole buffer goes straight out
+    if (size > OUTPUT_BUFFER_SIZE) {
+      writeAll(bytes, size);
+      return;
+    }
+  }
+
+  memcpy(buffer + bufferSize, bytes, size);
+  bufferSize += size;
+}
+
+void outputChar(char c) {
+  if (bufferSize == OUTPUT_BUFFER_SIZE)
+    flushOutput();
+
+  buffer[bufferSize++] = c;
+}
+
+void outputInt(long value) {
+  // The digits are written backwards from the end of a scratch buffer, big enough for -9223372036854775808
+  char digits[20];
+  char* start = digits + sizeof(digits);
+
+  // Work with the magnitude unsigned, so the most negative long doesn't overflow
+  unsigned long magnitude = value < 0 ? 0 - (unsigned long) value : (unsigned long) value;
+
+  while (magnitude >= 100) {
+    unsigned long pair = magnitude % 100;
+    magnitude /= 100;
+    start -= 2;
+    memcpy(start, &digitPairs[pair * 2], 2);
+  }
+
+  if (magnitude >= 10) {
+    start -= 2;
+    memcpy(start, &digitPairs[magnitude * 2], 2);
+  }
+  else
+    *--start = '0' + magnitude;
+
+  if (value < 0)
+    *--start = '-';
+
+  outputBytes(start, digits + sizeof(digits) - start);
+}
+
+// The outputs of values whose type is known, print and println go through these without looking at the type
+// when the type checker already knows it
+void outputIntValue(value_T value) {
+  if (valueIsSmallInt(value)) {
+    outputInt(valueToSmallInt(value));
+    return;
+  }
+
+  size_t length;
+  char* digits = bigIntToDecimal(value, &length);
+  outputBytes(digits, length);
+  free(digits);
+}
+
+void outputStringValue(value_T value) {
+  char shortChars[STR_SHORT_MAX + 1];
+  size_t length;
+  const char* chars = strChars(value, shortChars, &length);
+  outputBytes(chars, length);
+}
+
+void outputBoolValue(value_T value) {
+  value == VALUE_TRUE ? outputBytes("true", 4) : outputBytes("false", 5);
+}
+
+// Output a value the way print and println show it
+void outputValue(value_T value) {
+  switch (valueType(value)) {
+    case STRING: outputStringValue(value); break;
+    case INT: outputIntValue(value); break;
+    case CHAR: outputChar(valueToChar(value)); break;
+    case BOOL: outputBoolValue(value); break;
+    default: outputBytes("void", 4); break;
+  }
+}
+
+void outputPrinted() {
+  if (isTerminal)
+    flushOutput();
+}
\ No newline at end of file
@@ -3,22 +3,50 @@
 #include <stdint.h>
 #include <math.h>
 #include "include/parser.h"
+#include "include/arena.h"
 
 parser_T* initParser(lexer_T* lexer) {
-  parser_T* parser = calloc(1, sizeof(parser_T)); // Allocate memory for the parser
+  parser_T* parser = programAlloc(sizeof(parser_T)); // Allocate memory for the parser
   parser->lexer = lexer; // Set the lexer of the parser
   parser->currentToken = getNextToken(lexer); // Set the current token of the parser
   parser->prevToken = parser->currentToken; // Set the previous token of the parser
-  parser->scope = initScope(); // Set the scope of the parser
+  parser->scope = initScope((void*) 0); // Set the global scope of the parser
 
   return parser;
 }
 
+// Push a child onto the scratch stack until its list is complete
+static void pushScratch(parser_T* parser, AST_T* node) {
+  if (parser->scratchSize == parser->scratchCapacity) {
+    size_t capacity = parser->scratchCapacity ? parser->scratchCapacity * 2 : 64;
+    parser->scratch = arenaGrow(programArena, parser->scratch, parser->scratchCapacity * sizeof(astIndex_T), capacity * sizeof(astIndex_T));
+    parser->scratchCapacity = capacity;
+  }
+
+  parser->scratch[parser->scratchSize++] = node->index;
+}
+
+// Copy everything pushed since the mark into the list pool and pop it off the scratch stack
+static astIndex_T popScratchList(parser_T* parser, size_t mark) {
+  astIndex_T list = astAddList(parser->scratch + mark, parser->scratchSize - mark);
+  parser->scratchSize = mark;
+
+  return list;
+}
+
+// Calls, blocks, ifs and functions are parsed recursively, so how deep they nest is limited
+static void enterNested(parser_T* parser) {
+  if (++parser->depth > PARSER_MAX_DEPTH) {
+    printf("The program nests calls, blocks, ifs and functions more than %d deep.\n", PARSER_MAX_DEPTH);
+    exit(1);
+  }
+}
+
 void eat(parser_T* parser, int tokenType) {
   // Check if the current token is of the correct type
   if ((int) parser->currentToken->type != tokenType) {
     printf(
-      "Unexpected token `%s` with type %d\n", (char*) parser->currentToken->val, 
+      "Unexpected token `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, 
       parser->currentToken->type
     );
     printf(
@@ -45,6 +73,12 @@ void eat(parser_T* parser, int tokenType) {
 		  case TOKEN_DIVIDE: printf("/\n"); break;
 		  case TOKEN_POW: printf("^\n"); break;
 		  case TOKEN_MODULO: printf("%%\n"); break;
+      case TOKEN_EQ: printf("==\n"); break;
+      case TOKEN_NOT_EQ: printf("!=\n"); break;
+      case TOKEN_LESS: printf("<\n"); break;
+      case TOKEN_LESS_EQ: printf("<=\n"); break;
+      case TOKEN_GREATER: printf(">\n"); break;
+      case TOKEN_GREATER_EQ: printf(">=\n"); break;
       case TOKEN_COLON: printf(":\n"); break;
 		  case TOKEN_EOF: printf("EOF\n"); break;
       default: printf("an unknown token.\n"); break;
@@ -52,6 +86,10 @@ void eat(parser_T* parser, int tokenType) {
     exit(1);
   }
 
+  // Tokens are views into the source, so the one that falls out of the window can be reused
+  if (parser->prevToken != parser->currentToken)
+    freeToken(parser->prevToken);
+
   // Set the previous token to the current token and advance the current token
   parser->prevToken = parser->currentToken;
   parser->currentToken = getNextToken(parser->lexer);
@@ -62,12 +100,13 @@ AST_T* parseStatement(parser_T* parser, scope_T* scope, int type) {
   switch (type) {
     case ANY:
       switch (parser->currentToken->type) {
-        case TOKEN_STRING: return parseString(parser, scope); break;
         case TOKEN_ID: return parseID(parser, scope); break;
-        case TOKEN_CHAR: return parseChar(parser, scope); break;
+        case TOKEN_CHAR:
+        case TOKEN_STRING:
         case TOKEN_PLUS:
         case TOKEN_MINUS:
-        case TOKEN_INT: return parseIntExpr(parser, scope); break;
+        case TOKEN_LPAREN:
+        case TOKEN_INT: return parseExpr(parser, scope, 1); break;
         default: return initAST(AST_NOOP); break;
       } break;
 
@@ -75,8 +114,10 @@ AST_T* parseStatement(parser_T* parser, scope_T* scope, int type) {
       switch (parser->currentToken->type) {
         case TOKEN_PLUS:
         case TOKEN_MINUS:
-        case TOKEN_INT: return parseIntExpr(parser, scope); break;
-        default: printf("Expected an integer, but got `%s` with type %d\n", (char*) parser->currentToken->val, parser->currentToken->type); exit(1);
+        case TOKEN_LPAREN:
+        case TOKEN_ID:
+        case TOKEN_INT: return parseExpr(parser, scope, 1); break;
+        default: printf("Expected an integer, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type); exit(1);
       } break;
 
     case FLOAT:
@@ -84,26 +125,28 @@ AST_T* parseStatement(parser_T* parser, scope_T* scope, int type) {
 
     case CHAR:
       if (parser->currentToken->type != TOKEN_CHAR) {
-        printf("Expected a character, but got `%s` with type %d\n", (char*) parser->currentToken->val, parser->currentToken->type);
+        printf("Expected a character, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type);
         exit(1);
       } 
       return parseChar(parser, scope);
       break;
 
     case BOOL:
-      if (parser->currentToken->type != TOKEN_ID) {
-        printf("Expected a boolean, but got `%s` with type %d\n", (char*) parser->currentToken->val, parser->currentToken->type);
-        exit(1);
-      }
-      return parseBool(parser, scope); 
-      break;
+      switch (parser->currentToken->type) {
+        case TOKEN_ID:
+        case TOKEN_LPAREN:
+        case TOKEN_INT:
+        case TOKEN_CHAR:
+        case TOKEN_STRING: return parseExpr(parser, scope, 1); break; // Comparisons give bools
+        default: printf("Expected a boolean, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type); exit(1);
+      } break;
 
     case STRING:
       if (parser->currentToken->type != TOKEN_STRING) {
-        printf("Expected a string, but got `%s` with type %d\n", (char*) parser->currentToken->val, parser->currentToken->type);
+        printf("Expected a string, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type);
         exit(1);
       } 
-      return parseString(parser, scope);
+      return parseExpr(parser, scope, 1); // Strings can be joined with +
       break;
 
     case VOID:
@@ -114,16 +157,16 @@ AST_T* parseStatement(parser_T* parser, scope_T* scope, int type) {
 }
 
 AST_T* parseStatements(parser_T* parser, scope_T* scope) {
-  // Create a compound AST node to hold the statements and allocate memory for the statements
+  // Create a compound AST node to hold the statements
   AST_T* compound = initAST(AST_COMPOUND);
-  compound->compoundVal = calloc(1, sizeof(struct AST_STRUCT));
+  size_t mark = parser->scratchSize; // The statements are collected on the scratch stack
   
   // Parse the first statement
   AST_T* statement = parseStatement(parser, scope, ANY);
   statement->scope = scope;
 
   // Add the statement to the compound node
-  compound->compoundVal[0] = statement;
+  pushScratch(parser, statement);
   compound->compoundSize += 1;
   compound->scope = scope;  
 
@@ -133,19 +176,16 @@ AST_T* parseStatements(parser_T* parser, scope_T* scope) {
 
     AST_T* statement = parseStatement(parser, scope, ANY);
 
-    // If there is another statement, increase the size of the compound and reallocate memory for the compound's values
+    // If there is another statement, add it to the compound
     if (statement) {
+      pushScratch(parser, statement);
       compound->compoundSize += 1;    
-
-      compound->compoundVal = realloc(
-        compound->compoundVal, 
-        (compound->compoundSize + 1) * sizeof(struct AST_STRUCT)
-      );
-
-      compound->compoundVal[compound->compoundSize - 1] = statement;
     }
   }
 
+  // Store the statements next to each other in the list pool
+  compound->compoundVal = popScratchList(parser, mark);
+
   return compound;
 }
 
@@ -153,109 +193,86 @@ AST_T* parseFuncDef(parser_T* parser, scope_T* scope) {
   AST_T* funcDef = initAST(AST_FUNCTION_DEFINITION);
 
   eat(parser, TOKEN_ID); // func
-  char* funcName = parser->currentToken->val;
-  funcDef->funcDefName = calloc(
-    strlen(funcName) + 1, 
-    sizeof(char)
-  );
-  strcpy(funcDef->funcDefName, funcName);
+  funcDef->funcDefSymbol = parser->currentToken->symbol;
 
   eat(parser, TOKEN_ID); // function name
 
+  // The function is visible before its body is parsed, so the body can call it
+  funcDef->scope = scope;
+  scopeAddFuncDef(scope, funcDef);
+
+  // The arguments and the body get a scope of their own
+  scope_T* bodyScope = initScope(scope);
+
   eat(parser, TOKEN_LPAREN); // (
 
   if (parser->currentToken->type != TOKEN_RPAREN) {
-    // The arguments of the function
-    funcDef->funcDefArgs = calloc(1, sizeof(struct AST_STRUCT*));
+    // The arguments of the function are collected on the scratch stack
+    size_t mark = parser->scratchSize;
 
-    AST_T* arg = parseVar(parser, scope);
+    do {
+      if (funcDef->funcDefArgsSize)
+        eat(parser, TOKEN_COMMA); // ,
 
-    funcDef->funcDefArgsSize += 1;
-    funcDef->funcDefArgs[funcDef->funcDefArgsSize - 1] = arg;
+      AST_T* arg = parseVar(parser, bodyScope);
+      if (arg->type != AST_VARIABLE) {
+        printf("Expected an argument name in the definition of function `%s`\n", symbolName(funcDef->funcDefSymbol));
+        exit(1);
+      }
 
-    while (parser->currentToken->type == TOKEN_COMMA) {
-      eat(parser, TOKEN_COMMA); // ,
-      funcDef->funcDefArgsSize += 1;
+      // An argument takes whatever each call passes in, the type checker gives the calls that pass known types bodies of their own
+      arg->varType = ANY;
 
-      funcDef->funcDefArgs = realloc(
-        funcDef->funcDefArgs, 
-        funcDef->funcDefArgsSize * sizeof(struct AST_STRUCT*)
-      );    
+      scopeAddArgument(bodyScope, arg);
+      pushScratch(parser, arg);
+      funcDef->funcDefArgsSize += 1;
+    } while (parser->currentToken->type == TOKEN_COMMA);
 
-      AST_T* arg = parseVar(parser, scope);   
-      funcDef->funcDefArgs[funcDef->funcDefArgsSize - 1] = arg;
-    }
+    funcDef->funcDefArgs = popScratchList(parser, mark);
   }
 
   eat(parser, TOKEN_RPAREN); // )
   eat(parser, TOKEN_LBRACE); // {  
+  enterNested(parser);
 
   // The body of the function
-  funcDef->funcDefBody = parseStatements(parser, scope);
+  funcDef->funcDefBody = parseStatements(parser, bodyScope)->index;
 
   eat(parser, TOKEN_RBRACE); // }
-
-  funcDef->scope = scope;
-  visitFuncDef(funcDef);
+  parser->depth -= 1;
 
   return funcDef;
 }
 
 AST_T* parseFuncCall(parser_T* parser, scope_T* scope) {
   // Parse a function call and create an AST node with the function name and arguments as the value
+  // Which function is called is worked out by the resolver, once every function is known
   AST_T* funcCall = initAST(AST_FUNCTION_CALL);
-  funcCall->funcCallName = (char*) parser->prevToken->val;
-
-  bool isBuiltIn = false;
-  if (strcmp(funcCall->funcCallName, "print") == 0 || strcmp(funcCall->funcCallName, "println") == 0 || strcmp(funcCall->funcCallName, "clear") == 0 || strcmp(funcCall->funcCallName, "exit") == 0) 
-    isBuiltIn = true;
-  
-    
-  AST_T* funcDef = scopeGetFuncDef(scope, funcCall->funcCallName);
-  
-  if (!funcDef && !isBuiltIn) {
-    printf("Undefined function `%s`\n", funcCall->funcCallName);
-    exit(1);
-  }
+  funcCall->funcCallSymbol = parser->prevToken->symbol;
 
   eat(parser, TOKEN_LPAREN);
+  enterNested(parser);
 
   // If there are arguments
   if (parser->currentToken->type != TOKEN_RPAREN) {
-    funcCall->funcCallArgs = calloc(1, sizeof(struct AST_STRUCT));
-    
-    AST_T* statement = parseStatement(parser, scope, ANY);
-    funcCall->funcCallArgs[0] = statement;
-    funcCall->funcCallArgsSize += 1;
-
-    if (!isBuiltIn)
-      funcDef->funcDefArgs[0]->type = statement->type;
+    // The arguments are collected on the scratch stack
+    size_t mark = parser->scratchSize;
 
     // Go through the arguments of the function
-    while(parser->currentToken->type == TOKEN_COMMA) {
-      eat(parser, TOKEN_COMMA);
+    do {
+      if (funcCall->funcCallArgsSize)
+        eat(parser, TOKEN_COMMA);
 
       AST_T* statement = parseStatement(parser, scope, ANY);
+      pushScratch(parser, statement);
       funcCall->funcCallArgsSize += 1;
-      
-      funcCall->funcCallArgs = realloc(
-        funcCall->funcCallArgs, 
-        (funcCall->funcCallArgsSize + 1) * sizeof(struct AST_STRUCT)
-      );
-
-      if (!isBuiltIn && funcCall->funcCallArgsSize > funcDef->funcDefArgsSize) {
-        printf("Invalid amount of arguments passed into function `%s`\n", funcCall->funcCallName);
-        exit(1);
-      }
+    } while(parser->currentToken->type == TOKEN_COMMA);
 
-      funcCall->funcCallArgs[funcCall->funcCallArgsSize - 1] = statement;
-
-      if (!isBuiltIn)
-        funcDef->funcDefArgs[funcCall->funcCallArgsSize - 1]->type = statement->type;
-    }
+    funcCall->funcCallArgs = popScratchList(parser, mark);
   }
 
   eat(parser, TOKEN_RPAREN);
+  parser->depth -= 1;
 
   funcCall->scope = scope; // Add it to the scope
 
@@ -266,39 +283,33 @@ AST_T* parseVarDef(parser_T* parser, scope_T* scope) {
   AST_T* varDef = initAST(AST_VARIABLE_DEFINITION);
 
   eat(parser, TOKEN_ID); // let
-  char* varDefVarName = parser->currentToken->val;
-  varDef->varDefVarName = varDefVarName;
+  varDef->varDefSymbol = parser->currentToken->symbol;
   eat(parser, TOKEN_ID); // variable name
 
   if (parser->currentToken->type == TOKEN_COLON) {
     eat(parser, TOKEN_COLON); // :
-    if (strcmp(parser->currentToken->val, "int") == 0)
-      varDef->type = INT;
-    else if (strcmp(parser->currentToken->val, "float") == 0)
-      varDef->type = FLOAT;
-    else if (strcmp(parser->currentToken->val, "char") == 0)
-      varDef->type = CHAR;
-    else if (strcmp(parser->currentToken->val, "bool") == 0)
-      varDef->type = BOOL;
-    else if (strcmp(parser->currentToken->val, "str") == 0)
-      varDef->type = STRING;
-    else if (strcmp(parser->currentToken->val, "any") == 0)
-      varDef->type = ANY;
-    else {
-      printf("Unknown type `%s`\n", (char*) parser->currentToken->val);
-      exit(1);
+    switch (parser->currentToken->symbol) {
+      case SYMBOL_INT: varDef->varType = INT; break;
+      case SYMBOL_FLOAT: varDef->varType = FLOAT; break;
+      case SYMBOL_CHAR: varDef->varType = CHAR; break;
+      case SYMBOL_BOOL: varDef->varType = BOOL; break;
+      case SYMBOL_STR: varDef->varType = STRING; break;
+      case SYMBOL_ANY: varDef->varType = ANY; break;
+      default:
+        printf("Unknown type `%.*s`\n", (int) parser->currentToken->length, parser->currentToken->val);
+        exit(1);
     }
     eat(parser, TOKEN_ID); // type
   }
   else 
-    varDef->type = ANY; // Default type is ANY
+    varDef->varType = ANY; // Default type is ANY
   
   eat(parser, TOKEN_EQUALS); // =
 
-  varDef->varDefVal = parseStatement(parser, scope, varDef->type); // value;  
+  varDef->varDefVal = parseStatement(parser, scope, varDef->varType)->index; // value;  
 
   varDef->scope = scope; // Add it to the scope
-  visitVarDef(varDef);
+  scopeAddVarDef(scope, varDef);
 
   return varDef;
 }
@@ -306,10 +317,16 @@ AST_T* parseVarDef(parser_T* parser, scope_T* scope) {
 AST_T* parseNewVarDef(parser_T* parser, scope_T* scope) {
   // Parse a new variable definition and create an AST node with the variable name and value as the value
   eat(parser, TOKEN_ID); // rnew
-  AST_T* varDef = scopeGetVarDef(scope, parser->currentToken->val);
+  AST_T* varDef = scopeGetVarDef(scope, parser->currentToken->symbol);
 
   if (!varDef) {
-    printf("Undefined variable `%s`\n", (char*) parser->currentToken->val);
+    printf("Undefined variable `%.*s`\n", (int) parser->currentToken->length, parser->currentToken->val);
+    exit(1);
+  }
+
+  // Arguments only get their value when the function is called
+  if (varDef->type != AST_VARIABLE_DEFINITION) {
+    printf("The argument `%.*s` can't be given a new value\n", (int) parser->currentToken->length, parser->currentToken->val);
     exit(1);
   }
 
@@ -317,23 +334,71 @@ AST_T* parseNewVarDef(parser_T* parser, scope_T* scope) {
 
   eat(parser, TOKEN_EQUALS); // =
 
-  varDef->varDefVal = parseStatement(parser, scope, varDef->type); // value;  
+  varDef->varDefVal = parseStatement(parser, scope, varDef->varType)->index; // value;  
+  varDef->isReassigned = true; // The optimizer can't treat it as a constant anymore
 
-  return varDef;
+  // The definition already runs where it was written, with its new value
+  AST_T* noop = initAST(AST_NOOP);
+  noop->scope = scope;
+
+  return noop;
+}
+
+AST_T* parseReturn(parser_T* parser, scope_T* scope) {
+  AST_T* ret = initAST(AST_STATEMENT_RETURN);
+  eat(parser, TOKEN_ID); // ret
+
+  // A ret with nothing after it gives back void
+  if (parser->currentToken->type != TOKEN_SEMI && parser->currentToken->type != TOKEN_RBRACE && parser->currentToken->type != TOKEN_EOF)
+    ret->returnVal = parseExpr(parser, scope, 1)->index;
+
+  ret->scope = scope;
+
+  return ret;
+}
+
+// The statements between { and }, which get a block scope of their own
+static AST_T* parseBlock(parser_T* parser, scope_T* scope) {
+  eat(parser, TOKEN_LBRACE); // {
+  enterNested(parser);
+  AST_T* block = parseStatements(parser, initBlockScope(scope));
+  eat(parser, TOKEN_RBRACE); // }
+  parser->depth -= 1;
+
+  return block;
+}
+
+AST_T* parseIf(parser_T* parser, scope_T* scope) {
+  AST_T* ifNode = initAST(AST_IF);
+  eat(parser, TOKEN_ID); // if
+  enterNested(parser);
+
+  eat(parser, TOKEN_LPAREN); // (
+  ifNode->ifCondition = parseExpr(parser, scope, 1)->index;
+  eat(parser, TOKEN_RPAREN); // )
+
+  ifNode->ifBody = parseBlock(parser, scope)->index;
+
+  if (parser->currentToken->type == TOKEN_ID && parser->currentToken->symbol == SYMBOL_ELSE) {
+    eat(parser, TOKEN_ID); // else
+
+    // else if is an if that is the whole else
+    if (parser->currentToken->type == TOKEN_ID && parser->currentToken->symbol == SYMBOL_IF)
+      ifNode->ifElse = parseIf(parser, scope)->index;
+    else
+      ifNode->ifElse = parseBlock(parser, scope)->index;
+  }
+
+  ifNode->scope = scope;
+  parser->depth -= 1;
+
+  return ifNode;
 }
 
 AST_T* parseVar(parser_T* parser, scope_T* scope) {
   // Parse a variable and create an AST node with the variable name as the value
-  char* tokenVal = (char*) parser->currentToken->val;
+  symbol_T symbol = parser->currentToken->symbol;
   eat(parser, TOKEN_ID); // variable name
-
-  // If a variable has a number attached to it (e.g. var1, var2, var3, etc.)
-  if (parser->currentToken->type == TOKEN_INT) {
-    char* buff = (char*) malloc(strlen(tokenVal) + 1);
-    sprintf(buff, "%ld", (intptr_t) parser->currentToken->val);
-    strcat(tokenVal, buff);
-    eat(parser, TOKEN_INT);
-  }
   
   // Parse function arguments
   if (parser->currentToken->type == TOKEN_LPAREN)
@@ -341,7 +406,7 @@ AST_T* parseVar(parser_T* parser, scope_T* scope) {
   
   // Create the AST node with its values
   AST_T* var = initAST(AST_VARIABLE);
-  var->varName = tokenVal;
+  var->varSymbol = symbol;
   var->scope = scope; // Add it to the scope
 
   return var;
@@ -350,34 +415,10 @@ AST_T* parseVar(parser_T* parser, scope_T* scope) {
 AST_T* parseString(parser_T* parser, scope_T* scope) {
   // Parse a string and create an AST node with the string as the value
   AST_T* string = initAST(STRING);
-  string->stringVal = parser->currentToken->val;
+  string->stringVal = tokenToString(parser->currentToken); // The token only points into the source, so the string gets its own copy
   
   eat(parser, TOKEN_STRING);
 
-  while (parser->currentToken->type == TOKEN_PLUS) {
-    eat(parser, TOKEN_PLUS);
-    switch (parser->currentToken->type) {
-      case TOKEN_STRING:
-        string->stringVal = strcat(string->stringVal, (char*) parser->currentToken->val);
-        eat(parser, TOKEN_STRING);
-        break;
-
-      case TOKEN_ID:
-        if (!scopeGetVarDef(scope, (char*) parser->currentToken->val)) {
-          printf("Variable to concatenate does not exist.\n");
-          exit(1);
-        }
-
-        string->stringVal = strcat(string->stringVal, (char*) scopeGetVarDef(scope, parser->currentToken->val)->varDefVal->stringVal);
-        eat(parser, TOKEN_ID);
-        break;
-        
-      default:
-        printf("Concantinating non-string types with strings is currently unsupported.\n");
-        exit(1);
-    }
-  }
-
   string->scope = scope;
 
   return string;
@@ -387,12 +428,12 @@ AST_T* parseBool(parser_T* parser, scope_T* scope) {
   // Parse a boolean and create an AST node with the boolean as the value
   AST_T* boolean = initAST(BOOL);
 
-  if (strcmp(parser->currentToken->val, "false") == 0)
+  if (parser->currentToken->symbol == SYMBOL_FALSE)
     boolean->boolVal = false;
-  else if (strcmp(parser->currentToken->val, "true") == 0)
+  else if (parser->currentToken->symbol == SYMBOL_TRUE)
     boolean->boolVal = true;
   else {
-    printf("Expected a boolean, but got `%s` with type %d\n", (char*) parser->currentToken->val, parser->currentToken->type);
+    printf("Expected a boolean, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type);
     exit(1);
   }
   
@@ -407,7 +448,7 @@ AST_T* parseBool(parser_T* parser, scope_T* scope) {
 AST_T* parseChar(parser_T* parser, scope_T* scope) {
   // Parse a character and create an AST node with the character as the value
   AST_T* character = initAST(CHAR);
-  character->charVal = *(char*) parser->currentToken->val;
+  character->charVal = parser->currentToken->val[0];
   
   // Move past the character
   eat(parser, TOKEN_CHAR);
@@ -418,84 +459,197 @@ AST_T* parseChar(parser_T* parser, scope_T* scope) {
 }
 
 
-AST_T* parseIntExpr(parser_T* parser, scope_T* scope) {
-  list_T* numList = initList();
-  list_T* opList = initList();
+// How tightly an operator binds, 0 means the token isn't an operator
+static int getPrecedence(int tokenType) {
+  switch (tokenType) {
+    case TOKEN_EQ:
+    case TOKEN_NOT_EQ:
+    case TOKEN_LESS:
+    case TOKEN_LESS_EQ:
+    case TOKEN_GREATER:
+    case TOKEN_GREATER_EQ: return 1; break;
+    case TOKEN_PLUS:
+    case TOKEN_MINUS: return 2; break;
+    case TOKEN_MULTIPLY:
+    case TOKEN_DIVIDE:
+    case TOKEN_MODULO: return 3; break;
+    case TOKEN_POW: return 5; break;
+    default: return 0; break;
+  }
+}
+
+#define UNARY_PRECEDENCE 4 // A sign binds tighter than * but looser than ^, so -2^2 is -(2^2)
+
+static AST_T* initInt(long value, scope_T* scope) {
+  AST_T* num = initAST(INT);
+  num->intVal = value;
+  num->scope = scope;
+
+  return num;
+}
+
+static AST_T* initBinop(int operator, AST_T* left, AST_T* right, scope_T* scope) {
+  AST_T* binop = initAST(AST_BINOP);
+  binop->binopOperator = operator;
+  binop->binopLeft = left->index;
+  binop->binopRight = right->index;
+  binop->scope = scope;
+
+  return binop;
+}
+
+// The value of a few digits of a number, which fit in a long
+static long digitsValue(const char* digits, size_t length) {
+  long value = 0;
+  for (size_t i = 0; i < length; i++)
+    value = value * 10 + (digits[i] - '0');
+
+  return value;
+}
+
+// A number too big for a long becomes the arithmetic that makes it out of longs, since ints grow into big ints.
+// 12345678901234567890123 is 12345 * 10^18 + 678901234567890123
+static AST_T* parseBigInt(parser_T* parser, scope_T* scope) {
+  const char* digits = parser->currentToken->val;
+  size_t length = parser->currentToken->length;
+
+  size_t first = length % PARSER_BIG_INT_DIGITS ? length % PARSER_BIG_INT_DIGITS : PARSER_BIG_INT_DIGITS;
+  AST_T* num = initInt(digitsValue(digits, first), scope);
+  for (size_t i = first; i < length; i += PARSER_BIG_INT_DIGITS) {
+    AST_T* shifted = initBinop(TOKEN_MULTIPLY, num, initInt(PARSER_BIG_INT_BASE, scope), scope);
+    num = initBinop(TOKEN_PLUS, shifted, initInt(digitsValue(digits + i, PARSER_BIG_INT_DIGITS), scope), scope);
+  }
+
+  eat(parser, TOKEN_INT);
+  return num;
+}
 
-  // Check if the first number is positive or negative and assign the value accordingly
+static AST_T* parseOperand(parser_T* parser, scope_T* scope) {
+  // Parse the value an operator works on. Signs and parentheses around it are left to parseExpr
   switch (parser->currentToken->type) {
-    case TOKEN_MINUS:
-      eat(parser, TOKEN_MINUS);
-      push(&numList, -1 * (intptr_t) parser->currentToken->val);
-      break;
-    case TOKEN_PLUS:
-      eat(parser, TOKEN_PLUS);
-    default:
-      push(&numList, (intptr_t) parser->currentToken->val);
+    case TOKEN_INT: {
+      if (parser->currentToken->isBigInt)
+        return parseBigInt(parser, scope);
+
+      AST_T* num = initInt(parser->currentToken->intVal, scope);
       eat(parser, TOKEN_INT);
+      return num;
+    }
+
+    case TOKEN_STRING: return parseString(parser, scope); break;
+
+    case TOKEN_CHAR: return parseChar(parser, scope); break;
+
+    case TOKEN_ID:
+      if (parser->currentToken->symbol == SYMBOL_TRUE || parser->currentToken->symbol == SYMBOL_FALSE)
+        return parseBool(parser, scope);
+      return parseVar(parser, scope);
       break;
+
+    default:
+      printf("Expected a value, but got `%.*s` with type %d\n", (int) parser->currentToken->length, parser->currentToken->val, parser->currentToken->type);
+      exit(1);
   }
+}
 
+static void pushOperator(parser_T* parser, int type, int precedence, bool unary) {
+  if (parser->operatorsSize == parser->operatorsCapacity) {
+    size_t capacity = parser->operatorsCapacity ? parser->operatorsCapacity * 2 : 64;
+    parser->operators = arenaGrow(programArena, parser->operators, parser->operatorsCapacity * sizeof(parserOperator_T), capacity * sizeof(parserOperator_T));
+    parser->operatorsCapacity = capacity;
+  }
 
-  // Check if there are more operations to perform on the number
-  bool keepRepeat = true;
-  while (keepRepeat) {
-    switch (parser->currentToken->type) {
-      // If the token is a valid operation token, push it to the operation list and push the number to the number list
-      case TOKEN_PLUS:
-      case TOKEN_MINUS:
-      case TOKEN_MULTIPLY:
-      case TOKEN_DIVIDE:
-      case TOKEN_POW:
-      case TOKEN_MODULO:
-        push(&opList, parser->currentToken->type);
-        eat(parser, parser->currentToken->type);
-        
-        if (parser->currentToken->type == TOKEN_ID) {
-          if (!scopeGetVarDef(scope, (char*) parser->currentToken->val)) {
-            printf("Variable to perform operation on does not exist.\n");
-            exit(1);
-          }
-
-          push(&numList, (intptr_t) scopeGetVarDef(scope, parser->currentToken->val)->varDefVal->intVal);
-          eat(parser, TOKEN_ID);
-        }
-        else {
-          push(&numList, (intptr_t) parser->currentToken->val);
-          eat(parser, TOKEN_INT);
-        }
-        break;
+  parser->operators[parser->operatorsSize].type = type;
+  parser->operators[parser->operatorsSize].precedence = precedence;
+  parser->operators[parser->operatorsSize].unary = unary;
+  parser->operatorsSize += 1;
+}
 
-      default:
-        keepRepeat = false;
-        break;
-    }    
+// Pop the operator on top and the operands it takes, and push the node they make
+static void reduceOperator(parser_T* parser, scope_T* scope) {
+  parserOperator_T operator = parser->operators[--parser->operatorsSize];
+  AST_T* right = astGet(parser->scratch[--parser->scratchSize]);
+
+  if (operator.unary && operator.type == TOKEN_PLUS) {
+    pushScratch(parser, right);
+    return;
   }
 
-  // Initialize the AST node with the integer value
-  AST_T* num = initAST(INT);
+  // A negative number is just a number
+  if (operator.unary && right->type == INT) {
+    right->intVal = -right->intVal;
+    pushScratch(parser, right);
+    return;
+  }
 
-  // Evaluate the expression and assign the value to the AST node
-  num->intVal = eval(&opList, &numList);
+  // Any other negation becomes 0 - operand
+  AST_T* left = operator.unary ? initInt(0, scope) : astGet(parser->scratch[--parser->scratchSize]);
+  pushScratch(parser, initBinop(operator.type, left, right, scope));
+}
 
-  num->scope = scope;
+AST_T* parseExpr(parser_T* parser, scope_T* scope, int minPrecedence) {
+  // Parse an expression by operator precedence, only taking operators that bind at least as tightly as minPrecedence.
+  // Operands wait on the scratch stack and operators on their own stack, so nesting never recurses
+  size_t operatorsMark = parser->operatorsSize;
+  size_t openParens = 0;
+
+  for (;;) {
+    // Signs and open parentheses come before an operand
+    int type = parser->currentToken->type;
+    if (type == TOKEN_PLUS || type == TOKEN_MINUS || type == TOKEN_LPAREN) {
+      eat(parser, type);
+      pushOperator(parser, type, type == TOKEN_LPAREN ? 0 : UNARY_PRECEDENCE, type != TOKEN_LPAREN);
+      openParens += type == TOKEN_LPAREN;
+      continue;
+    }
 
-  return num;
+    pushScratch(parser, parseOperand(parser, scope));
+
+    // Close the parentheses that end after the operand, a ) without an open one ends the expression
+    while (openParens && parser->currentToken->type == TOKEN_RPAREN) {
+      while (parser->operators[parser->operatorsSize - 1].type != TOKEN_LPAREN)
+        reduceOperator(parser, scope);
+
+      parser->operatorsSize -= 1;
+      openParens -= 1;
+      eat(parser, TOKEN_RPAREN);
+    }
+
+    int operator = parser->currentToken->type;
+    int precedence = getPrecedence(operator);
+    if (!precedence || (!openParens && precedence < minPrecedence))
+      break;
+
+    // What binds at least as tightly is done first. ^ is right associative, so another ^ waits for its right side
+    while (parser->operatorsSize > operatorsMark) {
+      parserOperator_T* top = &parser->operators[parser->operatorsSize - 1];
+      if (top->precedence < precedence || (top->precedence == precedence && operator == TOKEN_POW))
+        break;
+      reduceOperator(parser, scope);
+    }
+
+    eat(parser, operator);
+    pushOperator(parser, operator, precedence, false);
+  }
+
+  // An open parenthesis needs its )
+  if (openParens)
+    eat(parser, TOKEN_RPAREN);
+
+  while (parser->operatorsSize > operatorsMark)
+    reduceOperator(parser, scope);
+
+  return astGet(parser->scratch[--parser->scratchSize]);
 }
 
 AST_T* parseID(parser_T* parser, scope_T* scope) {
   // Check the current identifier and parse accordingly
-  if (strcmp(parser->currentToken->val, "let") == 0)
-    return parseVarDef(parser, scope);
-  
-  if (strcmp(parser->currentToken->val, "func") == 0)
-    return parseFuncDef(parser, scope);
-  
-  if (strcmp(parser->currentToken->val, "rnew") == 0)
-    return parseNewVarDef(parser, scope);
-
-  if (strcmp(parser->currentToken->val, "true") == 0 || strcmp(parser->currentToken->val, "false") == 0)
-    return parseBool(parser, scope);
-  
-  return parseVar(parser, scope);
+  switch (parser->currentToken->symbol) {
+    case SYMBOL_LET: return parseVarDef(parser, scope); break;
+    case SYMBOL_FUNC: return parseFuncDef(parser, scope); break;
+    case SYMBOL_RNEW: return parseNewVarDef(parser, scope); break;
+    case SYMBOL_RET: return parseReturn(parser, scope); break;
+    case SYMBOL_IF: return parseIf(parser, scope); break;
+    default: return parseExpr(parser, scope, 1); break; // Values, true and false included, can be compared
+  }
 }
\ No newline at end of file
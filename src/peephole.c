@@ -0,0 +1,170 @@
+#include "include/peephole.h"
+#include "include/arena.h"
+
+static const uint8_t* code; // The code before the peephole stage
+static size_t codeSize;
+
+static loadInfo_T* loads; // The loads before the peephole stage
+static size_t loadsSize;
+static size_t nextLoad; // The first load that hasn't been moved yet
+
+static bool* jumpTargets; // Which offsets of the old code a jump goes to
+static uint32_t* newOffsets; // Where each instruction of the old code starts in the new code, only kept when there are jumps
+
+static size_t* jumpOperands; // Where the operands of the jumps are in the new code, still holding old offsets
+static size_t jumpOperandsSize;
+
+// Whether the instruction at an offset is the opcode
+static bool isOp(size_t offset, opcode_T op) {
+  return offset < codeSize && code[offset] == op;
+}
+
+// Whether the instruction at an offset is the opcode and can be fused with the ones before it.
+// A jump target starts a new basic block, and a sequence that runs into it can't become one instruction
+static bool continuesWith(size_t offset, opcode_T op) {
+  return isOp(offset, op) && !jumpTargets[offset];
+}
+
+static bool isJump(opcode_T op) {
+  return op == OP_JUMP || op == OP_JUMP_IF_FALSE || op == OP_JUMP_IF_NOT;
+}
+
+// The offset of the instruction after the one at an offset
+static size_t nextInstruction(size_t offset) {
+  return offset + 1 + opcodeOperands[code[offset]] * sizeof(uint32_t);
+}
+
+static uint32_t operand(size_t offset, size_t which) {
+  return readOperand(code + offset + 1 + which * sizeof(uint32_t));
+}
+
+// Move the name of a load to where it ends up in the new code
+static void moveLoad(chunk_T* chunk, size_t oldOffset, size_t newOffset) {
+  while (nextLoad < loadsSize && loads[nextLoad].offset < oldOffset)
+    nextLoad += 1;
+
+  if (nextLoad < loadsSize && loads[nextLoad].offset == oldOffset)
+    chunkAddLoad(chunk, newOffset, loads[nextLoad].symbol);
+}
+
+static void emitWithOperands(chunk_T* chunk, opcode_T op, uint32_t first, uint32_t second, uint32_t third) {
+  chunkWriteByte(chunk, op);
+
+  uint32_t operands[3] = { first, second, third };
+  for (size_t i = 0; i < opcodeOperands[op]; i++)
+    chunkWriteOperand(chunk, operands[i]);
+}
+
+void peephole(chunk_T* chunk) {
+  // The new code is written into the chunk from scratch, reading from the old one
+  code = chunk->code;
+  codeSize = chunk->codeSize;
+  loads = chunk->loads;
+  loadsSize = chunk->loadsSize;
+  nextLoad = 0;
+
+  chunk->code = (void*) 0;
+  chunk->codeSize = 0;
+  chunk->codeCapacity = 0;
+  chunk->loads = (void*) 0;
+  chunk->loadsSize = 0;
+
+  // Find where the jumps go first
+  jumpTargets = programAlloc((codeSize + 1) * sizeof(bool));
+  newOffsets = (void*) 0;
+  jumpOperands = (void*) 0;
+  jumpOperandsSize = 0;
+
+  for (size_t offset = 0; offset < codeSize; offset = nextInstruction(offset)) {
+    if (isJump(code[offset])) {
+      jumpTargets[operand(offset, 0)] = true;
+
+      // Code without jumps doesn't need to know where anything moved
+      if (!newOffsets)
+        newOffsets = programAlloc((codeSize + 1) * sizeof(uint32_t));
+    }
+  }
+
+  // Functions start in the same order as in the old code
+  size_t function = 0;
+
+  size_t offset = 0;
+  while (offset < codeSize) {
+    // A function that started here starts at the same instruction in the new code.
+    // A function always ends with RETURN or HALT, which are never fused, so no sequence spans two functions
+    while (function < chunk->functionsSize && chunk->functions[function].entry == offset) {
+      chunk->functions[function].entry = chunk->codeSize;
+      function += 1;
+    }
+
+    size_t newOffset = chunk->codeSize;
+    size_t second = nextInstruction(offset);
+    if (newOffsets)
+      newOffsets[offset] = newOffset;
+
+    if (isOp(offset, OP_LOAD) && continuesWith(second, OP_CONST)) {
+      size_t third = nextInstruction(second);
+      moveLoad(chunk, offset, newOffset);
+
+      // Adding ints the type checker knows of is the same sum
+      if (continuesWith(third, OP_ADD) || continuesWith(third, OP_ADD_INT)) {
+        size_t fourth = nextInstruction(third);
+
+        // x = y + constant
+        if (continuesWith(fourth, OP_STORE)) {
+          emitWithOperands(chunk, OP_LOAD_CONST_ADD_STORE, operand(offset, 0), operand(second, 0), operand(fourth, 0));
+          offset = nextInstruction(fourth);
+          continue;
+        }
+
+        // y + constant
+        emitWithOperands(chunk, OP_LOAD_CONST_ADD, operand(offset, 0), operand(second, 0), 0);
+        offset = fourth;
+        continue;
+      }
+
+      emitWithOperands(chunk, OP_LOAD_CONST, operand(offset, 0), operand(second, 0), 0);
+      offset = third;
+      continue;
+    }
+
+    // Two loads in a row, the second one's name goes right after the opcode, where no instruction can start
+    if (isOp(offset, OP_LOAD) && continuesWith(second, OP_LOAD)) {
+      moveLoad(chunk, offset, newOffset);
+      moveLoad(chunk, second, newOffset + 1);
+      emitWithOperands(chunk, OP_LOAD_LOAD, operand(offset, 0), operand(second, 0), 0);
+      offset = nextInstruction(second);
+      continue;
+    }
+
+    // A built-in function whose result isn't used, like print
+    if (isOp(offset, OP_CALL_NATIVE) && continuesWith(second, OP_POP)) {
+      emitWithOperands(chunk, OP_CALL_NATIVE_POP, operand(offset, 0), operand(offset, 1), 0);
+      offset = nextInstruction(second);
+      continue;
+    }
+
+    // A jump's target moves too, so its operand is fixed once the new code is done
+    if (isJump(code[offset])) {
+      jumpOperands = arenaGrowArray(programArena, jumpOperands, jumpOperandsSize, sizeof(size_t));
+      jumpOperands[jumpOperandsSize++] = newOffset + 1;
+    }
+
+    // Anything else is copied as it is
+    moveLoad(chunk, offset, newOffset);
+    for (size_t i = offset; i < second; i++)
+      chunkWriteByte(chunk, code[i]);
+    offset = second;
+  }
+
+  if (!newOffsets)
+    return;
+
+  // A jump to the end of the code goes to the end of the new code
+  newOffsets[codeSize] = chunk->codeSize;
+
+  for (size_t i = 0; i < jumpOperandsSize; i++) {
+    uint32_t target = newOffsets[readOperand(chunk->code + jumpOperands[i])];
+    memcpy(chunk->code + jumpOperands[i], &target, sizeof(uint32_t));
+  }
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include "include/resolver.h"
+#include "include/scope.h"
+#include "include/builtins.h"
+#include "include/arena.h"
+
+// The nodes waiting to be resolved. The tree is walked with this stack instead of recursion, since expressions can be very deep
+static astIndex_T* pending;
+static size_t pendingSize;
+static size_t pendingCapacity;
+
+static void pushPending(astIndex_T index) {
+  if (pendingSize == pendingCapacity) {
+    size_t capacity = pendingCapacity ? pendingCapacity * 2 : 64;
+    pending = arenaGrow(programArena, pending, pendingCapacity * sizeof(astIndex_T), capacity * sizeof(astIndex_T));
+    pendingCapacity = capacity;
+  }
+
+  pending[pendingSize++] = index;
+}
+
+// Push a list backwards, so its first item is resolved first and errors come out in the order they were written
+static void pushPendingList(astIndex_T list, size_t size) {
+  for (size_t i = size; i > 0; i--)
+    pushPending(astGetList(list)[i - 1]);
+}
+
+static void resolveVar(AST_T* node) {
+  AST_T* varDef = scopeGetVarDef(node->scope, node->varSymbol);
+
+  // If the variable definition is not found, send an error
+  if (!varDef) {
+    printf("Variable `%s` not found.\n", symbolName(node->varSymbol));
+    exit(1);
+  }
+
+  node->varDef = varDef->index;
+  node->varDepth = node->scope->depth - varDef->scope->depth;
+  node->varSlot = varDef->type == AST_VARIABLE_DEFINITION ? varDef->varDefSlot : varDef->varSlot;
+}
+
+static void resolveFuncCall(AST_T* node) {
+  // Built-in functions are called without a definition, the engines call them through the registry
+  uint32_t native = findNative(node->funcCallSymbol);
+  if (native != NATIVE_NONE) {
+    native_T* entry = &natives[native];
+    if ((int) node->funcCallArgsSize < entry->minArgs || (entry->maxArgs != NATIVE_VARIADIC && (int) node->funcCallArgsSize > entry->maxArgs)) {
+      printf("Invalid amount of arguments passed into function `%s`\n", symbolName(node->funcCallSymbol));
+      exit(1);
+    }
+
+    node->isNativeCall = true;
+    node->funcCallNative = native;
+    return;
+  }
+
+  AST_T* funcDef = scopeGetFuncDef(node->scope, node->funcCallSymbol);
+
+  if (!funcDef) {
+    printf("Undefined function `%s`\n", symbolName(node->funcCallSymbol));
+    exit(1);
+  }
+
+  if (node->funcCallArgsSize != funcDef->funcDefArgsSize) {
+    printf("Invalid amount of arguments passed into function `%s`\n", symbolName(node->funcCallSymbol));
+    exit(1);
+  }
+
+  node->funcCallDef = funcDef->index;
+}
+
+static void resolveReturn(AST_T* node) {
+  // Only the global scope has no frame around it
+  if (node->scope->depth == 0) {
+    printf("`ret` can only be used inside a function.\n");
+    exit(1);
+  }
+
+  if (!node->returnVal)
+    return;
+
+  // A call whose result is given straight back doesn't need its caller's frame anymore
+  AST_T* value = astGet(node->returnVal);
+  if (value->type == AST_FUNCTION_CALL)
+    value->isTailCall = true;
+
+  pushPending(node->returnVal);
+}
+
+void resolve(AST_T* node) {
+  size_t base = pendingSize;
+  pushPending(node->index);
+
+  while (pendingSize > base) {
+    AST_T* current = astGet(pending[--pendingSize]);
+
+    // Check the type of the node and resolve accordingly
+    switch (current->type) {
+      case AST_COMPOUND: pushPendingList(current->compoundVal, current->compoundSize); break;
+      case AST_VARIABLE_DEFINITION: pushPending(current->varDefVal); break;
+      case AST_FUNCTION_DEFINITION: pushPending(current->funcDefBody); break; // The arguments are definitions, not uses
+      case AST_VARIABLE: resolveVar(current); break;
+
+      case AST_FUNCTION_CALL:
+        resolveFuncCall(current);
+        pushPendingList(current->funcCallArgs, current->funcCallArgsSize);
+        break;
+
+      case AST_BINOP:
+        pushPending(current->binopRight);
+        pushPending(current->binopLeft);
+        break;
+
+      case AST_STATEMENT_RETURN: resolveReturn(current); break;
+
+      case AST_IF:
+        if (current->ifElse)
+          pushPending(current->ifElse);
+        pushPending(current->ifBody);
+        pushPending(current->ifCondition);
+        break;
+
+      default: break;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "include/runtime.h"
+#include "include/str.h"
+#include "include/symbol.h"
+#include "include/output.h"
+
+value_T* runtimeStack;
+value_T* runtimeTop;
+size_t runtimeBudget;
+char* runtimeNativeBase;
+char* runtimeNativeLimit;
+
+// Reserve memory the system only hands out once it is touched
+static void* reserve(size_t size) {
+  void* memory = mmap((void*) 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    printf("Out of memory.\n");
+    exit(1);
+  }
+
+  return memory;
+}
+
+void initRuntime(size_t budget) {
+  // The output is flushed however the program ends, the same way the interpreter does it
+  initOutput();
+  initBuiltins();
+
+  runtimeBudget = budget;
+  runtimeStack = reserve(budget);
+  runtimeTop = runtimeStack;
+}
+
+// A string literal of the program, made once when it starts and never collected
+value_T runtimeString(const char* chars, size_t length) {
+  value_T string = valueFromString(chars, length);
+  pinValue(string);
+
+  return string;
+}
+
+// An int literal too big for the word
+value_T runtimeInt(long value) {
+  value_T number = valueFromInt(value);
+  pinValue(number);
+
+  return number;
+}
+
+uint32_t runtimeNative(const char* name) {
+  return findNative(internSymbol(name, strlen(name)));
+}
+
+static void* runThread(void* program) {
+  ((void (*)()) program)();
+  return (void*) 0;
+}
+
+// Run the program on a thread whose C stack holds the budget and the reserve, and end the process when it is done
+void runProgram(void (*program)()) {
+  size_t nativeSize = runtimeBudget + RUNTIME_STACK_RESERVE;
+  char* nativeStack = reserve(nativeSize);
+  runtimeNativeBase = nativeStack + nativeSize;
+  runtimeNativeLimit = nativeStack + RUNTIME_STACK_RESERVE;
+
+  pthread_attr_t attributes;
+  pthread_t thread;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstack(&attributes, nativeStack, nativeSize);
+  if (pthread_create(&thread, &attributes, runThread, (void*) program) != 0) {
+    printf("The program's thread couldn't be started.\n");
+    exit(1);
+  }
+  pthread_join(thread, (void*) 0);
+
+  flushOutput();
+  exit(0);
+}
+
+// Every value the program works with is in a frame on the value stack
+void runtimeCollect() {
+  gcRoots_T roots = { runtimeStack, (size_t) (runtimeTop - runtimeStack) };
+  collectGarbage(&roots, 1);
+}
+
+void runtimeStackOverflow() {
+  printf("Stack overflow.\n");
+  exit(1);
+}
+
+void runtimeLoadError(const char* name) {
+  printf("Variable `%s` is used before it has a value.\n", name);
+  exit(1);
+}
+
+void runtimeConditionError() {
+  printf("Error: The condition of an if has to be a bool.\n");
+  exit(1);
+}
\ No newline at end of file
@@ -1,85 +1,126 @@
 #include <string.h>
 #include <stdio.h>
 #include "include/scope.h"
+#include "include/arena.h"
 
-scope_T* initScope() {
-  scope_T* scope = calloc(1, sizeof(struct SCOPE_STRUCT)); // Allocate memory for the scope
+scope_T* initScope(scope_T* parent) {
+  scope_T* scope = programAlloc(sizeof(struct SCOPE_STRUCT)); // Allocate memory for the scope
+  scope->parent = parent;
+  scope->owner = scope;
+  scope->depth = parent ? parent->depth + 1 : 0;
 
   return scope;
 }
 
-AST_T* scopeAddVarDef(scope_T* scope, AST_T* varDef) {
-  // Increase the size of the variable definitions
-  scope->varDefsSize += 1;
+// A block, like the body of an if, has names of its own but keeps its values in the frame of the scope around it
+scope_T* initBlockScope(scope_T* parent) {
+  scope_T* scope = programAlloc(sizeof(struct SCOPE_STRUCT));
+  scope->parent = parent;
+  scope->owner = parent->owner;
+  scope->depth = parent->depth;
 
-  // If there are no variable definitions, allocate memory for the first one
-  if (scope->varDefs == (void*) 0) {
-    scope->varDefs = calloc(1, sizeof(struct AST_STRUCT*));
-    scope->varDefs[0] = varDef;
-  }
+  return scope;
+}
+
+// Where a symbol starts probing. Symbols are small consecutive numbers, so they are spread out
+// over the table by multiplying with 2^32 / phi and keeping the top bits
+static size_t tableSlot(scopeTable_T* table, symbol_T symbol) {
+  return (size_t) ((uint32_t) (symbol * 2654435769u) >> 8) & (table->capacity - 1);
+}
+
+// Find the slot holding a symbol, or the empty slot where it would go
+static scopeEntry_T* tableFind(scopeTable_T* table, symbol_T symbol) {
+  size_t slot = tableSlot(table, symbol);
+  while (table->entries[slot].symbol != SYMBOL_NONE && table->entries[slot].symbol != symbol)
+    slot = (slot + 1) & (table->capacity - 1);
 
-  // Otherwise, reallocate memory for the variable definitions
-  else {
-    scope->varDefs = realloc(
-      scope->varDefs, 
-      scope->varDefsSize * sizeof(struct AST_STRUCT*)
-    );
+  return &table->entries[slot];
+}
+
+static void growTable(scopeTable_T* table) {
+  // Double the table and put every definition back into it
+  // The old entries stay in the program's arena until the program ends
+  scopeEntry_T* entries = table->entries;
+  size_t capacity = table->capacity;
 
-    // Append the new variable definition to the end of the list
-    scope->varDefs[scope->varDefsSize - 1] = varDef;
+  table->capacity = capacity ? capacity * 2 : 16;
+  table->entries = programAlloc(table->capacity * sizeof(scopeEntry_T));
+
+  for (size_t i = 0; i < capacity; i++) {
+    if (entries[i].symbol != SYMBOL_NONE)
+      *tableFind(table, entries[i].symbol) = entries[i];
   }
+}
+
+static void tableAdd(scopeTable_T* table, symbol_T symbol, AST_T* def) {
+  // Keep the table at most half full
+  if ((table->size + 1) * 2 > table->capacity)
+    growTable(table);
+
+  // The first definition of a name is the one that is found, so a later one with the same name is never visible
+  scopeEntry_T* entry = tableFind(table, symbol);
+  if (entry->symbol != SYMBOL_NONE)
+    return;
+
+  entry->symbol = symbol;
+  entry->def = def->index;
+  table->size += 1;
+}
+
+static AST_T* tableGet(scopeTable_T* table, symbol_T symbol) {
+  if (table->size == 0)
+    return (void*) 0;
+
+  scopeEntry_T* entry = tableFind(table, symbol);
+  if (entry->symbol == SYMBOL_NONE)
+    return (void*) 0;
+
+  return astGet(entry->def);
+}
+
+AST_T* scopeAddVarDef(scope_T* scope, AST_T* varDef) {
+  // Every definition gets a slot in the scope's frame, even one whose name is already taken
+  varDef->varDefSlot = scope->owner->slotsSize++;
+  tableAdd(&scope->varDefs, varDef->varDefSymbol, varDef);
 
   return varDef;
 }
 
-AST_T* scopeGetVarDef(scope_T* scope, const char* varDefName) {
-  // Go through all the variable definitions in the scope
-  for (size_t i = 0; i < scope->varDefsSize; i++) {
-    AST_T* varDef = scope->varDefs[i];
+AST_T* scopeAddArgument(scope_T* scope, AST_T* arg) {
+  // Arguments take the first slots of the frame, in the order they are passed
+  arg->varSlot = scope->slotsSize++;
+  tableAdd(&scope->varDefs, arg->varSymbol, arg);
 
-    // If the name matches the name of a variable definition, return it
-    if (strcmp(varDef->varDefVarName, varDefName) == 0)
+  return arg;
+}
+
+AST_T* scopeGetVarDef(scope_T* scope, symbol_T varDefSymbol) {
+  // Look in the scope, then in the scopes around it
+  for (; scope; scope = scope->parent) {
+    AST_T* varDef = tableGet(&scope->varDefs, varDefSymbol);
+    if (varDef)
       return varDef;
   }
 
-  // Otherwise, return null
+  // Returns null if there is no variable with the symbol
   return (void*) 0;
 }
 
 AST_T* scopeAddFuncDef(scope_T* scope, AST_T* funcDef) {
-  // Increase the size of the function definitions
-  scope->funcDefsSize += 1;
-
-  // If there are no function definitions, allocate memory for the first one
-  if (scope->funcDefs == (void*) 0) {
-    scope->funcDefs = calloc(1, sizeof(struct AST_STRUCT*));
-    scope->funcDefs[0] = funcDef;
-  }
-  // Otherwise, reallocate memory for the function definitions
-  else {
-    scope->funcDefs = realloc(
-      scope->funcDefs,
-      scope->funcDefsSize * sizeof(struct AST_STRUCT*)
-    );
-
-    // Append the new function definition to the end of the list
-    scope->funcDefs[scope->funcDefsSize - 1] = funcDef;
-  }
+  tableAdd(&scope->funcDefs, funcDef->funcDefSymbol, funcDef);
 
   // Return the function definition
   return funcDef;
 }
 
-AST_T* scopeGetFuncDef(scope_T* scope, const char* funcName) {
-  // Go through all the function definitions in the scope
-  for (size_t i = 0; i < scope->funcDefsSize; i++) {
-    AST_T* funcDef = scope->funcDefs[i];
-
-    // If the name matches the name of a function definition, return it
-    if (strcmp(funcDef->funcDefName, funcName) == 0)
+AST_T* scopeGetFuncDef(scope_T* scope, symbol_T funcSymbol) {
+  // Look in the scope, then in the scopes around it
+  for (; scope; scope = scope->parent) {
+    AST_T* funcDef = tableGet(&scope->funcDefs, funcSymbol);
+    if (funcDef)
       return funcDef;
   }
 
-  // Otherwise, return null
+  // Returns null if there is no function with the symbol
   return (void*) 0;
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/str.h"
+#include "include/gc.h"
+
+static value_T shortString(const char* chars, size_t length) {
+  value_T string = VALUE_SHORT_STRING_TAG | (value_T) length << 5;
+  for (size_t i = 0; i < length; i++)
+    string |= (value_T) (unsigned char) chars[i] << (8 * (i + 1));
+
+  return string;
+}
+
+// A flat string whose characters are filled in by the caller
+static stringObject_T* allocString(size_t length) {
+  stringObject_T* string = allocObject(OBJECT_STRING, sizeof(struct STRING_OBJECT_STRUCT) + length + 1);
+  string->hash = 0;
+  string->length = length;
+  string->chars[length] = 0;
+
+  return string;
+}
+
+value_T valueFromString(const char* chars, size_t length) {
+  if (length <= STR_SHORT_MAX)
+    return shortString(chars, length);
+
+  stringObject_T* string = allocString(length);
+  memcpy(string->chars, chars, length);
+
+  return (value_T) (uintptr_t) string;
+}
+
+size_t strLength(value_T string) {
+  if (valueIsShortString(string))
+    return (string >> 5) & 7;
+
+  object_T* object = valueToObject(string);
+  return object->type == OBJECT_ROPE ? ((ropeObject_T*) object)->length : ((stringObject_T*) object)->length;
+}
+
+// Copy the characters of every string a rope joins into one flat string, which the rope keeps.
+// Ropes can be nested as deep as the number of joins, so the pieces still to copy are kept on a stack instead of recursing
+static stringObject_T* flattenRope(ropeObject_T* rope) {
+  if (rope->right == VALUE_UNSET)
+    return (stringObject_T*) valueToObject(rope->left);
+
+  stringObject_T* flat = allocString(rope->length);
+  char* to = flat->chars;
+
+  value_T* pending = (void*) 0; // The right sides that come after the piece being copied
+  size_t pendingSize = 0;
+  size_t pendingCapacity = 0;
+
+  value_T piece = (value_T) (uintptr_t) rope;
+  while (true) {
+    // Go down the left side first, the right one is copied after it
+    if (valueIsObject(piece) && valueToObject(piece)->type == OBJECT_ROPE && ((ropeObject_T*) valueToObject(piece))->right != VALUE_UNSET) {
+      if (pendingSize == pendingCapacity) {
+        pendingCapacity = pendingCapacity ? pendingCapacity * 2 : 64;
+        pending = realloc(pending, pendingCapacity * sizeof(value_T));
+        if (!pending) {
+          printf("Out of memory.\n");
+          exit(1);
+        }
+      }
+
+      ropeObject_T* inner = (ropeObject_T*) valueToObject(piece);
+      pending[pendingSize++] = inner->right;
+      piece = inner->left;
+      continue;
+    }
+
+    char shortChars[STR_SHORT_MAX + 1];
+    size_t length;
+    const char* chars = strChars(piece, shortChars, &length);
+    memcpy(to, chars, length);
+    to += length;
+
+    if (pendingSize == 0)
+      break;
+    piece = pending[--pendingSize];
+  }
+
+  free(pending);
+
+  // The pieces aren't needed by this rope anymore
+  rope->left = (value_T) (uintptr_t) flat;
+  rope->right = VALUE_UNSET;
+
+  return flat;
+}
+
+// The characters of a string, which don't end with a 0 for a short one. A short string's characters are
+// put in the buffer given, which has room for STR_SHORT_MAX + 1 bytes, and a rope is flattened first
+const char* strChars(value_T string, char* shortChars, size_t* length) {
+  if (valueIsShortString(string)) {
+    *length = (string >> 5) & 7;
+    for (size_t i = 0; i < *length; i++)
+      shortChars[i] = (char) (string >> (8 * (i + 1)));
+    return shortChars;
+  }
+
+  object_T* object = valueToObject(string);
+  stringObject_T* flat = object->type == OBJECT_ROPE ? flattenRope((ropeObject_T*) object) : (stringObject_T*) object;
+
+  *length = flat->length;
+  return flat->chars;
+}
+
+// FNV-1a over the characters. A flat string keeps its hash, with 0 kept for not worked out yet
+uint32_t strHash(value_T string) {
+  stringObject_T* flat = (void*) 0;
+  if (!valueIsShortString(string)) {
+    object_T* object = valueToObject(string);
+    flat = object->type == OBJECT_ROPE ? flattenRope((ropeObject_T*) object) : (stringObject_T*) object;
+    if (flat->hash)
+      return flat->hash;
+  }
+
+  char shortChars[STR_SHORT_MAX + 1];
+  size_t length;
+  const char* chars = strChars(string, shortChars, &length);
+
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char) chars[i];
+    hash *= 16777619u;
+  }
+
+  if (!hash)
+    hash = 1;
+  if (flat)
+    flat->hash = hash;
+
+  return hash;
+}
+
+value_T strJoin(value_T left, value_T right) {
+  size_t leftLength = strLength(left);
+  size_t rightLength = strLength(right);
+  size_t length = leftLength + rightLength;
+
+  if (leftLength == 0)
+    return right;
+  if (rightLength == 0)
+    return left;
+
+  // A short join is copied now. Neither side can be a rope, since a rope is never this short
+  if (length < STR_ROPE_MIN) {
+    char leftShort[STR_SHORT_MAX + 1];
+    char rightShort[STR_SHORT_MAX + 1];
+    const char* leftChars = strChars(left, leftShort, &leftLength);
+    const char* rightChars = strChars(right, rightShort, &rightLength);
+
+    char joined[STR_ROPE_MIN];
+    memcpy(joined, leftChars, leftLength);
+    memcpy(joined + leftLength, rightChars, rightLength);
+
+    return valueFromString(joined, length);
+  }
+
+  ropeObject_T* rope = allocObject(OBJECT_ROPE, sizeof(struct ROPE_OBJECT_STRUCT));
+  rope->length = length;
+  rope->left = left;
+  rope->right = right;
+
+  return (value_T) (uintptr_t) rope;
+}
+
+bool strEquals(value_T left, value_T right) {
+  // Every string short enough is held in the word, so short strings are equal exactly when their words are
+  if (left == right)
+    return true;
+  if (valueIsShortString(left) || valueIsShortString(right) || strLength(left) != strLength(right))
+    return false;
+
+  // The hashes are kept, so comparing the same strings again usually doesn't have to look at their characters
+  if (strHash(left) != strHash(right))
+    return false;
+
+  return strCompare(left, right) == 0;
+}
+
+// Put two strings in dictionary order, less than 0 when the left one comes first
+int strCompare(value_T left, value_T right) {
+  char leftShort[STR_SHORT_MAX + 1];
+  char rightShort[STR_SHORT_MAX + 1];
+  size_t leftLength;
+  size_t rightLength;
+  const char* leftChars = strChars(left, leftShort, &leftLength);
+  const char* rightChars = strChars(right, rightShort, &rightLength);
+
+  size_t length = leftLength < rightLength ? leftLength : rightLength;
+  int order = memcmp(leftChars, rightChars, length);
+  if (order)
+    return order;
+
+  return (leftLength > rightLength) - (leftLength < rightLength);
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "include/symbol.h"
+#include "include/arena.h"
+
+// The names of the reserved symbols, in the same order as their IDs
+static const char* reservedNames[SYMBOL_RESERVED_COUNT] = {
+  "", "let", "func", "rnew", "true", "false", "ret", "if", "else",
+  "int", "float", "char", "bool", "str", "any"
+};
+
+static char** names; // The name of every symbol, indexed by ID
+static size_t* nameLengths; // The length of every name, indexed by ID
+static size_t namesSize; // The amount of symbols
+static size_t namesCapacity; // The amount of symbols there is room for
+
+static symbol_T* table; // Open addressing hash table of IDs, 0 marks an empty slot
+static size_t tableCapacity; // Always a power of two
+
+static uint32_t hashName(const char* name, size_t length) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char) name[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static void growTable() {
+  // Double the table and put every symbol back into it
+  // The old table stays in the program's arena until the program ends
+  tableCapacity = tableCapacity ? tableCapacity * 2 : 256;
+  table = programAlloc(tableCapacity * sizeof(symbol_T));
+
+  for (symbol_T id = 1; id < namesSize; id++) {
+    size_t slot = hashName(names[id], nameLengths[id]) & (tableCapacity - 1);
+    while (table[slot])
+      slot = (slot + 1) & (tableCapacity - 1);
+    table[slot] = id;
+  }
+}
+
+static symbol_T addSymbol(const char* name, size_t length, size_t slot) {
+  // Make room for the new name
+  if (namesSize == namesCapacity) {
+    names = arenaGrow(programArena, names, namesCapacity * sizeof(char*), namesCapacity * 2 * sizeof(char*));
+    nameLengths = arenaGrow(programArena, nameLengths, namesCapacity * sizeof(size_t), namesCapacity * 2 * sizeof(size_t));
+    namesCapacity *= 2;
+  }
+
+  // Keep a null terminated copy of the name, since the caller's text may only be a view into the source
+  symbol_T id = namesSize++;
+  names[id] = arenaStrndup(programArena, name, length);
+  nameLengths[id] = length;
+  table[slot] = id;
+
+  // Keep the table at most half full
+  if (namesSize * 2 > tableCapacity)
+    growTable();
+
+  return id;
+}
+
+void initSymbols() {
+  if (namesSize)
+    return;
+
+  growTable();
+
+  // Slot 0 of the names belongs to SYMBOL_NONE, it never goes into the table
+  namesSize = 1;
+  namesCapacity = 64;
+  names = programAlloc(namesCapacity * sizeof(char*));
+  nameLengths = programAlloc(namesCapacity * sizeof(size_t));
+  names[0] = (char*) reservedNames[0];
+
+  // Intern the keywords and types so they get their reserved IDs
+  for (symbol_T id = 1; id < SYMBOL_RESERVED_COUNT; id++)
+    internSymbol(reservedNames[id], strlen(reservedNames[id]));
+}
+
+symbol_T internSymbol(const char* name, size_t length) {
+  if (!namesSize)
+    initSymbols();
+
+  // Look for the name, stopping at the first empty slot
+  size_t slot = hashName(name, length) & (tableCapacity - 1);
+  while (table[slot]) {
+    symbol_T id = table[slot];
+    if (nameLengths[id] == length && memcmp(names[id], name, length) == 0)
+      return id;
+    slot = (slot + 1) & (tableCapacity - 1);
+  }
+
+  // It's a new name
+  return addSymbol(name, length, slot);
+}
+
+const char* symbolName(symbol_T symbol) {
+  return names[symbol];
+}
\ No newline at end of file
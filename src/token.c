@@ -1,10 +1,37 @@
 #include <stdlib.h>
+#include <string.h>
 #include "include/token.h"
+#include "include/arena.h"
+
+// Tokens the parser is done with, ready to be handed out again
+static token_T* freeTokens[2];
+static size_t freeTokensSize;
+
+token_T* initToken(int type, const char* val, size_t length) {
+  token_T* token;
+
+  // Reuse a token the parser is done with, or take a new one from the arena
+  if (freeTokensSize) {
+    token = freeTokens[--freeTokensSize];
+    memset(token, 0, sizeof(struct TOKEN_STRUCT));
+  }
+  else
+    token = programAlloc(sizeof(struct TOKEN_STRUCT));
 
-token_T* initToken(int type, void* val) {
-  token_T* token = calloc(1, sizeof(struct TOKEN_STRUCT)); // Allocate memory for the token
   token->type = type; // Set the type of the token
-  token->val = val; // Set the value of the token
+  token->val = val; // Point the token at its text in the source buffer
+  token->length = length; // Set the length of the token's text
   
   return token;
+}
+
+void freeToken(token_T* token) {
+  // The parser only ever holds a couple of tokens, so only keep a couple around
+  if (freeTokensSize < 2)
+    freeTokens[freeTokensSize++] = token;
+}
+
+char* tokenToString(token_T* token) {
+  // Copy the token's text into its own null terminated string
+  return arenaStrndup(programArena, token->val, token->length);
 }
\ No newline at end of file
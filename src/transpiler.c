@@ -0,0 +1,604 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "include/transpiler.h"
+#include "include/typecheck.h"
+#include "include/scope.h"
+#include "include/value.h"
+#include "include/token.h"
+#include "include/builtins.h"
+#include "include/arena.h"
+
+// C code being written, which grows as it needs to
+typedef struct TEXT_STRUCT {
+  char* chars;
+  size_t size;
+  size_t capacity;
+} text_T;
+
+static text_T prototypesText; // A declaration of every function, so they can call each other in any order
+static text_T functionsText; // Every function written so far
+static text_T bodyText; // The body of the function being written, which goes after its locals once it is done
+static text_T startText; // What main does before the program runs
+
+static uint32_t level; // How many frames the function being written is nested in. Its own frame is frame<level>
+static uint32_t slotsSize; // Values of its frame, the values it works out are spilled right after them
+static uint32_t stackSize; // How many values the code written so far is working with, kept in t0, t1...
+static uint32_t maxStack;
+static uint32_t function; // The number of the function being written, the program is 0
+static bool restarts; // Whether it gives back a call to itself, which jumps to its start
+static int indent;
+
+static astWorkStack_T workStack; // Expressions still to be walked, see AST.h
+
+static astFunctionTable_T transpiledFunctions; // The C function each definition is written as
+static uint32_t functionsSize;
+
+static astIndex_T* pendingFunctions; // Definitions of functions that are called but not written yet, by function
+static size_t pendingFunctionsSize;
+
+static uint32_t* nativesUsed; // The built-in functions the program calls, looked up by name when it starts
+static size_t nativesUsedSize;
+
+static uint32_t constantsSize; // Literals made once when the program starts
+
+static void transpileStatement(AST_T* node);
+
+static void transpileExpr(AST_T* node);
+
+static void textAppend(text_T* text, const char* format, va_list args) {
+  va_list copy;
+  va_copy(copy, args);
+  size_t length = (size_t) vsnprintf((void*) 0, 0, format, copy);
+  va_end(copy);
+
+  // Make room for the text and the 0 that ends it
+  if (text->size + length + 1 > text->capacity) {
+    size_t capacity = text->capacity ? text->capacity : 4096;
+    while (text->size + length + 1 > capacity)
+      capacity *= 2;
+
+    text->chars = arenaGrow(programArena, text->chars, text->capacity, capacity);
+    text->capacity = capacity;
+  }
+
+  vsnprintf(text->chars + text->size, length + 1, format, args);
+  text->size += length;
+}
+
+static void textPrintf(text_T* text, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  textAppend(text, format, args);
+  va_end(args);
+}
+
+// Write a line of the body, indented as deep as the ifs it is in
+static void line(const char* format, ...) {
+  textPrintf(&bodyText, "%*s", 2 * indent, "");
+
+  va_list args;
+  va_start(args, format);
+  textAppend(&bodyText, format, args);
+  va_end(args);
+
+  textPrintf(&bodyText, "\n");
+}
+
+// Write chars as a C string literal. Anything but plain printable characters is escaped in octal,
+// with all three digits so the character after it can't be taken as part of it
+static void textString(text_T* text, const char* chars, size_t length) {
+  textPrintf(text, "\"");
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = (unsigned char) chars[i];
+    if (c >= ' ' && c <= '~' && c != '"' && c != '\\' && c != '?')
+      textPrintf(text, "%c", c);
+    else
+      textPrintf(text, "\\%03o", c);
+  }
+  textPrintf(text, "\"");
+}
+
+// Keep track of how many locals the code works with
+static void changeStack(int change) {
+  stackSize += change;
+  if (stackSize > maxStack)
+    maxStack = stackSize;
+}
+
+// The C function a definition is written as. The first call to a function gives it one, and it is written after the program
+static uint32_t getFunction(AST_T* funcDef) {
+  uint32_t* entry = astFunctionEntry(&transpiledFunctions, funcDef->index);
+  if (*entry)
+    return *entry;
+
+  *entry = ++functionsSize;
+
+  pendingFunctions = arenaGrowArray(programArena, pendingFunctions, pendingFunctionsSize, sizeof(astIndex_T));
+  pendingFunctions[pendingFunctionsSize++] = funcDef->index;
+
+  return *entry;
+}
+
+// The C variable a built-in function's number is kept in once the program has looked it up
+static uint32_t getNative(uint32_t native) {
+  for (size_t i = 0; i < nativesUsedSize; i++) {
+    if (nativesUsed[i] == native)
+      return native;
+  }
+
+  nativesUsed = arenaGrowArray(programArena, nativesUsed, nativesUsedSize, sizeof(uint32_t));
+  nativesUsed[nativesUsedSize++] = native;
+
+  textPrintf(&startText, "  native%u = runtimeNative(", native);
+  const char* name = symbolName(natives[native].symbol);
+  textString(&startText, name, strlen(name));
+  textPrintf(&startText, ");\n");
+
+  return native;
+}
+
+// Put the locals from the first one up to the given one in the frame, where the collector sees them
+static void spill(uint32_t from, uint32_t to) {
+  for (uint32_t i = from; i < to; i++)
+    line("frame%u[%u] = t%u;", level, slotsSize + i, i);
+}
+
+// The frames a function defined in the frame of the given depth is nested in, as they are passed or as it takes them
+static void writeOuterFrames(text_T* text, uint32_t depth, bool declared) {
+  for (uint32_t i = 1; i <= depth; i++)
+    textPrintf(text, declared ? ", value_T* frame%u" : ", frame%u", i);
+}
+
+static void transpileFuncCall(AST_T* node) {
+  // The arguments are worked out in order into the locals above the ones in use
+  uint32_t base = stackSize;
+  for (size_t i = 0; i < node->funcCallArgsSize; i++)
+    transpileExpr(astGet(astGetList(node->funcCallArgs)[i]));
+
+  // print and println write their values out themselves, each the way its type is printed
+  if (node->isNativeCall && nativeIsPrint(node->funcCallNative)) {
+    for (uint32_t i = 0; i < node->funcCallArgsSize; i++) {
+      if (i)
+        line("outputChar(' ');");
+
+      switch (astGet(astGetList(node->funcCallArgs)[i])->valueType) {
+        case INT: line("outputIntValue(t%u);", base + i); break;
+        case STRING: line("outputStringValue(t%u);", base + i); break;
+        case CHAR: line("outputChar(valueToChar(t%u));", base + i); break;
+        case BOOL: line("outputBoolValue(t%u);", base + i); break;
+        default: line("outputValue(t%u);", base + i); break;
+      }
+    }
+
+    if (natives[node->funcCallNative].function == builtinFuncPrintln)
+      line("outputChar('\\n');");
+    line("outputPrinted();");
+    line("t%u = VALUE_VOID;", base);
+  }
+  // Built-in functions take their arguments from the frame, and never collect
+  else if (node->isNativeCall) {
+    spill(base, stackSize);
+    line("t%u = callNative(native%u, frame%u + %u, %u);", base, getNative(node->funcCallNative), level, slotsSize + base, node->funcCallArgsSize);
+  }
+  else {
+    // The callee may collect, so everything the caller is still working with goes in its frame, the arguments last
+    AST_T* funcDef = astGet(node->funcCallDef);
+    spill(0, stackSize);
+
+    textPrintf(&bodyText, "%*st%u = function%u(frame%u + %u", 2 * indent, "", base, getFunction(funcDef), level, slotsSize + base);
+    writeOuterFrames(&bodyText, funcDef->scope->depth, false);
+    textPrintf(&bodyText, ");\n");
+  }
+
+  // The arguments are replaced by the result
+  stackSize = base;
+  changeStack(1);
+}
+
+// Write a value that isn't an operator into the next local
+static void transpileOperand(AST_T* node) {
+  uint32_t local = stackSize;
+
+  switch (node->type) {
+    case INT:
+      if (node->intVal >= VALUE_SMALL_INT_MIN && node->intVal <= VALUE_SMALL_INT_MAX)
+        line("t%u = valueFromSmallInt(%ldL);", local, node->intVal);
+      else {
+        // Only a literal outside the word needs an object, which is made once
+        if (node->intVal == LONG_MIN)
+          textPrintf(&startText, "  constants[%u] = runtimeInt(INT64_MIN);\n", constantsSize);
+        else
+          textPrintf(&startText, "  constants[%u] = runtimeInt(%ldL);\n", constantsSize, node->intVal);
+        line("t%u = constants[%u];", local, constantsSize++);
+      }
+      changeStack(1);
+      break;
+
+    case CHAR: line("t%u = valueFromChar(%d);", local, node->charVal); changeStack(1); break;
+    case BOOL: line("t%u = %s;", local, node->boolVal ? "VALUE_TRUE" : "VALUE_FALSE"); changeStack(1); break;
+
+    case STRING:
+      textPrintf(&startText, "  constants[%u] = runtimeString(", constantsSize);
+      textString(&startText, node->stringVal, strlen(node->stringVal));
+      textPrintf(&startText, ", %lu);\n", (unsigned long) strlen(node->stringVal));
+      line("t%u = constants[%u];", local, constantsSize++);
+      changeStack(1);
+      break;
+
+    case AST_VARIABLE: {
+      // An argument always has a value, anything else may be used before its definition runs
+      uint32_t frame = node->scope->depth - node->varDepth;
+      if (astGet(node->varDef)->type != AST_VARIABLE_DEFINITION)
+        line("t%u = frame%u[%u];", local, frame, node->varSlot);
+      else {
+        textPrintf(&bodyText, "%*st%u = runtimeLoad(frame%u[%u], ", 2 * indent, "", local, frame, node->varSlot);
+        const char* name = symbolName(node->varSymbol);
+        textString(&bodyText, name, strlen(name));
+        textPrintf(&bodyText, ");\n");
+      }
+      changeStack(1);
+      break;
+    }
+
+    case AST_FUNCTION_CALL: transpileFuncCall(node); break;
+
+    default:
+      // Anything else runs as a statement and results in nothing
+      transpileStatement(node);
+      line("t%u = VALUE_VOID;", stackSize);
+      changeStack(1);
+      break;
+  }
+}
+
+// The C that applies an operator, with the ones that have a fast path for ints of the word calling it directly
+static void writeOperator(AST_T* binop, uint32_t left, uint32_t right) {
+  int operator = binop->binopOperator;
+
+  // Ints the type checker knows of skip the check of what the operands are
+  if (typeIsIntArithmetic(binop)) {
+    switch (operator) {
+      case TOKEN_PLUS: line("t%u = runtimeAddInts(t%u, t%u);", left, left, right); break;
+      case TOKEN_MINUS: line("t%u = runtimeSubtractInts(t%u, t%u);", left, left, right); break;
+      default: line("t%u = runtimeMultiplyInts(t%u, t%u);", left, left, right); break;
+    }
+    return;
+  }
+
+  switch (operator) {
+    case TOKEN_PLUS: line("t%u = runtimeAdd(t%u, t%u);", left, left, right); break;
+    case TOKEN_MINUS: line("t%u = runtimeSubtract(t%u, t%u);", left, left, right); break;
+    case TOKEN_MULTIPLY: line("t%u = runtimeMultiply(t%u, t%u);", left, left, right); break;
+    case TOKEN_DIVIDE: line("t%u = applyOperator(TOKEN_DIVIDE, t%u, t%u);", left, left, right); break;
+    case TOKEN_MODULO: line("t%u = applyOperator(TOKEN_MODULO, t%u, t%u);", left, left, right); break;
+    case TOKEN_POW: line("t%u = applyOperator(TOKEN_POW, t%u, t%u);", left, left, right); break;
+    case TOKEN_EQ: line("t%u = runtimeCompare(TOKEN_EQ, t%u, t%u);", left, left, right); break;
+    case TOKEN_NOT_EQ: line("t%u = runtimeCompare(TOKEN_NOT_EQ, t%u, t%u);", left, left, right); break;
+    case TOKEN_LESS: line("t%u = runtimeCompare(TOKEN_LESS, t%u, t%u);", left, left, right); break;
+    case TOKEN_LESS_EQ: line("t%u = runtimeCompare(TOKEN_LESS_EQ, t%u, t%u);", left, left, right); break;
+    case TOKEN_GREATER: line("t%u = runtimeCompare(TOKEN_GREATER, t%u, t%u);", left, left, right); break;
+    case TOKEN_GREATER_EQ: line("t%u = runtimeCompare(TOKEN_GREATER_EQ, t%u, t%u);", left, left, right); break;
+    default:
+      printf("Unknown operator with type %d\n", operator);
+      exit(1);
+  }
+}
+
+static void transpileExpr(AST_T* node) {
+  // Write the expression in post order with an explicit work stack, so operands come before
+  // the operators using them and long expressions don't recurse
+  size_t workBase = workStack.size;
+
+  astPushWork(&workStack, node->index, false);
+
+  while (workStack.size > workBase) {
+    astWork_T work = workStack.items[--workStack.size];
+    AST_T* current = astGet(work.index);
+
+    if (current->type != AST_BINOP) {
+      transpileOperand(current);
+      continue;
+    }
+
+    // The first time an operator is seen, its operands have to be written first, left before right
+    if (!work.expanded) {
+      astPushWork(&workStack, work.index, true);
+      astPushWork(&workStack, current->binopRight, false);
+      astPushWork(&workStack, current->binopLeft, false);
+      continue;
+    }
+
+    // The result replaces the left operand
+    writeOperator(current, stackSize - 2, stackSize - 1);
+    changeStack(-1);
+  }
+}
+
+static void transpileReturn(AST_T* node) {
+  AST_T* value = node->returnVal ? astGet(node->returnVal) : (void*) 0;
+
+  // A call whose result is given straight back takes over the running frame, unless the callee is defined in it
+  if (value && value->isTailCall && !value->isNativeCall) {
+    AST_T* funcDef = astGet(value->funcCallDef);
+    uint32_t callee = getFunction(funcDef);
+
+    if (value->scope->depth > funcDef->scope->depth) {
+      for (size_t i = 0; i < value->funcCallArgsSize; i++)
+        transpileExpr(astGet(astGetList(value->funcCallArgs)[i]));
+
+      // A call to itself starts over in the same frame
+      if (callee == function) {
+        for (uint32_t i = 0; i < value->funcCallArgsSize; i++)
+          line("frame%u[%u] = t%u;", level, i, i);
+        line("runtimeRestart(frame%u, %u, %u);", level, value->funcCallArgsSize, slotsSize);
+        line("goto start;");
+        restarts = true;
+      }
+      else {
+        // The callee's frame goes where this one was, and its arguments move down to its start
+        spill(0, stackSize);
+        line("runtimeTop = frame%u;", level);
+        textPrintf(&bodyText, "%*sreturn function%u(frame%u + %u", 2 * indent, "", callee, level, slotsSize);
+        writeOuterFrames(&bodyText, funcDef->scope->depth, false);
+        textPrintf(&bodyText, ");\n");
+      }
+
+      stackSize -= value->funcCallArgsSize;
+      return;
+    }
+  }
+
+  if (!value) {
+    line("return runtimeLeave(frame%u, VALUE_VOID);", level);
+    return;
+  }
+
+  transpileExpr(value);
+  changeStack(-1);
+  line("return runtimeLeave(frame%u, t%u);", level, stackSize);
+}
+
+static void transpileIf(AST_T* node) {
+  // A condition known to be a bool doesn't need to be checked
+  AST_T* condition = astGet(node->ifCondition);
+  transpileExpr(condition);
+  changeStack(-1);
+  if (condition->valueType == BOOL)
+    line("if (t%u == VALUE_TRUE) {", stackSize);
+  else
+    line("if (runtimeCondition(t%u)) {", stackSize);
+
+  indent += 1;
+  transpileStatement(astGet(node->ifBody));
+  indent -= 1;
+
+  if (node->ifElse) {
+    line("}");
+    line("else {");
+    indent += 1;
+    transpileStatement(astGet(node->ifElse));
+    indent -= 1;
+  }
+
+  line("}");
+}
+
+static void transpileStatement(AST_T* node) {
+  // Check the type of the node and write accordingly
+  switch (node->type) {
+    case AST_COMPOUND:
+      // Definitions run first, the same way the visitor hoists them
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type == AST_VARIABLE_DEFINITION)
+          transpileStatement(child);
+      }
+
+      for (size_t i = 0; i < node->compoundSize; i++) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i]);
+        if (child->type != AST_VARIABLE_DEFINITION)
+          transpileStatement(child);
+      }
+      break;
+
+    case AST_VARIABLE_DEFINITION:
+      transpileExpr(astGet(node->varDefVal));
+      changeStack(-1);
+
+      // A value that isn't known to have the declared type is checked once, before the variable holds it
+      if (typeNeedsCheck(node)) {
+        const char* name = symbolName(node->varDefSymbol);
+        textPrintf(&bodyText, "%*sframe%u[%u] = runtimeCheckType(t%u, %d, ", 2 * indent, "", level, node->varDefSlot, stackSize, node->varType);
+        textString(&bodyText, name, strlen(name));
+        textPrintf(&bodyText, ");\n");
+      }
+      else
+        line("frame%u[%u] = t%u;", level, node->varDefSlot, stackSize);
+      break;
+
+    // Functions are written once they are called, and nothing is left to do for the rest
+    case AST_FUNCTION_DEFINITION:
+    case AST_NOOP: break;
+
+    case AST_STATEMENT_RETURN: transpileReturn(node); break;
+    case AST_IF: transpileIf(node); break;
+
+    default:
+      // Anything else is an expression whose result isn't used
+      transpileExpr(node);
+      changeStack(-1);
+      break;
+  }
+}
+
+// Write the function whose body has just been written into bodyText, now that its locals are known
+static void finishFunction(const char* entry, uint32_t argsSize) {
+  textPrintf(&functionsText, "%s", entry);
+
+  // The program's frame is kept where every function can reach it
+  if (level == 0)
+    textPrintf(&functionsText, "  frame0 = runtimeEnter((void*) 0, 0, %u, __builtin_frame_address(0));\n", slotsSize + maxStack);
+  else
+    textPrintf(&functionsText, "  value_T* frame%u = runtimeEnter(args, %u, %u, __builtin_frame_address(0));\n", level, argsSize, slotsSize + maxStack);
+
+  if (maxStack > 0) {
+    textPrintf(&functionsText, "  value_T t0");
+    for (uint32_t i = 1; i < maxStack; i++)
+      textPrintf(&functionsText, ", t%u", i);
+    textPrintf(&functionsText, ";\n");
+  }
+
+  if (restarts)
+    textPrintf(&functionsText, "start:\n");
+
+  textPrintf(&functionsText, "%s}\n\n", bodyText.size ? bodyText.chars : "");
+}
+
+static void beginFunction(uint32_t number, uint32_t depth, uint32_t slots) {
+  function = number;
+  level = depth;
+  slotsSize = slots;
+  stackSize = 0;
+  maxStack = 0;
+  restarts = false;
+  indent = 1;
+  bodyText.size = 0;
+}
+
+// Whether every way through a statement ends in a ret, so nothing written after it could run
+static bool endsInReturn(AST_T* node) {
+  switch (node->type) {
+    case AST_COMPOUND:
+      // Definitions are written first, and function definitions and noops write nothing
+      for (size_t i = node->compoundSize; i > 0; i--) {
+        AST_T* child = astGet(astGetList(node->compoundVal)[i - 1]);
+        if (child->type != AST_VARIABLE_DEFINITION && child->type != AST_FUNCTION_DEFINITION && child->type != AST_NOOP)
+          return endsInReturn(child);
+      }
+      return false;
+
+    case AST_STATEMENT_RETURN: return true;
+    case AST_IF: return node->ifElse && endsInReturn(astGet(node->ifBody)) && endsInReturn(astGet(node->ifElse));
+    default: return false;
+  }
+}
+
+static void transpileFunction(uint32_t number, AST_T* funcDef) {
+  AST_T* body = astGet(funcDef->funcDefBody);
+  beginFunction(number, body->scope->depth, body->scope->slotsSize);
+
+  // A body that ends without a ret gives back nothing
+  transpileStatement(body);
+  if (!endsInReturn(body))
+    line("return runtimeLeave(frame%u, VALUE_VOID);", level);
+
+  // Every function takes its arguments and the frames it is nested in
+  text_T signature = { (void*) 0, 0, 0 };
+  textPrintf(&signature, "static value_T function%u(const value_T* args", number);
+  writeOuterFrames(&signature, funcDef->scope->depth, true);
+  textPrintf(&signature, ")");
+  textPrintf(&prototypesText, "%s; // %s\n", signature.chars, symbolName(funcDef->funcDefSymbol));
+
+  text_T entry = { (void*) 0, 0, 0 };
+  textPrintf(&entry, "// func %s\n%s {\n", symbolName(funcDef->funcDefSymbol), signature.chars);
+  finishFunction(entry.chars, funcDef->funcDefArgsSize);
+}
+
+void emitC(AST_T* root, const char* filePath, size_t stackBudget, FILE* out) {
+  // The program's own frame is frame0, which every function can reach
+  beginFunction(0, 0, root->scope->slotsSize);
+  transpileStatement(root);
+  finishFunction("static void program() {\n", 0);
+
+  // Then every function that is called, which may find more functions that are called
+  for (size_t i = 0; i < pendingFunctionsSize; i++)
+    transpileFunction(i + 1, astGet(pendingFunctions[i]));
+
+  fprintf(out, "// Compiled from %s by csach\n#include \"runtime.h\"\n\n", filePath);
+
+  if (constantsSize > 0)
+    fprintf(out, "static value_T constants[%u];\n", constantsSize);
+  for (size_t i = 0; i < nativesUsedSize; i++)
+    fprintf(out, "static uint32_t native%u;\n", nativesUsed[i]);
+  fprintf(out, "static value_T* frame0;\n\n");
+
+  if (prototypesText.size)
+    fprintf(out, "%s\n", prototypesText.chars);
+
+  fprintf(out, "%s", functionsText.chars);
+
+  // The budget the program was built with is the one it runs with
+  fprintf(out, "int main() {\n  initRuntime(%zuUL);\n%s  runProgram(program);\n  return 0;\n}\n", stackBudget, startText.size ? startText.chars : "");
+}
+
+// Find the runtime and its headers, next to the interpreter when it was built where it is, or where make install put them
+static bool findRuntime(char* library, char* include) {
+  char executable[PATH_MAX - 16]; // Room for the names put after it
+  ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+  if (length > 0) {
+    executable[length] = 0;
+    *strrchr(executable, '/') = 0;
+
+    snprintf(library, PATH_MAX, "%s/libcsach.a", executable);
+    snprintf(include, PATH_MAX, "%s/src/include", executable);
+    if (access(library, R_OK) == 0)
+      return true;
+  }
+
+  snprintf(library, PATH_MAX, "%s/libcsach.a", TRANSPILER_INSTALL_DIR);
+  snprintf(include, PATH_MAX, "%s/include", TRANSPILER_INSTALL_DIR);
+  return access(library, R_OK) == 0;
+}
+
+// Compile the program to an executable named after its file without the .csach, with the C compiler in CC.
+// Returns the exit status to end with
+int buildExecutable(AST_T* root, const char* filePath, size_t stackBudget) {
+  char library[PATH_MAX];
+  char include[PATH_MAX];
+  if (!findRuntime(library, include)) {
+    printf("The runtime library `libcsach.a` couldn't be found, build it with make.\n");
+    exit(1);
+  }
+
+  // The executable goes next to the program, a file without the extension gets .out instead
+  size_t length = strlen(filePath);
+  bool hasExtension = length > 6 && strcmp(filePath + length - 6, ".csach") == 0;
+  char* executable = arenaAlloc(programArena, length + sizeof(".out"));
+  memcpy(executable, filePath, length);
+  strcpy(executable + (hasExtension ? length - 6 : length), hasExtension ? "" : ".out");
+
+  // The C code is written to a file of its own, which is removed once it has been compiled
+  char source[] = "/tmp/csach-XXXXXX.c";
+  int descriptor = mkstemps(source, 2);
+  FILE* out = descriptor < 0 ? (void*) 0 : fdopen(descriptor, "w");
+  if (!out) {
+    printf("Couldn't create a file for the C code.\n");
+    exit(1);
+  }
+  emitC(root, filePath, stackBudget, out);
+  fclose(out);
+
+  const char* compiler = getenv("CC") ? getenv("CC") : TRANSPILER_CC;
+  char* const command[] = {
+    (char*) compiler, "-O2", "-I", include, source, library, "-pthread", "-o", executable, (void*) 0
+  };
+
+  pid_t child = fork();
+  if (child == 0) {
+    execvp(compiler, command);
+    printf("Couldn't run the C compiler `%s`.\n", compiler);
+    _exit(1);
+  }
+
+  int status = 1;
+  if (child < 0 || waitpid(child, &status, 0) < 0)
+    status = 1;
+  unlink(source);
+
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
\ No newline at end of file
@@ -0,0 +1,534 @@
+#include <stdio.h>
+#include "include/typecheck.h"
+#include "include/builtins.h"
+#include "include/value.h"
+#include "include/arena.h"
+
+typeStats_T typeStats;
+
+// Expressions are typed in post order with this stack, the same way the compiler walks them, since they can be very deep
+static astWorkStack_T workStack;
+
+// The statements waiting to be checked
+static astIndex_T* pending;
+static size_t pendingSize;
+static size_t pendingCapacity;
+
+// Maps nodes to nodes with open addressing. 0 is never a key
+typedef struct TYPE_MAP_STRUCT {
+  astIndex_T* keys;
+  astIndex_T* values;
+  size_t size;
+  size_t capacity; // Always a power of two
+} typeMap_T;
+
+// The specialization that comes after each function definition, so a function's specializations are a chain starting at it
+static typeMap_T specializations;
+
+// The copy of each node of the function being specialized
+static typeMap_T copies;
+
+// The nodes of the function being specialized, parents before their children
+static astIndex_T* cloneOrder;
+static size_t cloneOrderSize;
+static size_t cloneOrderCapacity;
+
+// A list of copies, made before it goes into the list pool, which may move as it grows
+static astIndex_T* cloneList;
+static size_t cloneListCapacity;
+
+static size_t clonedNodes; // Nodes copied into specializations so far
+static size_t specializationDepth; // Specializations being typed inside each other
+
+static void pushPending(astIndex_T index) {
+  if (pendingSize == pendingCapacity) {
+    size_t capacity = pendingCapacity ? pendingCapacity * 2 : 64;
+    pending = arenaGrow(programArena, pending, pendingCapacity * sizeof(astIndex_T), capacity * sizeof(astIndex_T));
+    pendingCapacity = capacity;
+  }
+
+  pending[pendingSize++] = index;
+}
+
+static size_t mapSlot(typeMap_T* map, astIndex_T key) {
+  size_t slot = (key * 2654435769u) & (map->capacity - 1);
+  while (map->keys[slot] && map->keys[slot] != key)
+    slot = (slot + 1) & (map->capacity - 1);
+
+  return slot;
+}
+
+static astIndex_T mapGet(typeMap_T* map, astIndex_T key) {
+  if (!map->capacity)
+    return 0;
+
+  size_t slot = mapSlot(map, key);
+  return map->keys[slot] == key ? map->values[slot] : 0;
+}
+
+static void mapPut(typeMap_T* map, astIndex_T key, astIndex_T value) {
+  // Keep the map at most half full
+  if ((map->size + 1) * 2 > map->capacity) {
+    typeMap_T old = *map;
+
+    map->capacity = old.capacity ? old.capacity * 2 : 64;
+    map->keys = programAlloc(map->capacity * sizeof(astIndex_T));
+    map->values = programAlloc(map->capacity * sizeof(astIndex_T));
+
+    for (size_t i = 0; i < old.capacity; i++) {
+      if (old.keys[i]) {
+        size_t slot = mapSlot(map, old.keys[i]);
+        map->keys[slot] = old.keys[i];
+        map->values[slot] = old.values[i];
+      }
+    }
+  }
+
+  size_t slot = mapSlot(map, key);
+  if (!map->keys[slot])
+    map->size += 1;
+  map->keys[slot] = key;
+  map->values[slot] = value;
+}
+
+static void pushCloneOrder(astIndex_T index) {
+  if (!index)
+    return;
+
+  if (cloneOrderSize == cloneOrderCapacity) {
+    size_t capacity = cloneOrderCapacity ? cloneOrderCapacity * 2 : 64;
+    cloneOrder = arenaGrow(programArena, cloneOrder, cloneOrderCapacity * sizeof(astIndex_T), capacity * sizeof(astIndex_T));
+    cloneOrderCapacity = capacity;
+  }
+
+  cloneOrder[cloneOrderSize++] = index;
+}
+
+static void pushCloneOrderList(astIndex_T list, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    pushCloneOrder(astGetList(list)[i]);
+}
+
+// Collect a function and every node inside it, breadth first, leaving out the functions defined inside it when asked to
+static void collectFunction(AST_T* funcDef, bool nested) {
+  cloneOrderSize = 0;
+  pushCloneOrder(funcDef->index);
+
+  for (size_t i = 0; i < cloneOrderSize; i++) {
+    AST_T* node = astGet(cloneOrder[i]);
+
+    if (node->type == AST_FUNCTION_DEFINITION && i > 0 && !nested)
+      continue;
+
+    switch (node->type) {
+      case AST_VARIABLE_DEFINITION: pushCloneOrder(node->varDefVal); break;
+      case AST_FUNCTION_CALL: pushCloneOrderList(node->funcCallArgs, node->funcCallArgsSize); break;
+      case AST_COMPOUND: pushCloneOrderList(node->compoundVal, node->compoundSize); break;
+      case AST_STATEMENT_RETURN: pushCloneOrder(node->returnVal); break;
+
+      case AST_FUNCTION_DEFINITION:
+        pushCloneOrderList(node->funcDefArgs, node->funcDefArgsSize);
+        pushCloneOrder(node->funcDefBody);
+        break;
+
+      case AST_BINOP:
+        pushCloneOrder(node->binopLeft);
+        pushCloneOrder(node->binopRight);
+        break;
+
+      case AST_IF:
+        pushCloneOrder(node->ifCondition);
+        pushCloneOrder(node->ifBody);
+        pushCloneOrder(node->ifElse);
+        break;
+
+      default: break;
+    }
+  }
+}
+
+// The copy of a node, or the node itself when it is outside the function being copied
+static astIndex_T copyOf(astIndex_T index) {
+  astIndex_T copy = mapGet(&copies, index);
+  return copy ? copy : index;
+}
+
+static astIndex_T copyList(astIndex_T list, size_t size) {
+  if (size > cloneListCapacity) {
+    cloneList = arenaGrow(programArena, cloneList, cloneListCapacity * sizeof(astIndex_T), size * sizeof(astIndex_T));
+    cloneListCapacity = size;
+  }
+
+  for (size_t i = 0; i < size; i++)
+    cloneList[i] = copyOf(astGetList(list)[i]);
+
+  return astAddList(cloneList, size);
+}
+
+// Copy a function with everything inside it. The copy lives in the same scopes and frames as the original,
+// its variables refer to its own definitions and arguments, and it calls the copies of the functions defined inside it.
+// A call to the function itself still goes to the original, which picks the specialization for the call's types
+static AST_T* cloneFunction(AST_T* funcDef) {
+  collectFunction(funcDef, true);
+  copies = (typeMap_T) { 0 };
+
+  for (size_t i = 0; i < cloneOrderSize; i++) {
+    AST_T* node = astGet(cloneOrder[i]);
+    AST_T* copy = initAST(node->type);
+    astIndex_T index = copy->index;
+
+    *copy = *node;
+    copy->index = index;
+    copy->valueType = 0;
+    mapPut(&copies, node->index, index);
+  }
+  clonedNodes += cloneOrderSize;
+
+  for (size_t i = 0; i < cloneOrderSize; i++) {
+    AST_T* copy = astGet(copyOf(cloneOrder[i]));
+
+    switch (copy->type) {
+      case AST_VARIABLE_DEFINITION: copy->varDefVal = copyOf(copy->varDefVal); break;
+      case AST_VARIABLE: copy->varDef = copyOf(copy->varDef); break;
+      case AST_COMPOUND: copy->compoundVal = copyList(copy->compoundVal, copy->compoundSize); break;
+      case AST_STATEMENT_RETURN: copy->returnVal = copyOf(copy->returnVal); break;
+
+      case AST_FUNCTION_DEFINITION:
+        copy->funcDefArgs = copyList(copy->funcDefArgs, copy->funcDefArgsSize);
+        copy->funcDefBody = copyOf(copy->funcDefBody);
+        break;
+
+      case AST_FUNCTION_CALL:
+        copy->funcCallArgs = copyList(copy->funcCallArgs, copy->funcCallArgsSize);
+        if (!copy->isNativeCall && copy->funcCallDef != funcDef->index)
+          copy->funcCallDef = copyOf(copy->funcCallDef);
+        break;
+
+      case AST_BINOP:
+        copy->binopLeft = copyOf(copy->binopLeft);
+        copy->binopRight = copyOf(copy->binopRight);
+        break;
+
+      case AST_IF:
+        copy->ifCondition = copyOf(copy->ifCondition);
+        copy->ifBody = copyOf(copy->ifBody);
+        copy->ifElse = copyOf(copy->ifElse);
+        break;
+
+      default: break;
+    }
+  }
+
+  return astGet(copyOf(funcDef->index));
+}
+
+// The type both of two types are, ANY when they differ. 0 is no type yet
+static int joinTypes(int left, int right) {
+  if (!left || left == right)
+    return right;
+
+  return ANY;
+}
+
+// The type of everything a function can give back, once its body is typed
+static int returnType(AST_T* funcDef) {
+  AST_T* body = astGet(funcDef->funcDefBody);
+  int type = 0;
+
+  // A body that doesn't end with a ret gives back void when it runs out. Definitions are hoisted, so they don't count
+  AST_T* last = (void*) 0;
+  for (size_t i = body->compoundSize; i > 0 && !last; i--) {
+    AST_T* statement = astGet(astGetList(body->compoundVal)[i - 1]);
+    if (statement->type != AST_VARIABLE_DEFINITION && statement->type != AST_FUNCTION_DEFINITION)
+      last = statement;
+  }
+  if (!last || last->type != AST_STATEMENT_RETURN)
+    type = VOID;
+
+  collectFunction(funcDef, false);
+  for (size_t i = 0; i < cloneOrderSize; i++) {
+    AST_T* node = astGet(cloneOrder[i]);
+    if (node->type != AST_STATEMENT_RETURN)
+      continue;
+
+    int given = node->returnVal ? astGet(node->returnVal)->valueType : VOID;
+    type = joinTypes(type, given ? given : ANY);
+  }
+
+  return type ? type : ANY;
+}
+
+// Push a list backwards, so its first item is checked first and errors come out in the order they were written
+static void pushPendingList(astIndex_T list, size_t size) {
+  for (size_t i = size; i > 0; i--)
+    pushPending(astGetList(list)[i - 1]);
+}
+
+// The type of a variable, which is the type of its value when none is declared. 0 when the value hasn't been typed yet
+static int variableType(AST_T* varDef) {
+  // An argument has the type of its specialization, or is ANY in the body every other call runs
+  if (varDef->type != AST_VARIABLE_DEFINITION || varDef->varType != ANY)
+    return varDef->varType;
+
+  return astGet(varDef->varDefVal)->valueType;
+}
+
+// The type of an operator's result. Anything but + only works on ints, so its result is an int or the program stops
+static int binopType(int operator, int left, int right) {
+  if (isComparison(operator))
+    return BOOL;
+
+  if (operator != TOKEN_PLUS || left == INT || right == INT)
+    return INT;
+
+  if (left == STRING || right == STRING)
+    return STRING;
+
+  return ANY;
+}
+
+static void countPrinted(AST_T* call) {
+  for (size_t i = 0; i < call->funcCallArgsSize; i++) {
+    int type = astGet(astGetList(call->funcCallArgs)[i])->valueType;
+    typeStats.printed += 1;
+    if (type == INT || type == STRING || type == CHAR || type == BOOL)
+      typeStats.printedKnown += 1;
+  }
+}
+
+static void typeStatements(astIndex_T root);
+
+// The body every call without known argument types runs is typed once, the first time such a call is found
+static void typeGeneric(AST_T* funcDef) {
+  if (funcDef->valueType)
+    return;
+
+  funcDef->valueType = ANY;
+  pushPending(funcDef->funcDefBody);
+}
+
+// Type a specialization's body right away, so its calls know what it gives back. While it is typed, calls to it
+// give back ANY, and past the depth limit its body waits its turn like any other statement and gives back ANY
+static void typeSpecialization(AST_T* funcDef) {
+  if (specializationDepth == TYPE_MAX_DEPTH) {
+    funcDef->valueType = ANY;
+    pushPending(funcDef->funcDefBody);
+    return;
+  }
+
+  specializationDepth += 1;
+  typeStatements(funcDef->funcDefBody);
+  specializationDepth -= 1;
+
+  funcDef->valueType = returnType(funcDef);
+}
+
+static bool signatureMatches(AST_T* funcDef, AST_T* call) {
+  for (size_t i = 0; i < call->funcCallArgsSize; i++) {
+    if (astGet(astGetList(funcDef->funcDefArgs)[i])->varType != astGet(astGetList(call->funcCallArgs)[i])->valueType)
+      return false;
+  }
+
+  return true;
+}
+
+// The function a call runs: the specialization for the types of its arguments, made the first time they are seen,
+// or the original when none of them is known or the function has as many specializations as it may
+static AST_T* specialize(AST_T* call) {
+  AST_T* funcDef = astGet(call->funcCallDef);
+  typeStats.calls += 1;
+
+  bool known = false;
+  for (size_t i = 0; i < call->funcCallArgsSize; i++)
+    known |= astGet(astGetList(call->funcCallArgs)[i])->valueType != ANY;
+
+  if (!known) {
+    typeGeneric(funcDef);
+    return funcDef;
+  }
+
+  size_t count = 0;
+  astIndex_T last = funcDef->index;
+  for (astIndex_T next = mapGet(&specializations, last); next; next = mapGet(&specializations, last)) {
+    AST_T* special = astGet(next);
+    if (signatureMatches(special, call)) {
+      call->funcCallDef = next;
+      typeStats.callsSpecialized += 1;
+      return special;
+    }
+
+    last = next;
+    count += 1;
+  }
+
+  if (count == TYPE_MAX_SPECIALIZATIONS || clonedNodes > TYPE_CLONE_BUDGET) {
+    typeGeneric(funcDef);
+    return funcDef;
+  }
+
+  AST_T* special = cloneFunction(funcDef);
+  for (size_t i = 0; i < call->funcCallArgsSize; i++)
+    astGet(astGetList(special->funcDefArgs)[i])->varType = astGet(astGetList(call->funcCallArgs)[i])->valueType;
+
+  mapPut(&specializations, last, special->index);
+  call->funcCallDef = special->index;
+  typeStats.specializations += 1;
+  typeStats.callsSpecialized += 1;
+
+  typeSpecialization(special);
+  return special;
+}
+
+static void typeExpr(AST_T* node) {
+  size_t workBase = workStack.size;
+
+  astPushWork(&workStack, node->index, false);
+
+  while (workStack.size > workBase) {
+    astWork_T work = workStack.items[--workStack.size];
+    AST_T* current = astGet(work.index);
+
+    // An expression is typed once, even when a variable needs its value typed before the walk gets to it
+    if (current->valueType && !work.expanded)
+      continue;
+
+    switch (current->type) {
+      case INT:
+      case STRING:
+      case CHAR:
+      case BOOL: current->valueType = current->type; break;
+
+      case AST_VARIABLE: {
+        AST_T* varDef = astGet(current->varDef);
+        int type = variableType(varDef);
+
+        // Definitions are hoisted, so a variable can be used before the walk gets to its value, which is typed first.
+        // The definition is marked while its value is typed, so a value that uses its own variable ends up as ANY
+        if (!type && !work.expanded && !varDef->valueType) {
+          varDef->valueType = ANY;
+          astPushWork(&workStack, current->index, true);
+          astPushWork(&workStack, varDef->varDefVal, false);
+          break;
+        }
+
+        current->valueType = type ? type : ANY;
+        break;
+      }
+
+      case AST_BINOP:
+        if (!work.expanded) {
+          astPushWork(&workStack, current->index, true);
+          astPushWork(&workStack, current->binopRight, false);
+          astPushWork(&workStack, current->binopLeft, false);
+          break;
+        }
+
+        current->valueType = binopType(current->binopOperator, astGet(current->binopLeft)->valueType, astGet(current->binopRight)->valueType);
+        typeStats.operators += 1;
+        if (typeIsIntArithmetic(current))
+          typeStats.operatorsKnown += 1;
+        break;
+
+      case AST_FUNCTION_CALL:
+        if (!work.expanded) {
+          astPushWork(&workStack, current->index, true);
+          for (size_t i = current->funcCallArgsSize; i > 0; i--)
+            astPushWork(&workStack, astGetList(current->funcCallArgs)[i - 1], false);
+          break;
+        }
+
+        // A built-in function says what it gives back, any other function what its specialization does
+        if (!current->isNativeCall) {
+          int type = specialize(current)->valueType;
+          current->valueType = type ? type : ANY;
+          break;
+        }
+
+        current->valueType = natives[current->funcCallNative].returnType;
+        if (nativeIsPrint(current->funcCallNative))
+          countPrinted(current);
+        break;
+
+      // A function is typed once it is called, and its valueType is what it gives back
+      case AST_FUNCTION_DEFINITION: break;
+
+      // A statement used as a value is checked as one, and results in nothing
+      case AST_COMPOUND:
+      case AST_VARIABLE_DEFINITION:
+      case AST_STATEMENT_RETURN:
+      case AST_IF:
+        pushPending(current->index);
+        current->valueType = ANY;
+        break;
+
+      default: current->valueType = ANY; break;
+    }
+  }
+}
+
+static void checkVarDef(AST_T* node) {
+  AST_T* value = astGet(node->varDefVal);
+  typeExpr(value);
+  node->valueType = variableType(node);
+
+  if (node->varType == ANY)
+    return;
+
+  // A value whose type is known has to be the declared one, anything else is checked when the variable is given it
+  typeStats.declared += 1;
+  if (value->valueType == node->varType)
+    typeStats.declaredKnown += 1;
+  else if (value->valueType != ANY)
+    declaredTypeError(symbolName(node->varDefSymbol), node->varType, value->valueType);
+}
+
+static void typeStatements(astIndex_T root) {
+  size_t base = pendingSize;
+  pushPending(root);
+
+  while (pendingSize > base) {
+    AST_T* current = astGet(pending[--pendingSize]);
+
+    switch (current->type) {
+      case AST_COMPOUND: pushPendingList(current->compoundVal, current->compoundSize); break;
+      case AST_VARIABLE_DEFINITION: checkVarDef(current); break;
+      case AST_FUNCTION_DEFINITION: break; // Typed once it is called
+
+      case AST_STATEMENT_RETURN:
+        if (current->returnVal)
+          typeExpr(astGet(current->returnVal));
+        break;
+
+      case AST_IF:
+        if (current->ifElse)
+          pushPending(current->ifElse);
+        pushPending(current->ifBody);
+
+        typeExpr(astGet(current->ifCondition));
+        typeStats.conditions += 1;
+        if (astGet(current->ifCondition)->valueType == BOOL)
+          typeStats.conditionsKnown += 1;
+        break;
+
+      case AST_NOOP: break;
+
+      default: typeExpr(current); break;
+    }
+  }
+}
+
+void typeCheck(AST_T* root) {
+  typeStatements(root->index);
+}
+
+void printTypeStats() {
+  unsigned long checks = typeStats.operators + typeStats.conditions + typeStats.printed + typeStats.declared;
+  unsigned long removed = typeStats.operatorsKnown + typeStats.conditionsKnown + typeStats.printedKnown + typeStats.declaredKnown;
+
+  fprintf(stderr, "Type checks removed: %lu of %lu\n", removed, checks);
+  fprintf(stderr, "  Operators: %lu of %lu\n", typeStats.operatorsKnown, typeStats.operators);
+  fprintf(stderr, "  Conditions: %lu of %lu\n", typeStats.conditionsKnown, typeStats.conditions);
+  fprintf(stderr, "  Printed values: %lu of %lu\n", typeStats.printedKnown, typeStats.printed);
+  fprintf(stderr, "  Declared types: %lu of %lu\n", typeStats.declaredKnown, typeStats.declared);
+  fprintf(stderr, "Calls to specialized bodies: %lu of %lu, %lu bodies\n", typeStats.callsSpecialized, typeStats.calls, typeStats.specializations);
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "include/value.h"
+#include "include/bigint.h"
+#include "include/str.h"
+#include "include/token.h"
+#include "include/gc.h"
+
+// Only ints too big for the word need an object
+value_T valueFromBigInt(long value) {
+  // Only a long outside the word comes here, so its magnitude always takes both limbs
+  uint64_t magnitude = value < 0 ? 0 - (uint64_t) value : (uint64_t) value;
+
+  intObject_T* object = allocObject(OBJECT_INT, sizeof(struct INT_OBJECT_STRUCT) + 2 * sizeof(uint32_t));
+  object->negative = value < 0;
+  object->length = 2;
+  object->limbs[0] = (uint32_t) magnitude;
+  object->limbs[1] = (uint32_t) (magnitude >> 32);
+
+  return (value_T) (uintptr_t) object;
+}
+
+value_T valueFromLiteral(AST_T* node) {
+  switch (node->type) {
+    case INT: return valueFromInt(node->intVal); break;
+    case CHAR: return valueFromChar(node->charVal); break;
+    case BOOL: return valueFromBool(node->boolVal); break;
+
+    case STRING:
+      // A literal's string is made the first time it is needed and kept in the node, so it is made only once
+      // and is never collected
+      if (node->stringValue == VALUE_UNSET) {
+        node->stringValue = valueFromString(node->stringVal, strlen(node->stringVal));
+        pinValue(node->stringValue);
+      }
+      return node->stringValue;
+      break;
+
+    default: return VALUE_VOID; break;
+  }
+}
+
+long valueToInt(value_T value) {
+  if (valueIsSmallInt(value))
+    return valueToSmallInt(value);
+
+  // An int bigger than a long gives its lowest 64 bits, the way C wraps
+  intObject_T* object = (intObject_T*) valueToObject(value);
+  uint64_t magnitude = object->limbs[0] | (object->length > 1 ? (uint64_t) object->limbs[1] << 32 : 0);
+
+  return (long) (object->negative ? 0 - magnitude : magnitude);
+}
+
+bool valueIsInt(value_T value) {
+  return valueIsSmallInt(value) || (valueIsObject(value) && valueToObject(value)->type == OBJECT_INT);
+}
+
+// The kind of AST node a value would be written as
+int valueType(value_T value) {
+  if (valueIsSmallInt(value))
+    return INT;
+
+  if (valueIsObject(value))
+    return valueToObject(value)->type == OBJECT_INT ? INT : STRING;
+
+  if (valueIsShortString(value))
+    return STRING;
+
+  if ((value & 7) == VALUE_CHAR_TAG)
+    return CHAR;
+
+  if (value == VALUE_TRUE || value == VALUE_FALSE)
+    return BOOL;
+
+  return VOID;
+}
+
+// The name a type is written with in the program
+const char* typeName(int type) {
+  switch (type) {
+    case INT: return "int"; break;
+    case FLOAT: return "float"; break;
+    case CHAR: return "char"; break;
+    case BOOL: return "bool"; break;
+    case STRING: return "str"; break;
+    case VOID: return "void"; break;
+    default: return "any"; break;
+  }
+}
+
+void declaredTypeError(const char* name, int declared, int given) {
+  printf("Error: Variable `%s` is declared as %s but is given a value of type %s.\n", name, typeName(declared), typeName(given));
+  exit(1);
+}
+
+// Exponentiation by squaring, the base is squared once per bit of the exponent
+static bool powerLongs(long base, long exponent, long* result) {
+  long power = 1;
+
+  while (true) {
+    if ((exponent & 1) && __builtin_mul_overflow(power, base, &power))
+      return false;
+
+    exponent >>= 1;
+    if (!exponent)
+      break;
+
+    // Squaring only overflows for a base whose next power would overflow anyway
+    if (__builtin_mul_overflow(base, base, &base))
+      return false;
+  }
+
+  *result = power;
+  return true;
+}
+
+// Work out an operator on two longs. Gives false when the result doesn't fit in a long, so it can be worked out as a bigint
+bool applyIntOperator(int operator, long left, long right, long* result) {
+  switch (operator) {
+    case TOKEN_PLUS: return !__builtin_add_overflow(left, right, result); break;
+    case TOKEN_MINUS: return !__builtin_sub_overflow(left, right, result); break;
+    case TOKEN_MULTIPLY: return !__builtin_mul_overflow(left, right, result); break;
+
+    case TOKEN_DIVIDE:
+    case TOKEN_MODULO:
+      if (right == 0) {
+        printf("Error: Division by zero.\n");
+        exit(1);
+      }
+
+      // The most negative long divided by -1 is one more than the biggest long
+      if (left == LONG_MIN && right == -1)
+        return false;
+
+      *result = operator == TOKEN_DIVIDE ? left / right : left % right;
+      return true;
+      break;
+
+    case TOKEN_POW:
+      if (right < 0) {
+        printf("Error: Negative exponents are not supported for this number type.\n");
+        exit(1);
+      }
+      return powerLongs(left, right, result);
+      break;
+
+    default:
+      printf("Unknown operator with type %d\n", operator);
+      exit(1);
+  }
+}
+
+bool applyIntComparison(int operator, long left, long right) {
+  switch (operator) {
+    case TOKEN_EQ: return left == right; break;
+    case TOKEN_NOT_EQ: return left != right; break;
+    case TOKEN_LESS: return left < right; break;
+    case TOKEN_LESS_EQ: return left <= right; break;
+    case TOKEN_GREATER: return left > right; break;
+    case TOKEN_GREATER_EQ: return left >= right; break;
+
+    default:
+      printf("Unknown operator with type %d\n", operator);
+      exit(1);
+  }
+}
+
+static value_T applyComparison(int operator, value_T left, value_T right) {
+  if (valueIsSmallInt(left & right))
+    return valueFromBool(applyIntComparison(operator, valueToSmallInt(left), valueToSmallInt(right)));
+
+  if (valueIsInt(left) && valueIsInt(right))
+    return valueFromBool(applyIntComparison(operator, bigIntCompare(left, right), 0));
+
+  int leftType = valueType(left);
+  int rightType = valueType(right);
+
+  // Chars and strings are ordered, and their order is compared the same way as ints
+  if (leftType == CHAR && rightType == CHAR)
+    return valueFromBool(applyIntComparison(operator, (unsigned char) valueToChar(left), (unsigned char) valueToChar(right)));
+
+  if (leftType == STRING && rightType == STRING) {
+    if (operator == TOKEN_EQ || operator == TOKEN_NOT_EQ)
+      return valueFromBool(strEquals(left, right) == (operator == TOKEN_EQ));
+    return valueFromBool(applyIntComparison(operator, strCompare(left, right), 0));
+  }
+
+  // Anything else can only be equal when it is the same value
+  if (operator == TOKEN_EQ)
+    return valueFromBool(left == right);
+  if (operator == TOKEN_NOT_EQ)
+    return valueFromBool(left != right);
+
+  printf("Error: Unsupported operand types %d and %d for operator with type %d.\n", leftType, rightType, operator);
+  exit(1);
+}
+
+value_T applyOperator(int operator, value_T left, value_T right) {
+  if (isComparison(operator))
+    return applyComparison(operator, left, right);
+
+  // Two integers, worked out as longs unless one is already bigger or the result would be
+  long result;
+  if (valueIsSmallInt(left & right) && applyIntOperator(operator, valueToSmallInt(left), valueToSmallInt(right), &result))
+    return valueFromInt(result);
+
+  if (valueIsInt(left) && valueIsInt(right))
+    return bigIntApply(operator, left, right);
+
+  // Two strings can be joined together
+  if (operator == TOKEN_PLUS && valueType(left) == STRING && valueType(right) == STRING)
+    return strJoin(left, right);
+
+  printf("Error: Unsupported operand types %d and %d for operator with type %d.\n", valueType(left), valueType(right), operator);
+  exit(1);
+}
\ No newline at end of file
@@ -2,220 +2,393 @@
 #include <stdlib.h>
 #include <string.h>
 #include "include/visitor.h"
+#include "include/typecheck.h"
+#include "include/builtins.h"
+#include "include/value.h"
+#include "include/gc.h"
 #include "include/scope.h"
+#include "include/token.h"
+#include "include/arena.h"
+
+// One run of a scope: the global scope, or a call of a function. Its values are a window of the value stack
+typedef struct FRAME_STRUCT {
+  size_t slots; // Where the frame's values start on the value stack
+  size_t parent; // The frame of the scope the function was defined in
+  size_t work; // Where the call that made the frame is on the work stack, which a ret goes back to
+  size_t operands; // How many operands there were before the call's arguments
+} frame_T;
+
+// A node that is running, and how far it has got. Nodes are run from this stack instead of by recursing in C,
+// so how deep the program's calls go is only limited by the stack budget
+typedef struct WORK_STRUCT {
+  astIndex_T index;
+  uint32_t step; // 0 when the node hasn't started
+} work_T;
+
+// Every frame's values, back to back. A call pushes its frame's values and the return pops them,
+// so the same memory is used over and over however many calls run.
+// Each stack sets the whole budget aside when the program starts, but the system only hands out the pages it gets to
+static value_T* valueStack; // A slot that hasn't been given a value yet holds VALUE_UNSET
+static size_t valueStackSize;
+
+static frame_T* frameStack; // The running frame is always the last one
+static size_t frameStackSize;
+
+static work_T* workStack;
+static size_t workStackSize;
+static size_t workStackCapacity;
+
+static value_T* operandStack; // Every node that finishes leaves its value here
+static size_t operandStackSize;
+static size_t operandStackCapacity;
+
+static size_t stackBudget; // The most bytes the stacks may use together
+
+static void stackOverflow() {
+  printf("Stack overflow.\n");
+  exit(1);
+}
 
-// Built-in functions
-static AST_T* builtinFuncPrint(AST_T** args, size_t argsSize) {
-  // Output the arguments as arg1 arg2 arg3
-  // There is no space at the end
-
-  int i = 0;
-  while (i < argsSize - 1) {
-    AST_T* visited = visit(args[i]);
-    switch (visited->type) {
-      case STRING: printf("%s ", visited->stringVal); break;
-      case INT: printf("%ld ", visited->intVal); break;
-      case CHAR: printf("%c ", visited->charVal); break;
-      case BOOL: printf("%s ", visited->boolVal ? "true" : "false"); break;
-      default: printf("%p ", (void*) visited); break;
-    }
+// Stop the program when a frame with this many values would take the stacks past the budget
+static void checkBudget(size_t slotsSize) {
+  size_t bytes = (valueStackSize + slotsSize + operandStackSize) * sizeof(value_T) +
+    (frameStackSize + 1) * sizeof(frame_T) + workStackSize * sizeof(work_T);
 
-    i++;
-  }
+  if (bytes > stackBudget)
+    stackOverflow();
+}
 
-  AST_T* visited = visit(args[i]);
-  switch (visited->type) {
-    case STRING: printf("%s", visited->stringVal); break;
-    case INT: printf("%ld", visited->intVal); break;
-    case CHAR: printf("%c", visited->charVal); break;
-    case BOOL: printf("%s", visited->boolVal ? "true" : "false"); break;
-    default: printf("%p", (void*) visited); break;
-  }
+// Push a frame with room for every value of a scope, and return where its values start
+static size_t pushFrame(scope_T* scope, size_t parent) {
+  checkBudget(scope->slotsSize);
+
+  size_t slots = valueStackSize;
+  for (size_t i = 0; i < scope->slotsSize; i++)
+    valueStack[slots + i] = VALUE_UNSET;
+  valueStackSize += scope->slotsSize;
+
+  frameStack[frameStackSize].slots = slots;
+  frameStack[frameStackSize].parent = parent;
+  frameStack[frameStackSize].work = workStackSize - 1;
+  frameStack[frameStackSize].operands = operandStackSize;
+  frameStackSize += 1;
+
+  return slots;
+}
 
-  return initAST(AST_NOOP);
+static void popFrame() {
+  frameStackSize -= 1;
+  valueStackSize = frameStack[frameStackSize].slots;
 }
 
-static AST_T* builtinFuncPrintln(AST_T** args, size_t argsSize) {
-  // Output the arguments as arg1 arg2 arg3
-  // There is a new line created at the end
+// Go out from the running frame to the one a variable or function lives in
+static size_t outerFrame(uint32_t depth) {
+  size_t outer = frameStackSize - 1;
+  while (depth--)
+    outer = frameStack[outer].parent;
 
-  // If there are no arguments, print a new line
-  if(argsSize == 0) {
-    printf("\n");
-    return initAST(AST_NOOP);
-  }
+  return outer;
+}
 
-  int i = 0;
-  while (i < argsSize - 1) {
-    AST_T* visited = visit(args[i]);
-    switch (visited->type) {
-      case STRING: printf("%s ", visited->stringVal); break;
-      case INT: printf("%ld ", visited->intVal); break;
-      case CHAR: printf("%c ", visited->charVal); break;
-      case BOOL: printf("%s ", visited->boolVal ? "true" : "false"); break;
-      default: printf("%p ", (void*) visited); break;
-    }
+static void pushWork(astIndex_T index) {
+  if (workStackSize == workStackCapacity)
+    stackOverflow();
 
-    i++;
-  }
+  workStack[workStackSize].index = index;
+  workStack[workStackSize].step = 0;
+  workStackSize += 1;
+}
 
-  AST_T* visited = visit(args[i]);
-  switch (visited->type) {
-    case STRING: printf("%s\n", visited->stringVal); break;
-    case INT: printf("%ld\n", visited->intVal); break;
-    case CHAR: printf("%c\n", visited->charVal); break;
-    case BOOL: printf("%s\n", visited->boolVal ? "true" : "false"); break;
-    default: printf("%p\n", (void*) visited); break;
-  }
+static void pushOperand(value_T operand) {
+  if (operandStackSize == operandStackCapacity)
+    stackOverflow();
+
+  operandStack[operandStackSize++] = operand;
+}
+
+static value_T popOperand() {
+  return operandStack[--operandStackSize];
+}
+
+// The running node is done, and leaves its value for whoever asked for it
+static void finish(value_T value) {
+  workStackSize -= 1;
+  pushOperand(value);
+}
+
+// Free the objects the program can't reach anymore. Every value it works with is in a frame or an operand
+static void collect() {
+  gcRoots_T roots[] = {
+    { valueStack, valueStackSize },
+    { operandStack, operandStackSize }
+  };
 
-  return initAST(AST_NOOP);
+  collectGarbage(roots, sizeof(roots) / sizeof(gcRoots_T));
 }
 
-static AST_T* builtinFuncClear(size_t argsSize) {
-  // Clear the terminal
+static value_T loadVar(AST_T* node) {
+  value_T value = valueStack[frameStack[outerFrame(node->varDepth)].slots + node->varSlot]; // The resolver already worked out where the value is
 
-  // If there are arguments, print an error message
-  if (argsSize != 0) {
-    printf("Invalid amount of arguments passed into function `clear`\n");
+  // A definition that comes later in the same scope hasn't run yet
+  if (value == VALUE_UNSET) {
+    printf("Variable `%s` is used before it has a value.\n", symbolName(node->varSymbol));
     exit(1);
   }
-  
-  system("clear");
 
-  return initAST(AST_NOOP);
+  return value;
 }
 
-static AST_T* builtinFuncExit(AST_T** args, size_t argsSize) {
-  // Exit the program with a status code
-  // If there are no arguments, exit with code 0 silently
-  if(argsSize == 0) {
-    exit(0);
+// Values and variables are worked out on the spot, anything else is pushed to run.
+// Returns whether the value is already on the operand stack
+static bool evaluateNow(astIndex_T index) {
+  AST_T* node = astGet(index);
+
+  switch (node->type) {
+    case INT: pushOperand(valueFromInt(node->intVal)); return true; break;
+    case STRING:
+    case CHAR:
+    case BOOL: pushOperand(valueFromLiteral(node)); return true; break;
+    case AST_VARIABLE: pushOperand(loadVar(node)); return true; break;
+    default: pushWork(index); return false; break;
   }
+}
 
-  // If there are more than one argument, print an error message and exit
-  if(argsSize > 1) {
-    printf("Invalid amount of arguments passed into function `exit`\n");
-    exit(1);
+static void runCompound(AST_T* node, size_t top, uint32_t step) {
+  // The statement that ran before coming back here leaves a value nobody uses
+  if (step > 0)
+    operandStackSize -= 1;
+
+  // Definitions run first, in the order they are written, then everything else
+  uint32_t size = node->compoundSize;
+  astIndex_T* children = astGetList(node->compoundVal);
+  for (; step < 2 * size; step++) {
+    AST_T* child = astGet(children[step % size]);
+    if ((child->type == AST_VARIABLE_DEFINITION) != (step < size))
+      continue;
+
+    workStack[top].step = step + 1;
+    if (!evaluateNow(children[step % size]))
+      return;
+    operandStackSize -= 1;
   }
 
-  // Get the argument
-  AST_T* visited = visit(args[0]);
+  finish(VALUE_VOID);
+}
 
-  // If the argument isn't an integer, print an error message and exit
-  if (visited->type != INT) {
-    printf("Invalid argument passed into function `exit`\n");
-    exit(1);
+static void runVarDef(AST_T* node, size_t top, uint32_t step) {
+  // Work out the value first
+  if (step == 0) {
+    workStack[top].step = 1;
+    if (!evaluateNow(node->varDefVal))
+      return;
   }
-  
-  // Exit with the argument's value
-  printf("Exited with code %ld.", visited->intVal); 
-  exit(visited->intVal);
 
-  return initAST(AST_NOOP);
+  // Then keep it in the definition's slot, once it is known to have the declared type
+  value_T value = popOperand();
+  if (typeNeedsCheck(node) && valueType(value) != node->varType)
+    declaredTypeError(symbolName(node->varDefSymbol), node->varType, valueType(value));
+
+  valueStack[frameStack[frameStackSize - 1].slots + node->varDefSlot] = value;
+  finish(VALUE_VOID);
 }
 
-AST_T* visit(AST_T* node) {
-  // Check the type of the node and visit accordingly
-  switch (node->type) {
-    case AST_VARIABLE_DEFINITION: return visitVarDef(node); break;
-    case AST_VARIABLE: return visitVar(node); break;
-    case AST_FUNCTION_DEFINITION: return visitFuncDef(node); break;
-    case AST_FUNCTION_CALL: return visitFuncCall(node); break;
-    case AST_COMPOUND: return visitCompound(node); break;
-    case AST_STATEMENT_RETURN: printf("Implementing return soon.\n"); exit(1); break;
-    default: return node; break;
+static void runBinop(AST_T* node, size_t top, uint32_t step) {
+  // The left operand is worked out before the right one
+  switch (step) {
+    case 0:
+      workStack[top].step = 1;
+      if (!evaluateNow(node->binopLeft))
+        return;
+      // fall through
+
+    case 1:
+      workStack[top].step = 2;
+      if (!evaluateNow(node->binopRight))
+        return;
+      // fall through
+
+    default: {
+      // Both operands are on the stack, so replace them with the result
+      value_T right = popOperand();
+      value_T left = popOperand();
+      finish(applyOperator(node->binopOperator, left, right));
+      break;
+    }
   }
 }
 
-AST_T* visitVarDef(AST_T* node) {
-  scopeAddVarDef(node->scope, node); // Add the variable definition to the scope
+static void runBuiltin(AST_T* node) {
+  operandStackSize -= node->funcCallArgsSize;
+  finish(callNative(node->funcCallNative, &operandStack[operandStackSize], node->funcCallArgsSize));
+}
+
+// Leave the running function with a value, wherever in its body the ret is
+static void returnFrom(value_T value) {
+  frame_T* frame = &frameStack[frameStackSize - 1];
+  workStackSize = frame->work;
+  operandStackSize = frame->operands;
+  popFrame();
 
-  return node;
+  pushOperand(value);
 }
 
-AST_T* visitVar(AST_T* node) {
-  AST_T* varDef = scopeGetVarDef(node->scope, node->varName); // Get the variable definition from the scope
+// A call that is the value of a ret runs in the frame of the function making it, so a function that
+// ends by calling itself keeps using the same memory however many times it does
+static void runTailCall(AST_T* node, AST_T* funcDef) {
+  AST_T* body = astGet(funcDef->funcDefBody);
 
-  // If the variable definition is not found, send an error
-  if (!varDef) {
-    printf("Variable `%s` not found.\n", node->varName);
-    exit(1);
-  }
+  // The callee's parent has to be worked out while the running frame still stands for the caller
+  size_t parent = outerFrame(node->scope->depth - funcDef->scope->depth);
+  frame_T* frame = &frameStack[frameStackSize - 1];
 
-  // If the variable definition is found, return its value
-  return visit(varDef->varDefVal);
-}
+  // Everything the caller still had to do is dropped, the call that made the frame finishes when the new body does
+  workStackSize = frame->work + 1;
+  valueStackSize = frame->slots;
+  checkBudget(body->scope->slotsSize);
 
-AST_T* visitFuncDef(AST_T* node) {
-  scopeAddFuncDef(node->scope, node); // Add the function definition to the scope
+  for (size_t i = 0; i < body->scope->slotsSize; i++)
+    valueStack[frame->slots + i] = VALUE_UNSET;
+  memcpy(&valueStack[frame->slots], &operandStack[operandStackSize - node->funcCallArgsSize], node->funcCallArgsSize * sizeof(value_T));
+  valueStackSize = frame->slots + body->scope->slotsSize;
 
-  return node;
+  operandStackSize = frame->operands;
+  frame->parent = parent;
+
+  pushWork(body->index);
 }
 
-AST_T* visitFuncCall(AST_T* node) {
-  // Built-in functions
-  if (strcmp(node->funcCallName, "print") == 0)
-    return builtinFuncPrint(node->funcCallArgs, node->funcCallArgsSize);
-  if (strcmp(node->funcCallName, "println") == 0)
-    return builtinFuncPrintln(node->funcCallArgs, node->funcCallArgsSize);
-  if (strcmp(node->funcCallName, "clear") == 0)
-    return builtinFuncClear(node->funcCallArgsSize);
-  if (strcmp(node->funcCallName, "exit") == 0)
-    return builtinFuncExit(node->funcCallArgs, node->funcCallArgsSize);
-  
-  // Custom functions
-  AST_T* funcDef = scopeGetFuncDef(node->scope, node->funcCallName);
+static void runFuncCall(AST_T* node, size_t top, uint32_t step) {
+  // The arguments are worked out in order, in the caller's frame
+  astIndex_T* args = astGetList(node->funcCallArgs);
+  for (; step < node->funcCallArgsSize; step++) {
+    workStack[top].step = step + 1;
+    if (!evaluateNow(args[step]))
+      return;
+  }
+
+  if (node->isNativeCall) {
+    runBuiltin(node);
+    return;
+  }
+
+  AST_T* funcDef = astGet(node->funcCallDef);
+  AST_T* body = astGet(funcDef->funcDefBody);
+  uint32_t depth = node->scope->depth - funcDef->scope->depth;
+
+  // The body has finished without a ret, so the call gives back nothing
+  if (step > node->funcCallArgsSize) {
+    operandStackSize -= 1;
+    popFrame();
+    finish(VALUE_VOID);
+    return;
+  }
+
+  // Calls are where the heap is collected, since every program that runs for long goes through them
+  if (gcPending)
+    collect();
+
+  // A function defined in the running frame needs it as its parent, so only other calls can take it over
+  if (node->isTailCall && depth > 0) {
+    runTailCall(node, funcDef);
+    return;
+  }
+
+  // The new frame's parent is the frame the function was defined in, which is as many frames out as the call is nested deeper
+  workStack[top].step = step + 1;
+  operandStackSize -= node->funcCallArgsSize;
+  size_t slots = pushFrame(body->scope, outerFrame(depth));
+  memcpy(&valueStack[slots], &operandStack[operandStackSize], node->funcCallArgsSize * sizeof(value_T));
+
+  pushWork(body->index);
+}
 
-  // Not found
-  if (!funcDef)
-    return (void*) 0;
-  
+static void runIf(AST_T* node, size_t top, uint32_t step) {
+  if (step == 0) {
+    workStack[top].step = 1;
+    if (!evaluateNow(node->ifCondition))
+      return;
+  }
 
-  // Invalid amount of arguments called
-  if (node->funcCallArgsSize != funcDef->funcDefArgsSize) {
-    printf("Invalid amounmt of arguments passed into function `%s`\n", node->funcCallName);
+  value_T condition = popOperand();
+  if (astGet(node->ifCondition)->valueType != BOOL && valueType(condition) != BOOL) {
+    printf("Error: The condition of an if has to be a bool.\n");
     exit(1);
   }
 
-  // Go through the arguments
-  for (size_t i = 0; i < funcDef->funcDefArgsSize; i++) {
-    // Get the variable and its value from the defined arguments
-    AST_T* var = (AST_T*) funcDef->funcDefArgs[i];
-    AST_T* val = (AST_T*) node->funcCallArgs[i];
-
-    // Create a new variable definition with the value of the argument passed in the call
-    AST_T* varDef = initAST(AST_VARIABLE_DEFINITION);
-
-    // Give the variable its value
-    varDef->varDefVal = val;
-    varDef->type = val->type;
-    
-    // Copy the name of the defined argument into the new variable definition
-    varDef->varDefVarName = calloc(strlen(var->varName) + 1, sizeof(char));
-    strcpy(varDef->varDefVarName, var->varName);
-
-    // Add it to the function's scope
-    scopeAddVarDef(funcDef->funcDefBody->scope, varDef);
+  // The branch that is taken runs in the if's place
+  astIndex_T branch = condition == VALUE_TRUE ? node->ifBody : node->ifElse;
+  if (!branch) {
+    finish(VALUE_VOID);
+    return;
   }
-    
-  // Found
-  return visit(funcDef->funcDefBody);
+
+  workStack[top].index = branch;
+  workStack[top].step = 0;
 }
 
-AST_T* visitCompound(AST_T* node) {
-  for (size_t i = 0; i < node->compoundSize; i++) {
-    AST_T* child = node->compoundVal[i];
-    if (child->type == AST_VARIABLE_DEFINITION) {
-      visitVarDef(child);
-    }
+static void runReturn(AST_T* node, size_t top, uint32_t step) {
+  if (!node->returnVal) {
+    returnFrom(VALUE_VOID);
+    return;
   }
 
-  for (size_t i = 0; i < node->compoundSize; i++) {
-    AST_T* child = node->compoundVal[i];
-    if (child->type != AST_VARIABLE_DEFINITION) {
-      visit(child);
+  if (step == 0) {
+    workStack[top].step = 1;
+    if (!evaluateNow(node->returnVal))
+      return;
+  }
+
+  returnFrom(popOperand());
+}
+
+// Run nodes until everything above the base of the work stack is done
+static void run(size_t workBase) {
+  while (workStackSize > workBase) {
+    size_t top = workStackSize - 1;
+    AST_T* node = astGet(workStack[top].index);
+    uint32_t step = workStack[top].step;
+
+    // Check the type of the node and run accordingly
+    switch (node->type) {
+      case AST_COMPOUND: runCompound(node, top, step); break;
+      case AST_VARIABLE_DEFINITION: runVarDef(node, top, step); break;
+      case AST_VARIABLE: finish(loadVar(node)); break;
+      case AST_FUNCTION_CALL: runFuncCall(node, top, step); break;
+      case AST_BINOP: runBinop(node, top, step); break;
+      case AST_IF: runIf(node, top, step); break;
+      case AST_STATEMENT_RETURN: runReturn(node, top, step); break;
+
+      // Functions are bound to their calls by the resolver, so there is nothing to do when the definition runs
+      case AST_FUNCTION_DEFINITION:
+      case AST_NOOP: finish(VALUE_VOID); break;
+
+      default: finish(valueFromLiteral(node)); break;
     }
   }
+}
+
+value_T visit(AST_T* node) {
+  size_t workBase = workStackSize;
+
+  pushWork(node->index);
+  run(workBase);
+
+  return popOperand();
+}
+
+value_T visitProgram(AST_T* node, size_t budget) {
+  stackBudget = budget;
+
+  // No stack can be bigger than the whole budget, the budget check keeps them all together below it
+  valueStack = programAlloc(budget);
+  frameStack = programAlloc(budget);
+  workStackCapacity = budget / sizeof(work_T);
+  workStack = programAlloc(workStackCapacity * sizeof(work_T));
+  operandStackCapacity = budget / sizeof(value_T);
+  operandStack = programAlloc(operandStackCapacity * sizeof(value_T));
+
+  // The global scope gets the first frame
+  pushFrame(node->scope, 0);
 
-  return node;
+  return visit(node);
 }
\ No newline at end of file
@@ -0,0 +1,608 @@
+#include <stdio.h>
+#include "include/vm.h"
+#include "include/builtins.h"
+#include "include/value.h"
+#include "include/gc.h"
+#include "include/jit.h"
+#include "include/bigint.h"
+#include "include/output.h"
+#include "include/token.h"
+#include "include/arena.h"
+
+// A call that is running. Its values are a window of the value stack, with its operands right above them
+typedef struct VM_FRAME_STRUCT {
+  const uint8_t* returnAddress; // Where the caller goes on
+  value_T* slots; // Where the frame's values start
+  size_t parent; // The frame of the scope the function was defined in
+} vmFrame_T;
+
+static value_T* valueStack; // Never moves, so frames can point into it
+
+static size_t stackBudget; // The most bytes the value stack and the frames may use together
+
+static vmFrame_T* frameStack;
+static size_t frameStackSize;
+
+// There is always room, checkStack makes sure a call fits before it is made
+static void pushFrame(const uint8_t* returnAddress, value_T* slots, size_t parent) {
+  frameStack[frameStackSize].returnAddress = returnAddress;
+  frameStack[frameStackSize].slots = slots;
+  frameStack[frameStackSize].parent = parent;
+  frameStackSize += 1;
+}
+
+// Make sure a function's frame and everything its code puts on top of it fit in the budget, along with one more frame
+static void checkStack(value_T* slots, function_T* function) {
+  size_t values = (size_t) (slots - valueStack) + function->slotsSize + function->maxStack;
+  if (values * sizeof(value_T) + (frameStackSize + 1) * sizeof(vmFrame_T) > stackBudget) {
+    printf("Stack overflow.\n");
+    exit(1);
+  }
+}
+
+// Free the objects the program can't reach anymore. Every value it works with is a constant or on the stack below sp
+static void collect(chunk_T* chunk, value_T* sp) {
+  gcRoots_T roots[] = {
+    { valueStack, (size_t) (sp - valueStack) },
+    { chunk->constants, chunk->constantsSize }
+  };
+
+  collectGarbage(roots, sizeof(roots) / sizeof(gcRoots_T));
+}
+
+// Run a call as machine code once its function is hot, see jit.h. Gives false when the virtual machine has to run it
+static inline bool runJIT(chunk_T* chunk, function_T* function, value_T* slots, value_T* result) {
+  if (!function->jitCode && ++function->jitCalls != jitThreshold)
+    return false;
+
+  // The machine code's calls don't push frames, so the budget keeps room for as many frames as it can go deep
+  size_t reserved = (frameStackSize + 1 + JIT_MAX_DEPTH) * sizeof(vmFrame_T);
+  value_T* limit = reserved < stackBudget ? valueStack + (stackBudget - reserved) / sizeof(value_T) : valueStack;
+
+  return jitCall(chunk, function, slots, limit, result);
+}
+
+static void loadError(chunk_T* chunk, const uint8_t* instruction) {
+  printf("Variable `%s` is used before it has a value.\n", symbolName(chunkGetLoad(chunk, instruction - chunk->code)));
+  exit(1);
+}
+
+// Add or subtract two values that are both ints of the word. The tags can be worked with directly,
+// (2a+1) + (2b+1) - 1 is 2(a+b)+1, and the overflow check catches a result that needs an object
+static inline bool addSmallInts(value_T left, value_T right, value_T* result) {
+  return valueIsSmallInt(left & right) && !__builtin_add_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) result);
+}
+
+static inline bool subtractSmallInts(value_T left, value_T right, value_T* result) {
+  return valueIsSmallInt(left & right) && !__builtin_sub_overflow((int64_t) left, (int64_t) right - 1, (int64_t*) result);
+}
+
+// The token type each operator instruction stands for
+static const int operatorTokens[] = {
+  [OP_ADD] = TOKEN_PLUS,
+  [OP_SUB] = TOKEN_MINUS,
+  [OP_MUL] = TOKEN_MULTIPLY,
+  [OP_DIV] = TOKEN_DIVIDE,
+  [OP_MOD] = TOKEN_MODULO,
+  [OP_POW] = TOKEN_POW,
+  [OP_EQ] = TOKEN_EQ,
+  [OP_NOT_EQ] = TOKEN_NOT_EQ,
+  [OP_LESS] = TOKEN_LESS,
+  [OP_LESS_EQ] = TOKEN_LESS_EQ,
+  [OP_GREATER] = TOKEN_GREATER,
+  [OP_GREATER_EQ] = TOKEN_GREATER_EQ,
+  [OP_ADD_INT] = TOKEN_PLUS,
+  [OP_SUB_INT] = TOKEN_MINUS,
+  [OP_MUL_INT] = TOKEN_MULTIPLY
+};
+
+// The value a print instruction prints, after the space that goes before it
+static inline value_T outputOperand(const uint8_t* ip, const value_T* sp) {
+  if (readOperand(ip + sizeof(uint32_t)))
+    outputChar(' ');
+
+  return sp[-1 - (ptrdiff_t) readOperand(ip)];
+}
+
+// Labels as values let every instruction jump straight to the code of the next one, which predicts better
+// than going back through one switch. Building with -DVM_SWITCH_DISPATCH uses the portable switch instead
+#if defined(__GNUC__) && !defined(VM_SWITCH_DISPATCH)
+#define VM_COMPUTED_GOTO
+#endif
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_LOOP VM_NEXT();
+#define VM_CASE(op) label_##op:
+#define VM_NEXT() do { instruction = ip++; goto *dispatchTable[*instruction]; } while (0)
+#else
+#define VM_LOOP while (true) { instruction = ip++; if (profile) opCounts[*instruction] += 1; switch (*instruction) {
+#define VM_CASE(op) case op:
+#define VM_NEXT() continue
+#endif
+
+static uint64_t opCounts[256]; // How many times each instruction ran, when profiling
+
+static void printProfile() {
+  uint64_t total = 0;
+  for (size_t op = 0; op < OP_COUNT; op++)
+    total += opCounts[op];
+
+  fprintf(stderr, "Instruction mix, %lu instructions:\n", (unsigned long) total);
+
+  // Most common first
+  bool printed[OP_COUNT] = { false };
+  for (size_t i = 0; i < OP_COUNT; i++) {
+    size_t most = OP_COUNT;
+    for (size_t op = 0; op < OP_COUNT; op++) {
+      if (!printed[op] && opCounts[op] && (most == OP_COUNT || opCounts[op] > opCounts[most]))
+        most = op;
+    }
+
+    if (most == OP_COUNT)
+      break;
+
+    printed[most] = true;
+    fprintf(stderr, "  %-22s %12lu %6.2f%%\n", opcodeNames[most], (unsigned long) opCounts[most], 100.0 * opCounts[most] / total);
+  }
+}
+
+void runVM(chunk_T* chunk, bool profile, bool jit, size_t budget) {
+  // The whole budget is set aside for the values and the frames at once, but the system only hands out the pages
+  // the program gets to. The budget check keeps them together below the budget
+  stackBudget = budget;
+  valueStack = programAlloc(budget);
+  frameStack = programAlloc(budget);
+
+  // The profile is printed however the program ends, exit() included
+  if (profile)
+    atexit(printProfile);
+
+  // The program's frame is at the bottom of the stack, its values start without a value since the stack is zeroed
+  checkStack(valueStack, &chunk->functions[0]);
+  pushFrame((void*) 0, valueStack, 0);
+
+  value_T* slots = valueStack; // The running frame's values
+  value_T* sp = valueStack + chunk->functions[0].slotsSize; // The next free value
+  const uint8_t* ip = chunk->code; // The next instruction
+  const uint8_t* instruction; // The instruction that is running
+
+#ifdef VM_COMPUTED_GOTO
+  static void* const runTable[256] = {
+    [0 ... 255] = &&label_unknown,
+    [OP_CONST] = &&label_OP_CONST,
+    [OP_LOAD] = &&label_OP_LOAD,
+    [OP_LOAD_OUTER] = &&label_OP_LOAD_OUTER,
+    [OP_STORE] = &&label_OP_STORE,
+    [OP_POP] = &&label_OP_POP,
+    [OP_ADD] = &&label_OP_ADD,
+    [OP_SUB] = &&label_OP_SUB,
+    [OP_MUL] = &&label_OP_MUL,
+    [OP_DIV] = &&label_OP_DIV,
+    [OP_MOD] = &&label_OP_MOD,
+    [OP_POW] = &&label_OP_POW,
+    [OP_EQ] = &&label_OP_EQ,
+    [OP_NOT_EQ] = &&label_OP_NOT_EQ,
+    [OP_LESS] = &&label_OP_LESS,
+    [OP_LESS_EQ] = &&label_OP_LESS_EQ,
+    [OP_GREATER] = &&label_OP_GREATER,
+    [OP_GREATER_EQ] = &&label_OP_GREATER_EQ,
+    [OP_JUMP] = &&label_OP_JUMP,
+    [OP_JUMP_IF_FALSE] = &&label_OP_JUMP_IF_FALSE,
+    [OP_CALL] = &&label_OP_CALL,
+    [OP_TAIL_CALL] = &&label_OP_TAIL_CALL,
+    [OP_CALL_NATIVE] = &&label_OP_CALL_NATIVE,
+    [OP_RETURN] = &&label_OP_RETURN,
+    [OP_HALT] = &&label_OP_HALT,
+    [OP_ADD_INT] = &&label_OP_ADD_INT,
+    [OP_SUB_INT] = &&label_OP_SUB_INT,
+    [OP_MUL_INT] = &&label_OP_MUL_INT,
+    [OP_JUMP_IF_NOT] = &&label_OP_JUMP_IF_NOT,
+    [OP_CHECK_TYPE] = &&label_OP_CHECK_TYPE,
+    [OP_OUTPUT_INT] = &&label_OP_OUTPUT_INT,
+    [OP_OUTPUT_STRING] = &&label_OP_OUTPUT_STRING,
+    [OP_OUTPUT_CHAR] = &&label_OP_OUTPUT_CHAR,
+    [OP_OUTPUT_BOOL] = &&label_OP_OUTPUT_BOOL,
+    [OP_OUTPUT_VALUE] = &&label_OP_OUTPUT_VALUE,
+    [OP_OUTPUT_END] = &&label_OP_OUTPUT_END,
+    [OP_LOAD_LOAD] = &&label_OP_LOAD_LOAD,
+    [OP_LOAD_CONST] = &&label_OP_LOAD_CONST,
+    [OP_LOAD_CONST_ADD] = &&label_OP_LOAD_CONST_ADD,
+    [OP_LOAD_CONST_ADD_STORE] = &&label_OP_LOAD_CONST_ADD_STORE,
+    [OP_CALL_NATIVE_POP] = &&label_OP_CALL_NATIVE_POP
+  };
+
+  // When profiling, every instruction goes through the counter first, so running without it costs nothing extra
+  static void* const profileTable[256] = { [0 ... 255] = &&label_profile };
+  void* const* dispatchTable = profile ? profileTable : runTable;
+#endif
+
+  VM_LOOP
+
+  VM_CASE(OP_CONST) {
+    *sp++ = chunk->constants[readOperand(ip)];
+    ip += sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_LOAD) {
+    value_T value = slots[readOperand(ip)];
+    if (value == VALUE_UNSET)
+      loadError(chunk, instruction);
+
+    *sp++ = value;
+    ip += sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_LOAD_OUTER) {
+    // Go out to the frame the variable lives in
+    size_t frame = frameStackSize - 1;
+    for (uint32_t depth = readOperand(ip); depth; depth--)
+      frame = frameStack[frame].parent;
+
+    value_T value = frameStack[frame].slots[readOperand(ip + sizeof(uint32_t))];
+    if (value == VALUE_UNSET)
+      loadError(chunk, instruction);
+
+    *sp++ = value;
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_STORE) {
+    slots[readOperand(ip)] = *--sp;
+    ip += sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_POP) {
+    sp--;
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_ADD)
+  VM_CASE(OP_SUB)
+  VM_CASE(OP_MUL)
+  VM_CASE(OP_DIV)
+  VM_CASE(OP_MOD)
+  VM_CASE(OP_POW) {
+    value_T right = *--sp;
+    value_T* left = sp - 1;
+
+    // Adding, subtracting and multiplying ints of the word can't fail, so they don't need the general path
+    value_T result;
+    long product;
+    switch (*instruction) {
+      case OP_ADD:
+        if (addSmallInts(*left, right, &result)) {
+          *left = result;
+          VM_NEXT();
+        }
+        break;
+
+      case OP_SUB:
+        if (subtractSmallInts(*left, right, &result)) {
+          *left = result;
+          VM_NEXT();
+        }
+        break;
+
+      case OP_MUL:
+        if (valueIsSmallInt(*left & right) && !__builtin_mul_overflow(valueToSmallInt(*left), valueToSmallInt(right), &product)) {
+          *left = valueFromInt(product);
+          VM_NEXT();
+        }
+        break;
+    }
+
+    *left = applyOperator(operatorTokens[*instruction], *left, right);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_EQ)
+  VM_CASE(OP_NOT_EQ)
+  VM_CASE(OP_LESS)
+  VM_CASE(OP_LESS_EQ)
+  VM_CASE(OP_GREATER)
+  VM_CASE(OP_GREATER_EQ) {
+    value_T right = *--sp;
+    value_T* left = sp - 1;
+
+    // Tagging keeps the order of ints of the word, so they are compared without taking the tags off
+    if (valueIsSmallInt(*left & right)) {
+      int64_t a = (int64_t) *left;
+      int64_t b = (int64_t) right;
+      bool result = false;
+      switch (*instruction) {
+        case OP_EQ: result = a == b; break;
+        case OP_NOT_EQ: result = a != b; break;
+        case OP_LESS: result = a < b; break;
+        case OP_LESS_EQ: result = a <= b; break;
+        case OP_GREATER: result = a > b; break;
+        case OP_GREATER_EQ: result = a >= b; break;
+      }
+      *left = valueFromBool(result);
+      VM_NEXT();
+    }
+
+    *left = applyOperator(operatorTokens[*instruction], *left, right);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_JUMP) {
+    ip = chunk->code + readOperand(ip);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_JUMP_IF_FALSE) {
+    value_T condition = *--sp;
+    if (condition == VALUE_FALSE)
+      ip = chunk->code + readOperand(ip);
+    else if (condition == VALUE_TRUE)
+      ip += sizeof(uint32_t);
+    else {
+      printf("Error: The condition of an if has to be a bool.\n");
+      exit(1);
+    }
+    VM_NEXT();
+  }
+
+  // Calls are where the heap is collected, since every program that runs for long goes through them
+  VM_CASE(OP_CALL) {
+    if (gcPending)
+      collect(chunk, sp);
+
+    function_T* function = &chunk->functions[readOperand(ip)];
+    uint32_t depth = readOperand(ip + sizeof(uint32_t));
+    ip += 2 * sizeof(uint32_t);
+
+    // The arguments are already on top of the stack, so they become the first values of the new frame
+    value_T* calleeSlots = sp - function->argsSize;
+    checkStack(calleeSlots, function);
+    for (uint32_t i = function->argsSize; i < function->slotsSize; i++)
+      calleeSlots[i] = VALUE_UNSET;
+
+    // A hot function runs as machine code instead, when the JIT is on
+    value_T result;
+    if (jit && runJIT(chunk, function, calleeSlots, &result)) {
+      sp = calleeSlots;
+      *sp++ = result;
+      VM_NEXT();
+    }
+
+    // The new frame's parent is the frame the function was defined in
+    size_t parent = frameStackSize - 1;
+    while (depth--)
+      parent = frameStack[parent].parent;
+
+    pushFrame(ip, calleeSlots, parent);
+    slots = calleeSlots;
+    sp = calleeSlots + function->slotsSize;
+    ip = chunk->code + function->entry;
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_TAIL_CALL) {
+    if (gcPending)
+      collect(chunk, sp);
+
+    function_T* function = &chunk->functions[readOperand(ip)];
+    uint32_t depth = readOperand(ip + sizeof(uint32_t));
+
+    // The callee's parent is found from the running frame before it is taken over
+    size_t parent = frameStackSize - 1;
+    while (depth--)
+      parent = frameStack[parent].parent;
+
+    // The arguments move down to the start of the running frame, and the caller's caller gets the result
+    checkStack(slots, function);
+    sp -= function->argsSize;
+    memmove(slots, sp, function->argsSize * sizeof(value_T));
+    for (uint32_t i = function->argsSize; i < function->slotsSize; i++)
+      slots[i] = VALUE_UNSET;
+
+    frameStack[frameStackSize - 1].parent = parent;
+    sp = slots + function->slotsSize;
+    ip = chunk->code + function->entry;
+
+    // Machine code that finishes the call leaves its result for the caller's caller, the way a return does
+    value_T result;
+    if (jit && runJIT(chunk, function, slots, &result)) {
+      *sp++ = result;
+      goto returnResult;
+    }
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_RETURN)
+  returnResult: {
+    value_T result = *--sp;
+
+    // Drop the frame and leave the result where the arguments were
+    frameStackSize -= 1;
+    sp = frameStack[frameStackSize].slots;
+    ip = frameStack[frameStackSize].returnAddress;
+    slots = frameStack[frameStackSize - 1].slots;
+
+    *sp++ = result;
+    VM_NEXT();
+  }
+
+  // Built-in functions replace their arguments with their result
+  VM_CASE(OP_CALL_NATIVE)
+  VM_CASE(OP_CALL_NATIVE_POP) {
+    uint32_t native = readOperand(ip);
+    uint32_t argsSize = readOperand(ip + sizeof(uint32_t));
+    ip += 2 * sizeof(uint32_t);
+    sp -= argsSize;
+
+    value_T result = callNative(native, sp, argsSize);
+    if (*instruction == OP_CALL_NATIVE)
+      *sp++ = result;
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_HALT) {
+    return;
+  }
+
+  // Ints the type checker knows of only have to be told apart from big ints, which are worked with straight away
+  VM_CASE(OP_ADD_INT)
+  VM_CASE(OP_SUB_INT)
+  VM_CASE(OP_MUL_INT) {
+    value_T right = *--sp;
+    value_T* left = sp - 1;
+
+    value_T result;
+    long product;
+    switch (*instruction) {
+      case OP_ADD_INT:
+        if (addSmallInts(*left, right, &result)) {
+          *left = result;
+          VM_NEXT();
+        }
+        break;
+
+      case OP_SUB_INT:
+        if (subtractSmallInts(*left, right, &result)) {
+          *left = result;
+          VM_NEXT();
+        }
+        break;
+
+      default:
+        if (valueIsSmallInt(*left & right) && !__builtin_mul_overflow(valueToSmallInt(*left), valueToSmallInt(right), &product)) {
+          *left = valueFromInt(product);
+          VM_NEXT();
+        }
+        break;
+    }
+
+    *left = bigIntApply(operatorTokens[*instruction], *left, right);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_JUMP_IF_NOT) {
+    if (*--sp == VALUE_FALSE)
+      ip = chunk->code + readOperand(ip);
+    else
+      ip += sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_CHECK_TYPE) {
+    int type = valueType(sp[-1]);
+    if (type != (int) readOperand(ip))
+      declaredTypeError(symbolName(readOperand(ip + sizeof(uint32_t))), readOperand(ip), type);
+
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  // print and println work out all their values before printing any, so the values are printed where they are on the stack
+  VM_CASE(OP_OUTPUT_INT) {
+    outputIntValue(outputOperand(ip, sp));
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_OUTPUT_STRING) {
+    outputStringValue(outputOperand(ip, sp));
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_OUTPUT_CHAR) {
+    outputChar(valueToChar(outputOperand(ip, sp)));
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_OUTPUT_BOOL) {
+    outputBoolValue(outputOperand(ip, sp));
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_OUTPUT_VALUE) {
+    outputValue(outputOperand(ip, sp));
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_OUTPUT_END) {
+    if (readOperand(ip + sizeof(uint32_t)))
+      outputChar('\n');
+    outputPrinted();
+
+    sp -= readOperand(ip);
+    *sp++ = VALUE_VOID;
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_LOAD_LOAD) {
+    value_T first = slots[readOperand(ip)];
+    value_T second = slots[readOperand(ip + sizeof(uint32_t))];
+    if (first == VALUE_UNSET)
+      loadError(chunk, instruction);
+    if (second == VALUE_UNSET)
+      loadError(chunk, instruction + 1); // The peephole stage keeps the second load's name there
+
+    sp[0] = first;
+    sp[1] = second;
+    sp += 2;
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_LOAD_CONST) {
+    value_T value = slots[readOperand(ip)];
+    if (value == VALUE_UNSET)
+      loadError(chunk, instruction);
+
+    sp[0] = value;
+    sp[1] = chunk->constants[readOperand(ip + sizeof(uint32_t))];
+    sp += 2;
+    ip += 2 * sizeof(uint32_t);
+    VM_NEXT();
+  }
+
+  VM_CASE(OP_LOAD_CONST_ADD)
+  VM_CASE(OP_LOAD_CONST_ADD_STORE) {
+    value_T value = slots[readOperand(ip)];
+    value_T constant = chunk->constants[readOperand(ip + sizeof(uint32_t))];
+    if (value == VALUE_UNSET)
+      loadError(chunk, instruction);
+
+    // The sum is worked out on top of the stack
+    if (!addSmallInts(value, constant, sp))
+      *sp = applyOperator(TOKEN_PLUS, value, constant);
+
+    if (*instruction == OP_LOAD_CONST_ADD) {
+      sp++;
+      ip += 2 * sizeof(uint32_t);
+    }
+    else {
+      slots[readOperand(ip + 2 * sizeof(uint32_t))] = *sp;
+      ip += 3 * sizeof(uint32_t);
+    }
+    VM_NEXT();
+  }
+
+#ifdef VM_COMPUTED_GOTO
+  label_profile:
+    opCounts[*instruction] += 1;
+    goto *runTable[*instruction];
+
+  label_unknown:
+#else
+  default:
+#endif
+    printf("Unknown instruction %d\n", *instruction);
+    exit(1);
+
+#ifndef VM_COMPUTED_GOTO
+  } }
+#endif
+}
\ No newline at end of file
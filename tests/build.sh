@@ -0,0 +1,42 @@
+#!/bin/sh
+# Build every example and every program in tests/ with --build, and compare what the executable prints and how it ends
+# with the virtual machine. The programs are copied to a scratch directory first, since the executable goes next to them
+cd "$(dirname "$0")/.."
+
+work="${TMPDIR:-/tmp}/csach-build"
+mkdir -p "$work"
+failed=0
+
+for program in examples/*.csach tests/*.csach; do
+  name="${program%.csach}"
+  args=""
+  [ -f "$name.args" ] && args="$(cat "$name.args")"
+
+  copy="$work/$(basename "$program")"
+  executable="${copy%.csach}"
+  cp "$program" "$copy"
+  rm -f "$executable"
+
+  ./csach.out --engine=vm $args "$program" > "$work/vm.txt" 2>&1
+  vmStatus=$?
+
+  # A program that doesn't get past the checks is rejected the same way when it is built
+  if ./csach.out --build $args "$copy" > "$work/build.txt" 2>&1; then
+    "$executable" > "$work/executable.txt" 2>&1
+    status=$?
+  else
+    status=$?
+    cp "$work/build.txt" "$work/executable.txt"
+  fi
+
+  if cmp -s "$work/vm.txt" "$work/executable.txt" && [ $status -eq $vmStatus ]; then
+    echo "ok   $name $args"
+  else
+    echo "FAIL $name $args"
+    failed=1
+  fi
+
+  rm -f "$copy" "$executable"
+done
+
+exit $failed
\ No newline at end of file
@@ -0,0 +1,25 @@
+#!/bin/sh
+# Run every example and every program in tests/ with --jit-check, which compares what the program prints and how it
+# ends with and without the JIT, once with the default threshold and once compiling every function on its first call
+cd "$(dirname "$0")/.."
+
+thresholds="--jit-threshold=100 --jit-threshold=1"
+failed=0
+
+for program in examples/*.csach tests/*.csach; do
+  name="${program%.csach}"
+  args=""
+  [ -f "$name.args" ] && args="$(cat "$name.args")"
+
+  for threshold in $thresholds; do
+    if result="$(./csach.out --jit-check $threshold $args "$program" 2>&1 | tail -n 1)" && \
+      [ "${result#The JIT and the virtual machine agree}" != "$result" ]; then
+      echo "ok   $name $threshold $args"
+    else
+      echo "FAIL $name $threshold $args: $result"
+      failed=1
+    fi
+  done
+done
+
+exit $failed
\ No newline at end of file
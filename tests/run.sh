@@ -0,0 +1,24 @@
+#!/bin/sh
+# Run every program in tests/ on every engine, and compare what it prints with its .out file.
+# A program's .args file holds the options it runs with on top of the engine's.
+cd "$(dirname "$0")/.."
+
+engines="--engine=vm --engine=ast --engine=closure --jit"
+failed=0
+
+for program in tests/*.csach; do
+  name="${program%.csach}"
+  args=""
+  [ -f "$name.args" ] && args="$(cat "$name.args")"
+
+  for engine in $engines; do
+    if ./csach.out $engine $args "$program" 2>&1 | cmp -s - "$name.out"; then
+      echo "ok   $name $engine $args"
+    else
+      echo "FAIL $name $engine $args"
+      failed=1
+    fi
+  done
+done
+
+exit $failed